@@ -0,0 +1,198 @@
+#include "AssetPack.hpp"
+#include "ShelfPacker.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Builds the client's asset pack: decodes the images, packs them into
+// atlas pages and writes the pages and their index (see AssetPack.hpp).
+//
+//      AssetPack <pack file> <assets folder> <image>[:frames] ...
+//
+// A sprite sheet is given with its frame count, e.g. explosion.png:16
+//
+// --------------------------------------------------------------
+
+struct Source
+{
+    std::string name;
+    std::uint32_t frameCount{1};
+    sf::Image image;
+    std::uint32_t page{0};
+    std::uint32_t left{0};
+    std::uint32_t top{0};
+};
+
+struct PageBuilder
+{
+    std::uint32_t width;
+    std::uint32_t height;
+    std::unique_ptr<ShelfPacker> packer; // nullptr for an image too large to share a page
+    std::vector<std::uint8_t> pixels;
+};
+
+// --------------------------------------------------------------
+//
+// Finds a page for each image, the tallest images first, which keeps
+// the shelves full.  Packed pages are cut down to the height used.
+//
+// --------------------------------------------------------------
+std::vector<PageBuilder> placeImages(std::vector<Source>& sources)
+{
+    std::vector<Source*> order;
+    for (auto&& source : sources)
+    {
+        order.push_back(&source);
+    }
+    std::stable_sort(order.begin(), order.end(), [](auto a, auto b) { return a->image.getSize().y > b->image.getSize().y; });
+
+    std::vector<PageBuilder> pages;
+    for (auto source : order)
+    {
+        auto size = source->image.getSize();
+        if (size.x + assetpack::PADDING > assetpack::PAGE_SIZE || size.y + assetpack::PADDING > assetpack::PAGE_SIZE)
+        {
+            source->page = static_cast<std::uint32_t>(pages.size());
+            pages.push_back({size.x, size.y, nullptr, {}});
+            continue;
+        }
+
+        auto page = std::find_if(pages.begin(), pages.end(), [&](auto& page) { return page.packer && page.packer->place(size.x + assetpack::PADDING, size.y + assetpack::PADDING, source->left, source->top); });
+        if (page == pages.end())
+        {
+            pages.push_back({assetpack::PAGE_SIZE, 0, std::make_unique<ShelfPacker>(assetpack::PAGE_SIZE), {}});
+            page = pages.end() - 1;
+            page->packer->place(size.x + assetpack::PADDING, size.y + assetpack::PADDING, source->left, source->top);
+        }
+        source->page = static_cast<std::uint32_t>(page - pages.begin());
+    }
+
+    for (auto&& page : pages)
+    {
+        if (page.packer)
+        {
+            page.height = page.packer->getUsedHeight();
+        }
+        page.pixels.resize(static_cast<std::size_t>(page.width) * page.height * 4, 0);
+    }
+
+    for (auto&& source : sources)
+    {
+        auto& page = pages[source.page];
+        auto size = source.image.getSize();
+        for (std::uint32_t row = 0; row < size.y; row++)
+        {
+            std::memcpy(
+                page.pixels.data() + ((static_cast<std::size_t>(source.top) + row) * page.width + source.left) * 4,
+                source.image.getPixelsPtr() + static_cast<std::size_t>(row) * size.x * 4,
+                static_cast<std::size_t>(size.x) * 4);
+        }
+    }
+
+    return pages;
+}
+
+bool writePack(const std::string& path, const std::vector<Source>& sources, const std::vector<PageBuilder>& pages)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    assetpack::Header header{assetpack::MAGIC, assetpack::VERSION, static_cast<std::uint32_t>(pages.size()), static_cast<std::uint32_t>(sources.size())};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    //
+    // The pixels follow the index, each page's starting on an aligned offset
+    auto align = [](std::uint64_t offset) { return (offset + assetpack::PIXELS_ALIGNMENT - 1) / assetpack::PIXELS_ALIGNMENT * assetpack::PIXELS_ALIGNMENT; };
+    auto offset = align(sizeof(assetpack::Header) + sizeof(assetpack::Page) * pages.size() + sizeof(assetpack::Entry) * sources.size());
+    std::vector<std::uint64_t> offsets;
+    for (auto&& page : pages)
+    {
+        assetpack::Page written{page.width, page.height, offset};
+        file.write(reinterpret_cast<const char*>(&written), sizeof(written));
+        offsets.push_back(offset);
+        offset = align(offset + page.pixels.size());
+    }
+
+    for (auto&& source : sources)
+    {
+        assetpack::Entry entry{};
+        std::memcpy(entry.name, source.name.data(), source.name.size());
+        entry.page = source.page;
+        entry.left = source.left;
+        entry.top = source.top;
+        entry.width = source.image.getSize().x;
+        entry.height = source.image.getSize().y;
+        entry.frameCount = source.frameCount;
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    for (std::size_t i = 0; i < pages.size(); i++)
+    {
+        std::vector<char> padding(static_cast<std::size_t>(offsets[i] - static_cast<std::uint64_t>(file.tellp())), 0);
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<const char*>(pages[i].pixels.data()), pages[i].pixels.size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: AssetPack <pack file> <assets folder> <image>[:frames] ..." << std::endl;
+        return 1;
+    }
+    std::string folder = argv[2];
+
+    std::vector<Source> sources(argc - 3);
+    for (int i = 3; i < argc; i++)
+    {
+        auto& source = sources[i - 3];
+        std::string argument = argv[i];
+        auto colon = argument.find(':');
+        source.name = argument.substr(0, colon);
+        if (colon != std::string::npos)
+        {
+            source.frameCount = static_cast<std::uint32_t>(std::stoul(argument.substr(colon + 1)));
+        }
+
+        if (source.name.size() > assetpack::NAME_SIZE)
+        {
+            std::cout << "Image name is too long: " << source.name << std::endl;
+            return 1;
+        }
+        if (!source.image.loadFromFile(folder + "/" + source.name))
+        {
+            std::cout << "Failed to load image: " << source.name << std::endl;
+            return 1;
+        }
+        if (source.frameCount == 0 || source.image.getSize().x % source.frameCount != 0)
+        {
+            std::cout << "Frame count doesn't divide the width of: " << source.name << std::endl;
+            return 1;
+        }
+    }
+
+    auto pages = placeImages(sources);
+    if (!writePack(argv[1], sources, pages))
+    {
+        std::cout << "Failed to write the asset pack: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << sources.size() << " images into " << pages.size() << " pages: " << argv[1] << std::endl;
+
+    return 0;
+}
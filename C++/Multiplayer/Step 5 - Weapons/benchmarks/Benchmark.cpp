@@ -0,0 +1,129 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace benchmark
+{
+    const void* volatile sink = nullptr;
+
+    // --------------------------------------------------------------
+    //
+    // Calibrates the number of iterations per sample, then times the
+    // samples.  The calibration doubles as the warm up.
+    //
+    // --------------------------------------------------------------
+    void Runner::run(const std::string& name, const std::function<void(std::uint64_t)>& body, std::uint64_t itemsPerIteration)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+        {
+            return;
+        }
+
+        auto time = [&body](std::uint64_t iterations) {
+            auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            return std::chrono::steady_clock::now() - start;
+        };
+
+        std::uint64_t iterations = 1;
+        while (time(iterations) < MIN_SAMPLE_TIME)
+        {
+            iterations *= 2;
+        }
+
+        Result result{name, iterations, itemsPerIteration, {}, 0, 0, 0, 0, 0};
+        for (std::uint32_t sample = 0; sample < m_sampleCount; sample++)
+        {
+            auto elapsed = std::chrono::duration<double, std::nano>(time(iterations)).count();
+            result.samples.push_back(elapsed / static_cast<double>(iterations * itemsPerIteration));
+        }
+
+        auto sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        result.min = sorted.front();
+        result.max = sorted.back();
+        result.median = sorted.size() % 2 == 1 ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0;
+        result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        double variance = 0.0;
+        for (auto sample : sorted)
+        {
+            variance += (sample - result.mean) * (sample - result.mean);
+        }
+        result.stddev = std::sqrt(variance / sorted.size());
+
+        std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << result.median << " ns" << std::setw(14) << result.min << " ns"
+                  << std::setw(10) << (result.mean > 0 ? 100.0 * result.stddev / result.mean : 0.0) << " %" << std::endl;
+
+        m_results.push_back(result);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // A final summary of what was run.
+    //
+    // --------------------------------------------------------------
+    void Runner::report() const
+    {
+        std::cout << std::endl
+                  << m_results.size() << " benchmarks, " << m_sampleCount << " samples each (median, min, and relative standard deviation of ns per item)" << std::endl;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Writes the results, along with enough about the build to tell
+    // two result files apart.
+    //
+    // --------------------------------------------------------------
+    bool Runner::writeJson(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "Unable to write the results file: " << path << std::endl;
+            return false;
+        }
+
+#if defined(_MSC_VER)
+        std::string compiler = "MSVC " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+        std::string compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+        std::string compiler = "GCC " __VERSION__;
+#else
+        std::string compiler = "unknown";
+#endif
+#if defined(NDEBUG)
+        std::string build = "release";
+#else
+        std::string build = "debug";
+#endif
+        auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        file << std::setprecision(6) << std::fixed;
+        file << "{\n";
+        file << "  \"context\": {\"timestamp\": " << timestamp << ", \"compiler\": \"" << compiler << "\", \"build\": \"" << build << "\", \"samples\": " << m_sampleCount << "},\n";
+        file << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < m_results.size(); i++)
+        {
+            auto& result = m_results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations << ", \"items_per_iteration\": " << result.itemsPerIteration
+                 << ", \"unit\": \"ns\", \"median\": " << result.median << ", \"min\": " << result.min << ", \"mean\": " << result.mean
+                 << ", \"max\": " << result.max << ", \"stddev\": " << result.stddev << ", \"samples\": [";
+            for (std::size_t sample = 0; sample < result.samples.size(); sample++)
+            {
+                file << (sample > 0 ? ", " : "") << result.samples[sample];
+            }
+            file << "]}" << (i + 1 < m_results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        return true;
+    }
+} // namespace benchmark
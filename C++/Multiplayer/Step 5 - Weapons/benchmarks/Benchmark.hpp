@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// A small harness for timing the hot paths of the game.
+//
+// A benchmark is a function that performs its operation a given
+// number of times.  The runner grows that number until one batch
+// takes long enough to time reliably, then times a fixed number of
+// batches.  Everything a benchmark uses is built from fixed seeds
+// and sizes, so two builds time exactly the same work.
+//
+// Results are reported in nanoseconds per operation, on the console
+// and optionally as JSON, for comparing one build against another.
+//
+// --------------------------------------------------------------
+namespace benchmark
+{
+    struct Result
+    {
+        std::string name;
+        std::uint64_t iterations; // per sample
+        std::uint64_t itemsPerIteration;
+        std::vector<double> samples; // nanoseconds per item
+        double min;
+        double median;
+        double mean;
+        double max;
+        double stddev;
+    };
+
+    class Runner
+    {
+      public:
+        Runner(std::string filter, std::uint32_t sampleCount) :
+            m_filter(filter),
+            m_sampleCount(sampleCount)
+        {
+        }
+
+        void run(const std::string& name, const std::function<void(std::uint64_t)>& body, std::uint64_t itemsPerIteration = 1);
+
+        void report() const;
+        bool writeJson(const std::string& path) const;
+
+      private:
+        static constexpr auto MIN_SAMPLE_TIME = std::chrono::milliseconds(20);
+
+        std::string m_filter;
+        std::uint32_t m_sampleCount;
+        std::vector<Result> m_results;
+    };
+
+    //
+    // Keeps the compiler from optimizing away a value a benchmark computes
+    extern const void* volatile sink;
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+        sink = &value;
+    }
+
+    //
+    // Each group of benchmarks is in its own file
+    void registerEntities(Runner& runner);
+    void registerMath(Runner& runner);
+    void registerQueue(Runner& runner);
+    void registerMessages(Runner& runner);
+    void registerRendering(Runner& runner);
+    void registerSystems(Runner& runner);
+
+    //
+    // Checks the results of the kernels being timed, rather than their times
+    bool checkMath();
+} // namespace benchmark
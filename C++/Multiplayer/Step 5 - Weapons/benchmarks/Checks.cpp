@@ -0,0 +1,138 @@
+#include "Benchmark.hpp"
+#include "misc/Simd.hpp"
+#include "misc/math.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace benchmark
+{
+    const float SINCOS_RANGE = 8192.0f;   // math::sincos is accurate within it
+    const double SINCOS_MAX_ERROR = 2e-7; // against the double precision std::sin/std::cos
+    const std::size_t SINCOS_VALUES = 1 << 22;
+    const std::size_t CHECK_BATCH = 4099; // not a multiple of any vector width, so the tails are checked too
+
+    bool sameBits(float a, float b) { return std::memcmp(&a, &b, sizeof(float)) == 0; }
+
+    // --------------------------------------------------------------
+    //
+    // Sweeps math::sincos over (-8192, 8192) and checks it is within
+    // 2e-7 of the double precision standard library.  The batched
+    // version, with each instruction set this CPU supports, must give
+    // exactly the same bits as math::sincos.
+    //
+    // --------------------------------------------------------------
+    bool checkSincos()
+    {
+        std::vector<float> angles(SINCOS_VALUES);
+        for (std::size_t i = 0; i < SINCOS_VALUES; i++)
+        {
+            angles[i] = -SINCOS_RANGE + 2 * SINCOS_RANGE * (static_cast<float>(i) + 0.5f) / static_cast<float>(SINCOS_VALUES);
+        }
+        //
+        // Where the octants change is where the reduction is most likely to go wrong
+        for (float octant = -SINCOS_RANGE; octant < SINCOS_RANGE; octant += math::PI / 4)
+        {
+            angles.push_back(octant);
+            angles.push_back(std::nextafter(octant, -SINCOS_RANGE));
+            angles.push_back(std::nextafter(octant, SINCOS_RANGE));
+        }
+        angles.push_back(0.0f);
+        angles.push_back(-0.0f);
+
+        bool passed = true;
+        double maxError = 0;
+        std::vector<float> sines(angles.size());
+        std::vector<float> cosines(angles.size());
+        for (std::size_t i = 0; i < angles.size(); i++)
+        {
+            math::sincos(angles[i], sines[i], cosines[i]);
+            auto error = std::max(std::fabs(sines[i] - std::sin(static_cast<double>(angles[i]))), std::fabs(cosines[i] - std::cos(static_cast<double>(angles[i]))));
+            if (error >= SINCOS_MAX_ERROR && passed)
+            {
+                std::cout << "math::sincos(" << angles[i] << ") is off by " << error << std::endl;
+                passed = false;
+            }
+            maxError = std::max(maxError, error);
+        }
+        std::cout << "math::sincos largest error " << maxError << std::endl;
+
+        for (auto isa : {simd::Isa::Scalar, simd::Isa::Sse, simd::Isa::Avx2})
+        {
+            if (!simd::isSupported(isa))
+            {
+                continue;
+            }
+
+            std::vector<float> batchSines(angles.size());
+            std::vector<float> batchCosines(angles.size());
+            for (std::size_t begin = 0; begin < angles.size(); begin += CHECK_BATCH)
+            {
+                auto count = std::min(CHECK_BATCH, angles.size() - begin);
+                math::sincos(angles.data() + begin, batchSines.data() + begin, batchCosines.data() + begin, count, isa);
+            }
+            for (std::size_t i = 0; i < angles.size(); i++)
+            {
+                if (!sameBits(batchSines[i], sines[i]) || !sameBits(batchCosines[i], cosines[i]))
+                {
+                    std::cout << "math::sincos (" << simd::toString(isa) << ") differs from math::sincos at " << angles[i] << std::endl;
+                    passed = false;
+                    break;
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The batched math::distanceSquared, with each instruction set this
+    // CPU supports, must give exactly the same bits as the one for a
+    // single point.
+    //
+    // --------------------------------------------------------------
+    bool checkDistanceSquared()
+    {
+        math::Vector2fBlock points;
+        for (std::size_t i = 0; i < CHECK_BATCH; i++)
+        {
+            points.push_back({static_cast<float>(i % 97) * 0.013f - 0.6f, static_cast<float>(i / 97) * 0.029f - 0.6f});
+        }
+        math::Vector2f to(0.37f, -0.21f);
+
+        bool passed = true;
+        for (auto isa : {simd::Isa::Scalar, simd::Isa::Sse, simd::Isa::Avx2})
+        {
+            if (!simd::isSupported(isa))
+            {
+                continue;
+            }
+
+            std::vector<float> distances(points.size());
+            math::distanceSquared(points, to, distances.data(), isa);
+            for (std::size_t i = 0; i < points.size(); i++)
+            {
+                if (!sameBits(distances[i], math::distanceSquared(points.get(i), to)))
+                {
+                    std::cout << "math::distanceSquared (" << simd::toString(isa) << ") differs from math::distanceSquared at point " << i << std::endl;
+                    passed = false;
+                    break;
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    bool checkMath()
+    {
+        auto sincos = checkSincos();
+        auto distanceSquared = checkDistanceSquared();
+
+        return sincos && distanceSquared;
+    }
+} // namespace benchmark
@@ -0,0 +1,118 @@
+#include "Benchmark.hpp"
+#include "components/Momentum.hpp"
+#include "components/Position.hpp"
+#include "components/Size.hpp"
+#include "entities/Create.hpp"
+#include "entities/Prefab.hpp"
+#include "systems/System.hpp"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace benchmark
+{
+    //
+    // Enough entities that a system's map doesn't stay in the L1 cache
+    const std::size_t ENTITY_COUNT = 1024;
+
+    // --------------------------------------------------------------
+    //
+    // Entity component access, and how a system decides whether an
+    // entity belongs to it.
+    //
+    // --------------------------------------------------------------
+    void registerEntities(Runner& runner)
+    {
+        runner.run("Entity::addComponent", [](std::uint64_t iterations) {
+            entities::Entity entity;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                entity.addComponent(std::make_unique<components::Position>(math::Vector2f(0.0f, 0.0f)));
+            }
+            doNotOptimize(entity);
+        });
+
+        runner.run("Entity::getComponent", [](std::uint64_t iterations) {
+            auto entity = entities::player::create("", {0.0f, 0.0f}, 0.05f, 0.0002f, 0.002f, {0.0f, 0.0f}, 100.0f);
+            float total = 0.0f;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                total += entity->getComponent<components::Position>()->get().x;
+            }
+            doNotOptimize(total);
+        });
+
+        runner.run("Entity::hasComponent", [](std::uint64_t iterations) {
+            auto entity = entities::player::create("", {0.0f, 0.0f}, 0.05f, 0.0002f, 0.002f, {0.0f, 0.0f}, 100.0f);
+            std::uint64_t total = 0;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                total += entity->hasComponent<components::Size>() ? 1 : 0;
+            }
+            doNotOptimize(total);
+        });
+
+        //
+        // Players have everything the system wants, explosions have no momentum
+        entities::EntityVector players;
+        entities::EntityVector explosions;
+        for (std::size_t i = 0; i < ENTITY_COUNT; i++)
+        {
+            math::Vector2f position(static_cast<float>(i) * 0.01f, 0.0f);
+            players.push_back(entities::player::create("", position, 0.05f, 0.0002f, 0.002f, {0.0f, 0.0f}, 100.0f));
+            explosions.push_back(entities::explosion::create("", position, 0.05f, {std::chrono::milliseconds(50)}));
+        }
+
+        runner.run("System::addEntity (interested)", [&players](std::uint64_t iterations) {
+            systems::System system({ctti::unnamed_type_id<components::Position>(), ctti::unnamed_type_id<components::Momentum>()});
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                system.addEntity(players[i % players.size()]);
+            }
+            doNotOptimize(system);
+        });
+
+        runner.run("System::addEntity (not interested)", [&explosions](std::uint64_t iterations) {
+            systems::System system({ctti::unnamed_type_id<components::Position>(), ctti::unnamed_type_id<components::Momentum>()});
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                system.addEntity(explosions[i % explosions.size()]);
+            }
+            doNotOptimize(system);
+        });
+
+        //
+        // Spawning an explosion from scratch versus from its prefab
+        runner.run("explosion::create", [](std::uint64_t iterations) {
+            auto fiftyMS = std::chrono::milliseconds(50);
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                auto entity = entities::explosion::create("explosion.png", {0.0f, 0.0f}, 0.07f, std::vector<std::chrono::milliseconds>(16, fiftyMS));
+                doNotOptimize(entity);
+            }
+        });
+
+        runner.run("Prefab::instantiate (explosion)", [](std::uint64_t iterations) {
+            auto& prefab = entities::PrefabRegistry::instance().get("explosion");
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                auto entity = prefab.instantiate();
+                doNotOptimize(entity);
+            }
+        });
+
+        runner.run(
+            "spawnBatch (missile) 256", [](std::uint64_t iterations) {
+                auto& prefab = entities::PrefabRegistry::instance().get("missile");
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    auto missiles = entities::spawnBatch(prefab, 256, [](entities::Entity& missile, std::size_t index) {
+                        missile.getComponent<components::Position>()->set({static_cast<float>(index) * 0.001f, 0.0f});
+                    });
+                    doNotOptimize(missiles);
+                }
+            },
+            256);
+    }
+} // namespace benchmark
@@ -0,0 +1,78 @@
+#include "Benchmark.hpp"
+#include "misc/Simd.hpp"
+#include "misc/math.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+    const std::size_t MATH_VALUES = 4096;
+
+    // --------------------------------------------------------------
+    //
+    // The math library's batched kernels with each instruction set this
+    // CPU supports, against the standard library.  The times are per
+    // value.
+    //
+    // --------------------------------------------------------------
+    void registerMath(Runner& runner)
+    {
+        auto angles = std::make_shared<std::vector<float>>(MATH_VALUES);
+        auto points = std::make_shared<math::Vector2fBlock>();
+        for (std::size_t i = 0; i < MATH_VALUES; i++)
+        {
+            (*angles)[i] = math::toRadians(static_cast<float>(i % 720) - 360.0f);
+            points->push_back({static_cast<float>(i % 64) * 0.03f, static_cast<float>(i / 64) * 0.03f});
+        }
+
+        runner.run(
+            "std::sin/std::cos", [angles](std::uint64_t iterations) {
+                std::vector<float> sines(MATH_VALUES);
+                std::vector<float> cosines(MATH_VALUES);
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    for (std::size_t value = 0; value < MATH_VALUES; value++)
+                    {
+                        sines[value] = std::sin((*angles)[value]);
+                        cosines[value] = std::cos((*angles)[value]);
+                    }
+                    doNotOptimize(sines[0]);
+                }
+            },
+            MATH_VALUES);
+
+        for (auto isa : {simd::Isa::Scalar, simd::Isa::Sse, simd::Isa::Avx2})
+        {
+            if (!simd::isSupported(isa))
+            {
+                continue;
+            }
+
+            runner.run(
+                "math::sincos (" + std::string(simd::toString(isa)) + ")", [angles, isa](std::uint64_t iterations) {
+                    std::vector<float> sines(MATH_VALUES);
+                    std::vector<float> cosines(MATH_VALUES);
+                    for (std::uint64_t i = 0; i < iterations; i++)
+                    {
+                        math::sincos(angles->data(), sines.data(), cosines.data(), MATH_VALUES, isa);
+                        doNotOptimize(sines[0]);
+                    }
+                },
+                MATH_VALUES);
+
+            runner.run(
+                "math::distanceSquared (" + std::string(simd::toString(isa)) + ")", [points, isa](std::uint64_t iterations) {
+                    std::vector<float> distances(MATH_VALUES);
+                    for (std::uint64_t i = 0; i < iterations; i++)
+                    {
+                        math::distanceSquared(*points, {0.5f, 0.5f}, distances.data(), isa);
+                        doNotOptimize(distances[0]);
+                    }
+                },
+                MATH_VALUES);
+        }
+    }
+} // namespace benchmark
@@ -0,0 +1,53 @@
+#include "Benchmark.hpp"
+#include "entities/Create.hpp"
+#include "messages/UpdateEntity.hpp"
+#include "messages/Utility.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace benchmark
+{
+    // --------------------------------------------------------------
+    //
+    // Encoding a whole entity, as for NewEntity, and the round trip of
+    // the UpdateEntity message that dominates the server's traffic.
+    //
+    // --------------------------------------------------------------
+    void registerMessages(Runner& runner)
+    {
+        auto player = entities::player::create("playerShip-self.png", {0.25f, -0.5f}, 0.05f, 0.0002f, 0.002f, {0.001f, 0.002f}, 100.0f);
+        auto serverTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+
+        runner.run("createPBEntity", [&player](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                auto pbEntity = messages::createPBEntity(player);
+                doNotOptimize(pbEntity);
+            }
+        });
+
+        runner.run("UpdateEntity::serializeToString", [&player, serverTime](std::uint64_t iterations) {
+            messages::UpdateEntity message(player, std::chrono::milliseconds(100), 1, serverTime);
+            message.setMessageId(1);
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                auto serialized = message.serializeToString();
+                doNotOptimize(serialized);
+            }
+        });
+
+        messages::UpdateEntity message(player, std::chrono::milliseconds(100), 1, serverTime);
+        message.setMessageId(1);
+        auto serialized = message.serializeToString();
+        runner.run("UpdateEntity::parseFromString", [&serialized](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                messages::UpdateEntity parsed;
+                parsed.parseFromString(serialized);
+                doNotOptimize(parsed);
+            }
+        });
+    }
+} // namespace benchmark
@@ -0,0 +1,91 @@
+#include "Benchmark.hpp"
+#include "ConcurrentQueue.hpp"
+#include "messages/Ping.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace benchmark
+{
+    //
+    // The same item the server's shards queue for sending
+    using Item = std::tuple<std::uint64_t, std::optional<std::uint32_t>, std::shared_ptr<messages::Message>>;
+
+    const std::uint64_t ITEMS_PER_RUN = 100000;
+
+    // --------------------------------------------------------------
+    //
+    // Producers enqueue their share of the items while consumers
+    // dequeue until all of them have come out the other end.
+    //
+    // --------------------------------------------------------------
+    void contend(std::uint32_t producers, std::uint32_t consumers, std::shared_ptr<messages::Message> message)
+    {
+        ConcurrentQueue<Item> queue;
+        std::atomic<std::uint64_t> consumed{0};
+        std::vector<std::thread> threads;
+        for (std::uint32_t producer = 0; producer < producers; producer++)
+        {
+            threads.emplace_back([&queue, producer, producers, message]() {
+                for (std::uint64_t item = producer; item < ITEMS_PER_RUN; item += producers)
+                {
+                    queue.enqueue(std::make_tuple(item, std::nullopt, message));
+                }
+            });
+        }
+        for (std::uint32_t consumer = 0; consumer < consumers; consumer++)
+        {
+            threads.emplace_back([&queue, &consumed]() {
+                while (consumed.load(std::memory_order_relaxed) < ITEMS_PER_RUN)
+                {
+                    if (queue.dequeue())
+                    {
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The queue on its own, then with threads fighting over its lock.
+    //
+    // --------------------------------------------------------------
+    void registerQueue(Runner& runner)
+    {
+        auto message = std::make_shared<messages::Ping>();
+
+        runner.run("ConcurrentQueue enqueue/dequeue", [message](std::uint64_t iterations) {
+            ConcurrentQueue<Item> queue;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                queue.enqueue(std::make_tuple(i, std::nullopt, message));
+                auto item = queue.dequeue();
+                doNotOptimize(item);
+            }
+        });
+
+        for (auto [producers, consumers] : {std::make_tuple(1u, 1u), std::make_tuple(2u, 2u), std::make_tuple(4u, 4u)})
+        {
+            auto name = "ConcurrentQueue producers/consumers " + std::to_string(producers) + "/" + std::to_string(consumers);
+            runner.run(
+                name, [producers = producers, consumers = consumers, message](std::uint64_t iterations) {
+                    for (std::uint64_t i = 0; i < iterations; i++)
+                    {
+                        contend(producers, consumers, message);
+                    }
+                },
+                ITEMS_PER_RUN);
+        }
+    }
+} // namespace benchmark
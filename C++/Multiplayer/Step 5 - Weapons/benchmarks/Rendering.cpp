@@ -0,0 +1,127 @@
+#include "Benchmark.hpp"
+#include "QuadTree.hpp"
+#include "SpriteBatch.hpp"
+#include "misc/math.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmark
+{
+    const std::size_t BATCHED_SPRITES = 10000;
+    const std::size_t CULLED_ENTITIES = 10000;
+    const float CULLED_WORLD_SIZE = 16.0f; // a unit view is 1/256th of it
+
+    // --------------------------------------------------------------
+    //
+    // Building a frame's sprite batches, spinning sprites spread over the
+    // given number of textures: all drawn from one atlas page, or taking
+    // turns between textures, which is the worst case for finding the
+    // batch.  The textures are never created, there is nothing to draw
+    // with.  The times are per sprite.
+    //
+    // --------------------------------------------------------------
+    void spriteBatch(Runner& runner, std::size_t textureCount)
+    {
+        auto textures = std::make_shared<std::vector<sf::Texture>>(textureCount);
+        auto batch = std::make_shared<SpriteBatch>();
+
+        auto name = "SpriteBatch::add " + std::to_string(BATCHED_SPRITES) + " (" + std::to_string(textureCount) + (textureCount == 1 ? " texture)" : " textures)");
+        runner.run(
+            name, [textures, batch](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    batch->clear();
+                    for (std::size_t sprite = 0; sprite < BATCHED_SPRITES; sprite++)
+                    {
+                        auto& texture = (*textures)[sprite % textures->size()];
+                        sf::IntRect rect(static_cast<int>(sprite % 16) * 64, 0, 64, 64);
+                        sf::Vector2f position(static_cast<float>(sprite % 100) * 0.01f, static_cast<float>(sprite / 100) * 0.01f);
+                        batch->add(texture, rect, {32.0f, 32.0f}, {0.0005f, 0.0005f}, position, static_cast<float>(sprite + i));
+                    }
+                    doNotOptimize(batch->getBatch(0).vertices.getVertexCount());
+                }
+            },
+            BATCHED_SPRITES);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Entities the size of a ship spread evenly over a world many views
+    // across, kept in a quadtree.  Finding those in a view, against
+    // testing every one of them, the times are per search.  Moving all
+    // of them a little, as the client does each frame, the times are
+    // per entity.
+    //
+    // --------------------------------------------------------------
+    void quadTree(Runner& runner)
+    {
+        const float SIZE = 0.05f;
+        auto tree = std::make_shared<QuadTree>(math::Vector2f(0.0f, 0.0f), CULLED_WORLD_SIZE);
+        auto bounds = std::make_shared<std::vector<QuadTree::Bounds>>();
+        auto perRow = static_cast<std::size_t>(std::sqrt(static_cast<float>(CULLED_ENTITIES)));
+        auto spacing = CULLED_WORLD_SIZE / static_cast<float>(perRow);
+        for (std::size_t i = 0; i < CULLED_ENTITIES; i++)
+        {
+            math::Vector2f center(static_cast<float>(i % perRow) * spacing - CULLED_WORLD_SIZE / 2, static_cast<float>(i / perRow) * spacing - CULLED_WORLD_SIZE / 2);
+            bounds->push_back({center - math::Vector2f(SIZE, SIZE) * 0.5f, center + math::Vector2f(SIZE, SIZE) * 0.5f});
+            tree->insert(i, bounds->back());
+        }
+        QuadTree::Bounds view{{-0.5f, -0.5f}, {0.5f, 0.5f}};
+
+        runner.run("QuadTree::query " + std::to_string(CULLED_ENTITIES) + " (one view)", [tree, view](std::uint64_t iterations) {
+            std::vector<entities::Entity::IdType> found;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                found.clear();
+                tree->query(view, found);
+                doNotOptimize(found.size());
+            }
+        });
+
+        runner.run("Linear scan " + std::to_string(CULLED_ENTITIES) + " (one view)", [bounds, view](std::uint64_t iterations) {
+            std::vector<entities::Entity::IdType> found;
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                found.clear();
+                for (std::size_t entity = 0; entity < bounds->size(); entity++)
+                {
+                    auto& item = (*bounds)[entity];
+                    if (item.min.x <= view.max.x && item.max.x >= view.min.x && item.min.y <= view.max.y && item.max.y >= view.min.y)
+                    {
+                        found.push_back(entity);
+                    }
+                }
+                doNotOptimize(found.size());
+            }
+        });
+
+        runner.run(
+            "QuadTree::update " + std::to_string(CULLED_ENTITIES), [tree, bounds](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    //
+                    // Back and forth, so the entities stay where they started
+                    math::Vector2f step(i % 2 == 0 ? 0.004f : -0.004f, 0.001f * (i % 2 == 0 ? 1.0f : -1.0f));
+                    for (std::size_t entity = 0; entity < bounds->size(); entity++)
+                    {
+                        auto& item = (*bounds)[entity];
+                        item.min += step;
+                        item.max += step;
+                        tree->update(entity, item);
+                    }
+                }
+            },
+            CULLED_ENTITIES);
+    }
+
+    void registerRendering(Runner& runner)
+    {
+        spriteBatch(runner, 1);
+        spriteBatch(runner, 4);
+        quadTree(runner);
+    }
+} // namespace benchmark
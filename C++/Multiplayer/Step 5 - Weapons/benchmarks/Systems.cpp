@@ -0,0 +1,232 @@
+#include "Benchmark.hpp"
+#include "components/AnimatedSprite.hpp"
+#include "components/Goal.hpp"
+#include "components/Health.hpp"
+#include "components/Lifetime.hpp"
+#include "components/Momentum.hpp"
+#include "components/Position.hpp"
+#include "components/Size.hpp"
+#include "components/Weapon.hpp"
+#include "entities/CommandBuffer.hpp"
+#include "entities/Create.hpp"
+#include "misc/GameClock.hpp"
+#include "misc/Kinematics.hpp"
+#include "systems/Animation.hpp" // the client's
+#include "systems/Damage.hpp"
+#include "systems/Lifetime.hpp"
+#include "systems/Momentum.hpp" // the client's, see CMakeLists.txt
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace benchmark
+{
+    const auto FRAME_TIME = std::chrono::microseconds(16667);
+    const std::size_t MOMENTUM_ENTITIES = 10000;
+    const std::size_t LIFETIME_ENTITIES = 10000;
+    const std::size_t KINEMATICS_ENTITIES = 100000;
+    const std::size_t ANIMATION_ENTITIES = 10000;
+
+    // --------------------------------------------------------------
+    //
+    // A Damage system with weapons that never hit the targets, so each
+    // update tests every weapon against every target.  With lag, each
+    // test first rewinds the target through its position history.  The
+    // times are per weapon/target test.
+    //
+    // --------------------------------------------------------------
+    void damage(Runner& runner, std::size_t weaponCount, std::size_t targetCount, std::chrono::microseconds lag)
+    {
+        auto system = std::make_shared<systems::Damage>();
+        for (std::size_t target = 0; target < targetCount; target++)
+        {
+            system->addEntity(entities::player::create("", {static_cast<float>(target) * 0.1f, 0.0f}, 0.05f, 0.0002f, 0.002f, {0.0f, 0.0f}, 100.0f));
+        }
+        for (std::size_t weapon = 0; weapon < weaponCount; weapon++)
+        {
+            auto missile = std::make_shared<entities::Entity>();
+            missile->addComponent(std::make_unique<components::Position>(math::Vector2f(static_cast<float>(weapon) * 0.1f, 10.0f)));
+            missile->addComponent(std::make_unique<components::Size>(math::Vector2f(0.01f, 0.01f)));
+            missile->addComponent(std::make_unique<components::Weapon>(1.0f, 0));
+            missile->getComponent<components::Weapon>()->setLagCompensation(lag);
+            system->addEntity(missile);
+        }
+
+        auto name = "Damage::update " + std::to_string(weaponCount) + "x" + std::to_string(targetCount) + (lag.count() > 0 ? " (rewound)" : "");
+        auto now = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+        runner.run(
+            name, [system, &now](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    now += FRAME_TIME;
+                    system->update(FRAME_TIME, now);
+                }
+            },
+            weaponCount * targetCount);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The client's Momentum system over a mix of entities: half are
+    // interpolating toward a goal from the server, half are floating
+    // along with entity prediction.
+    //
+    // --------------------------------------------------------------
+    void momentum(Runner& runner)
+    {
+        auto now = std::chrono::steady_clock::now();
+        systems::Momentum system;
+        entities::CommandBuffer commands;
+        for (std::size_t i = 0; i < MOMENTUM_ENTITIES; i++)
+        {
+            auto entity = std::make_shared<entities::Entity>();
+            entity->addComponent(std::make_unique<components::Position>(math::Vector2f(static_cast<float>(i % 100) * 0.02f, static_cast<float>(i / 100) * 0.02f)));
+            entity->addComponent(std::make_unique<components::Size>(math::Vector2f(0.05f, 0.05f)));
+            entity->addComponent(std::make_unique<components::Momentum>(math::Vector2f(0.00001f, -0.00001f)));
+            commands.spawn(entity);
+        }
+        //
+        // The system gives each entity a Goal as it is added
+        entities::EntityMap entities;
+        commands.playback(entities, {&system});
+
+        std::size_t i = 0;
+        for (auto& [id, entity] : entities)
+        {
+            (void)id; // unused
+            auto goal = entity->getComponent<components::Goal>();
+            if (i % 2 == 0)
+            {
+                goal->setGoalPosition({goal->getStartPosition().x + 1.0f, goal->getStartPosition().y});
+                goal->setUpdateWindow(std::chrono::hours(1)); // still interpolating for the whole benchmark
+            }
+            else
+            {
+                entity->getComponent<components::Position>()->setLastServerUpdate(now);
+            }
+            i++;
+        }
+
+        runner.run(
+            "Momentum::update (client) " + std::to_string(MOMENTUM_ENTITIES), [&system, &now](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    now += FRAME_TIME;
+                    system.update(FRAME_TIME, now);
+                }
+            },
+            MOMENTUM_ENTITIES);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The Lifetime system over entities that don't expire while the
+    // benchmark runs, the cost of waiting.  The times are per update.
+    //
+    // --------------------------------------------------------------
+    void lifetime(Runner& runner)
+    {
+        auto system = std::make_shared<systems::Lifetime>();
+        for (std::size_t i = 0; i < LIFETIME_ENTITIES; i++)
+        {
+            auto entity = std::make_shared<entities::Entity>();
+            entity->addComponent(std::make_unique<components::Lifetime>(std::chrono::hours(24) + std::chrono::milliseconds(i)));
+            system->addEntity(entity);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        runner.run("Lifetime::update " + std::to_string(LIFETIME_ENTITIES), [system, &now](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                now += FRAME_TIME;
+                GameClock::instance().advance(FRAME_TIME);
+                system->update(FRAME_TIME, now);
+            }
+        });
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The client's Animation system over explosions, all sharing one
+    // clip and started at different times.  The times are per entity.
+    //
+    // --------------------------------------------------------------
+    void animation(Runner& runner)
+    {
+        auto clip = std::make_shared<AnimationClip>();
+        for (int frame = 0; frame < 16; frame++)
+        {
+            clip->frames.push_back(sf::IntRect(frame * 64, 0, 64, 64));
+            clip->frameTimes.push_back(std::chrono::milliseconds(50));
+        }
+
+        auto system = std::make_shared<systems::Animation>();
+        for (std::size_t i = 0; i < ANIMATION_ENTITIES; i++)
+        {
+            auto entity = std::make_shared<entities::Entity>();
+            entity->addComponent(std::make_unique<components::AnimatedSprite>(clip, sf::Vector2f(1.0f, 1.0f)));
+            entity->getComponent<components::AnimatedSprite>()->updateElapsedTime(std::chrono::microseconds(i * 97 % 50000));
+            system->addEntity(entity);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        runner.run(
+            "Animation::update " + std::to_string(ANIMATION_ENTITIES), [system, &now](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    now += FRAME_TIME;
+                    system->update(FRAME_TIME, now);
+                }
+            },
+            ANIMATION_ENTITIES);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The batched drift with each instruction set this CPU supports.
+    // The times are per entity.
+    //
+    // --------------------------------------------------------------
+    void drift(Runner& runner)
+    {
+        auto batch = std::make_shared<kinematics::Batch>();
+        batch->resize(KINEMATICS_ENTITIES);
+        for (std::size_t i = 0; i < KINEMATICS_ENTITIES; i++)
+        {
+            batch->position.set(i, {static_cast<float>(i % 100) * 0.02f, static_cast<float>(i / 100) * 0.02f});
+            batch->velocity.set(i, {0.0000003f, -0.0000001f});
+            batch->dt[i] = static_cast<float>(FRAME_TIME.count());
+        }
+
+        for (auto isa : {simd::Isa::Scalar, simd::Isa::Sse, simd::Isa::Avx2})
+        {
+            if (simd::isSupported(isa))
+            {
+                runner.run(
+                    "kinematics::drift (" + std::string(simd::toString(isa)) + ") " + std::to_string(KINEMATICS_ENTITIES), [batch, isa](std::uint64_t iterations) {
+                        for (std::uint64_t i = 0; i < iterations; i++)
+                        {
+                            kinematics::drift(*batch, isa);
+                        }
+                        doNotOptimize(batch->position.x[0]);
+                    },
+                    KINEMATICS_ENTITIES);
+            }
+        }
+    }
+
+    void registerSystems(Runner& runner)
+    {
+        for (auto [weapons, targets] : {std::make_tuple(10u, 10u), std::make_tuple(100u, 100u), std::make_tuple(1000u, 100u)})
+        {
+            damage(runner, weapons, targets, std::chrono::microseconds(0));
+            damage(runner, weapons, targets, std::chrono::milliseconds(100));
+        }
+        momentum(runner);
+        lifetime(runner);
+        animation(runner);
+        drift(runner);
+    }
+} // namespace benchmark
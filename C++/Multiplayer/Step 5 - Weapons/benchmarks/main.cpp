@@ -0,0 +1,88 @@
+#include "Benchmark.hpp"
+
+#include <cstdint>
+#include <google/protobuf/stubs/common.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// --------------------------------------------------------------
+//
+// Usage: Benchmarks [--filter <text>] [--samples <count>] [--json <file>] [--check]
+//
+// Runs the microbenchmarks whose names contain the filter text (all
+// of them by default), optionally writing the results as JSON.  Build
+// in Release before comparing results.
+//
+// The math kernels' results are checked first, their accuracy and
+// that every instruction set gives the same bits; the benchmarks
+// don't run if they fail.  With --check only the checks are run.
+//
+// --------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    std::string filter;
+    std::uint32_t samples = 10;
+    std::string jsonFile;
+    bool checkOnly = false;
+    for (int arg = 1; arg < argc; arg++)
+    {
+        std::string option = argv[arg];
+        if (arg + 1 < argc && option == "--filter")
+        {
+            filter = argv[++arg];
+        }
+        else if (arg + 1 < argc && option == "--samples")
+        {
+            samples = static_cast<std::uint32_t>(std::stoul(argv[++arg]));
+        }
+        else if (arg + 1 < argc && option == "--json")
+        {
+            jsonFile = argv[++arg];
+        }
+        else if (option == "--check")
+        {
+            checkOnly = true;
+        }
+        else
+        {
+            std::cout << "Usage: Benchmarks [--filter <text>] [--samples <count>] [--json <file>] [--check]" << std::endl;
+            return 1;
+        }
+    }
+    if (samples == 0)
+    {
+        samples = 1;
+    }
+
+    if (!benchmark::checkMath())
+    {
+        std::cout << "Math checks failed" << std::endl;
+        return 1;
+    }
+    if (checkOnly)
+    {
+        return 0;
+    }
+
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(17) << "Median" << std::setw(17) << "Min" << std::setw(12) << "RSD" << std::endl;
+    benchmark::Runner runner(filter, samples);
+    benchmark::registerEntities(runner);
+    benchmark::registerMath(runner);
+    benchmark::registerQueue(runner);
+    benchmark::registerMessages(runner);
+    benchmark::registerRendering(runner);
+    benchmark::registerSystems(runner);
+    runner.report();
+
+    if (!jsonFile.empty() && !runner.writeJson(jsonFile))
+    {
+        return 1;
+    }
+
+    google::protobuf::ShutdownProtobufLibrary();
+
+    return 0;
+}
@@ -0,0 +1,350 @@
+#include "AssetCache.hpp"
+
+#include "AssetPack.hpp"
+#include "misc/Profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+// --------------------------------------------------------------
+//
+// Creates a texture from each page of the asset pack, straight from
+// the mapped pixels, and adds all of the pack's images to the cache.
+// Returns false if there is no usable pack.
+//
+// --------------------------------------------------------------
+bool AssetCache::loadPack(const std::string& path)
+{
+    assetpack::Pack pack;
+    if (!pack.open(path))
+    {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<sf::Texture>> pages;
+    for (std::uint32_t i = 0; i < pack.getPageCount(); i++)
+    {
+        auto& page = pack.getPage(i);
+        auto texture = std::make_shared<sf::Texture>();
+        if (!texture->create(page.width, page.height))
+        {
+            std::cout << "Failed to create texture for asset pack page: " << i << std::endl;
+            return false;
+        }
+        texture->update(pack.getPixels(page));
+        pages.push_back(texture);
+    }
+
+    for (std::uint32_t i = 0; i < pack.getEntryCount(); i++)
+    {
+        auto& entry = pack.getEntry(i);
+        auto region = std::make_shared<TextureRegion>();
+        region->texture = pages[entry.page];
+        region->rect = sf::IntRect(static_cast<int>(entry.left), static_cast<int>(entry.top), static_cast<int>(entry.width), static_cast<int>(entry.height));
+        if (entry.frameCount > 1)
+        {
+            auto frameWidth = region->rect.width / static_cast<int>(entry.frameCount);
+            for (int frame = 0; frame < static_cast<int>(entry.frameCount); frame++)
+            {
+                region->frames.push_back(sf::IntRect(region->rect.left + frame * frameWidth, region->rect.top, frameWidth, region->rect.height));
+            }
+        }
+        m_textures[assetpack::getName(entry)] = region;
+    }
+    m_packPages.insert(m_packPages.end(), pages.begin(), pages.end());
+
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// Starts the thread that reads and decodes the requested images.
+//
+// --------------------------------------------------------------
+void AssetCache::startLoader()
+{
+    m_threadLoader = std::thread([this]() {
+        PROFILE_THREAD("Asset loader");
+        while (true)
+        {
+            std::string name;
+            {
+                std::unique_lock<std::mutex> lock(m_mutexRequests);
+                m_eventRequests.wait(lock, [this]() { return !m_keepRunning || !m_requests.empty(); });
+                if (!m_keepRunning)
+                {
+                    return;
+                }
+                name = m_requests.front();
+                m_requests.pop();
+            }
+
+            PROFILE_SCOPE("AssetCache::decode");
+            auto image = std::make_shared<sf::Image>();
+            if (!image->loadFromFile(m_directory + name))
+            {
+                image = nullptr;
+            }
+            m_decoded.enqueue({name, image});
+        }
+    });
+}
+
+void AssetCache::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexRequests);
+        m_keepRunning = false;
+    }
+    m_eventRequests.notify_one();
+    if (m_threadLoader.joinable())
+    {
+        m_threadLoader.join();
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Asks for the named image to be loaded, unless it already is (or
+// is on its way, or failed to load before).
+//
+// --------------------------------------------------------------
+void AssetCache::request(const std::string& name)
+{
+    if (m_textures.count(name) > 0 || m_pending.count(name) > 0 || m_failed.count(name) > 0)
+    {
+        return;
+    }
+
+    if (!m_threadLoader.joinable())
+    {
+        sf::Image image;
+        if (!image.loadFromFile(m_directory + name))
+        {
+            std::cout << "Failed to load texture: " << name << std::endl;
+            m_failed.insert(name);
+            return;
+        }
+        add(name, image);
+        return;
+    }
+
+    m_pending.insert(name);
+    {
+        std::lock_guard<std::mutex> lock(m_mutexRequests);
+        m_requests.push(name);
+    }
+    m_eventRequests.notify_one();
+}
+
+// --------------------------------------------------------------
+//
+// Returns the region for the named image, requesting it the first
+// time it is asked for.  Returns nullptr while it is being loaded, or
+// if it couldn't be loaded.
+//
+// --------------------------------------------------------------
+std::shared_ptr<const TextureRegion> AssetCache::getTexture(const std::string& name)
+{
+    request(name);
+
+    auto found = m_textures.find(name);
+    return found != m_textures.end() ? found->second : nullptr;
+}
+
+// --------------------------------------------------------------
+//
+// A small, faint square, shown in place of an image still loading.
+//
+// --------------------------------------------------------------
+std::shared_ptr<const TextureRegion> AssetCache::getPlaceholder()
+{
+    if (m_placeholder == nullptr)
+    {
+        sf::Image image;
+        image.create(PLACEHOLDER_SIZE, PLACEHOLDER_SIZE, sf::Color(255, 255, 255, 64));
+        m_placeholder = pack(image);
+    }
+
+    return m_placeholder;
+}
+
+// --------------------------------------------------------------
+//
+// Returns the clip for the sheet and frame times, making it the first
+// time it is asked for.  The frames are the sheet's frames from the
+// asset pack, or else equal slices across it.  The placeholder isn't a
+// sheet, all of its frames are the whole placeholder.
+//
+// --------------------------------------------------------------
+std::shared_ptr<const AnimationClip> AssetCache::getClip(std::shared_ptr<const TextureRegion> sheet, const std::vector<std::chrono::milliseconds>& frameTimes)
+{
+    auto key = std::make_tuple(sheet.get(), frameTimes);
+    auto found = m_clips.find(key);
+    if (found != m_clips.end())
+    {
+        return found->second;
+    }
+
+    auto clip = std::make_shared<AnimationClip>();
+    clip->sheet = sheet;
+    auto frameCount = static_cast<int>(frameTimes.size());
+    auto isPlaceholder = sheet == m_placeholder;
+    for (int i = 0; i < frameCount; i++)
+    {
+        if (sheet->frames.size() == frameTimes.size())
+        {
+            clip->frames.push_back(sheet->frames[i]);
+        }
+        else if (isPlaceholder)
+        {
+            clip->frames.push_back(sheet->rect);
+        }
+        else
+        {
+            auto width = sheet->rect.width / frameCount;
+            clip->frames.push_back(sf::IntRect(sheet->rect.left + i * width, sheet->rect.top, width, sheet->rect.height));
+        }
+        clip->frameTimes.push_back(std::chrono::duration_cast<std::chrono::microseconds>(frameTimes[i]));
+    }
+    m_clips[key] = clip;
+
+    return clip;
+}
+
+// --------------------------------------------------------------
+//
+// Creates textures from the images the loader has decoded, until the
+// budget is used up; at least one each call, so loading always moves
+// along.  Returns the names of the images finished with, whether they
+// loaded or not.
+//
+// --------------------------------------------------------------
+std::vector<std::string> AssetCache::update(std::chrono::microseconds budget)
+{
+    PROFILE_SCOPE("AssetCache::update");
+
+    std::vector<std::string> finished;
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+        auto decoded = m_decoded.dequeue();
+        if (!decoded)
+        {
+            break;
+        }
+
+        auto& [name, image] = *decoded;
+        m_pending.erase(name);
+        if (image == nullptr)
+        {
+            std::cout << "Failed to load texture: " << name << std::endl;
+            m_failed.insert(name);
+        }
+        else
+        {
+            add(name, *image);
+        }
+        finished.push_back(name);
+    } while (std::chrono::steady_clock::now() - start < budget);
+
+    return finished;
+}
+
+// --------------------------------------------------------------
+//
+// Frees the clips nothing refers to any longer, then the images
+// nothing refers to any longer and that have a texture of their own.
+// Only the cache holds such a region, and only the region holds its
+// texture (an atlas texture is also held by the atlas, a pack page by
+// the pages).
+//
+// --------------------------------------------------------------
+void AssetCache::trim()
+{
+    for (auto i = m_clips.begin(); i != m_clips.end();)
+    {
+        if (i->second.use_count() == 1)
+        {
+            i = m_clips.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for (auto i = m_textures.begin(); i != m_textures.end();)
+    {
+        if (i->second.use_count() == 1 && i->second->texture.use_count() == 1)
+        {
+            i = m_textures.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Makes the image a texture region, found by its name from now on.
+//
+// --------------------------------------------------------------
+void AssetCache::add(const std::string& name, const sf::Image& image)
+{
+    auto region = pack(image);
+    if (region == nullptr)
+    {
+        std::cout << "Failed to create texture: " << name << std::endl;
+        m_failed.insert(name);
+        return;
+    }
+    m_textures[name] = region;
+}
+
+// --------------------------------------------------------------
+//
+// Copies the image into the first atlas with room for it, starting a
+// new atlas when none has room, or into a texture of its own if it is
+// too large to pack.
+//
+// --------------------------------------------------------------
+std::shared_ptr<const TextureRegion> AssetCache::pack(const sf::Image& image)
+{
+    if (m_atlasSize == 0)
+    {
+        m_atlasSize = std::min(ATLAS_SIZE, sf::Texture::getMaximumSize());
+    }
+
+    auto size = image.getSize();
+    if (size.x > std::min(MAX_PACKED_SIZE, m_atlasSize - PADDING) || size.y > std::min(MAX_PACKED_SIZE, m_atlasSize - PADDING))
+    {
+        auto texture = std::make_shared<sf::Texture>();
+        if (!texture->loadFromImage(image))
+        {
+            return nullptr;
+        }
+        return std::make_shared<TextureRegion>(TextureRegion{texture, sf::IntRect(0, 0, static_cast<int>(size.x), static_cast<int>(size.y)), {}});
+    }
+
+    std::uint32_t x{0};
+    std::uint32_t y{0};
+    auto atlas = std::find_if(m_atlases.begin(), m_atlases.end(), [&](auto& atlas) { return atlas.packer.place(size.x + PADDING, size.y + PADDING, x, y); });
+    if (atlas == m_atlases.end())
+    {
+        Atlas created{std::make_shared<sf::Texture>(), ShelfPacker(m_atlasSize)};
+        if (!created.texture->create(m_atlasSize, m_atlasSize))
+        {
+            return nullptr;
+        }
+        m_atlases.push_back(std::move(created));
+        atlas = m_atlases.end() - 1;
+        atlas->packer.place(size.x + PADDING, size.y + PADDING, x, y);
+    }
+
+    atlas->texture->update(image, x, y);
+
+    return std::make_shared<TextureRegion>(TextureRegion{atlas->texture, sf::IntRect(static_cast<int>(x), static_cast<int>(y), static_cast<int>(size.x), static_cast<int>(size.y)), {}});
+}
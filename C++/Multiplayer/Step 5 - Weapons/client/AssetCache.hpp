@@ -0,0 +1,148 @@
+#pragma once
+
+#include "ConcurrentQueue.hpp"
+#include "ShelfPacker.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Where an image ended up: the texture it was loaded into and the
+// rectangle it covers in that texture.  For a sprite sheet from the
+// asset pack, the rectangles of its animation frames too.
+//
+// --------------------------------------------------------------
+struct TextureRegion
+{
+    std::shared_ptr<const sf::Texture> texture;
+    sf::IntRect rect;
+    std::vector<sf::IntRect> frames; // empty when not known
+};
+
+// --------------------------------------------------------------
+//
+// An animation: the frames of a sprite sheet and how long each is
+// shown.  Clips are immutable and shared by every entity playing the
+// same animation, those only keep track of where they are in it.
+//
+// --------------------------------------------------------------
+struct AnimationClip
+{
+    std::shared_ptr<const TextureRegion> sheet;
+    std::vector<sf::IntRect> frames;
+    std::vector<std::chrono::microseconds> frameTimes;
+};
+
+// --------------------------------------------------------------
+//
+// The textures used by the client, each loaded from disk once and
+// then shared by every entity that shows it.
+//
+// At startup the images are loaded from the asset pack, if there is
+// one (see AssetPack.hpp), its pages becoming the textures with no
+// decoding.  Images not in the pack are loaded on first use.
+//
+// With the loader started, images are loaded in the background: a
+// request queues the image for the loader thread to read and decode,
+// and update, called each frame, turns the decoded images into
+// textures (which has to be done on the game thread) for as long as
+// the frame's budget allows.  Until then, getTexture returns nullptr
+// and the placeholder can be shown instead.  Without the loader an
+// image is loaded as soon as it is asked for.
+//
+// Small images are packed into large atlas textures (ShelfPacker), so
+// the sprites of many different entities are drawn from the same
+// texture.  Images too large for an atlas get a texture of their own.
+//
+// Animation clips are made once for each sheet and set of frame times,
+// and shared the same way.
+//
+// Regions are handed out as shared pointers, which is what counts the
+// references to an image.  An image nobody refers to stays loaded, so
+// another entity using it costs no disk access, until trim is called
+// (the game model does, every 30 seconds).  Trimming frees the
+// unreferenced images that have their own texture, the atlas space of
+// a packed image (or a page of the pack) isn't reclaimed, it is
+// bounded by the number of distinct images.
+//
+// Other than the loader thread, only used from the game thread.
+//
+// Note: This is a Singleton
+//
+// --------------------------------------------------------------
+class AssetCache
+{
+  public:
+    AssetCache(const AssetCache&) = delete;
+    AssetCache(AssetCache&&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+    AssetCache& operator=(AssetCache&&) = delete;
+    ~AssetCache() { shutdown(); } // exit() destroys the instance, the loader can't be left running
+
+    static auto& instance()
+    {
+        static AssetCache instance;
+        return instance;
+    }
+
+    static constexpr unsigned int ATLAS_SIZE = 2048;
+    static constexpr unsigned int MAX_PACKED_SIZE = 1024; // larger images get their own texture
+    static constexpr unsigned int PADDING = 1;            // between packed images, so filtering doesn't bleed
+    static constexpr unsigned int PLACEHOLDER_SIZE = 8;
+
+    bool loadPack(const std::string& path);
+    void startLoader();
+    void shutdown();
+
+    void request(const std::string& name);
+    std::shared_ptr<const TextureRegion> getTexture(const std::string& name);
+    bool isPending(const std::string& name) const { return m_pending.count(name) > 0; } // still loading, as opposed to failed
+    std::shared_ptr<const TextureRegion> getPlaceholder();
+    std::shared_ptr<const AnimationClip> getClip(std::shared_ptr<const TextureRegion> sheet, const std::vector<std::chrono::milliseconds>& frameTimes);
+    std::vector<std::string> update(std::chrono::microseconds budget);
+    void trim();
+
+    auto getTextureCount() const { return m_textures.size(); }
+    auto getAtlasCount() const { return m_atlases.size(); }
+
+  private:
+    AssetCache() {}
+
+    struct Atlas
+    {
+        std::shared_ptr<sf::Texture> texture;
+        ShelfPacker packer;
+    };
+
+    std::string m_directory{"assets/"};
+    std::unordered_map<std::string, std::shared_ptr<const TextureRegion>> m_textures;
+    std::vector<Atlas> m_atlases;
+    std::vector<std::shared_ptr<sf::Texture>> m_packPages;
+    unsigned int m_atlasSize{0};
+    std::shared_ptr<const TextureRegion> m_placeholder;
+    std::map<std::tuple<const TextureRegion*, std::vector<std::chrono::milliseconds>>, std::shared_ptr<const AnimationClip>> m_clips;
+
+    bool m_keepRunning{true};
+    std::thread m_threadLoader;
+    std::queue<std::string> m_requests;
+    std::condition_variable m_eventRequests;
+    std::mutex m_mutexRequests;
+    ConcurrentQueue<std::tuple<std::string, std::shared_ptr<sf::Image>>> m_decoded; // the image is nullptr if it failed to load
+    std::unordered_set<std::string> m_pending;
+    std::unordered_set<std::string> m_failed;
+
+    void add(const std::string& name, const sf::Image& image);
+    std::shared_ptr<const TextureRegion> pack(const sf::Image& image);
+};
@@ -0,0 +1,183 @@
+#include "AssetPack.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace assetpack
+{
+    // --------------------------------------------------------------
+    //
+    // Maps the pack and checks everything in its index lies within it,
+    // so nothing read through it afterwards can go out of bounds.
+    //
+    // --------------------------------------------------------------
+    bool Pack::open(const std::string& path)
+    {
+        close();
+        if (!map(path))
+        {
+            return false;
+        }
+        if (!validate())
+        {
+            std::cout << "Asset pack is invalid: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+#if defined(_WIN32)
+    bool Pack::map(const std::string& path)
+    {
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            m_file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<std::size_t>(size.QuadPart);
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping == nullptr)
+        {
+            close();
+            return false;
+        }
+        m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Pack::close()
+    {
+        if (m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != nullptr)
+        {
+            CloseHandle(m_file);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+        m_file = nullptr;
+    }
+#else
+    bool Pack::map(const std::string& path)
+    {
+        m_file = ::open(path.c_str(), O_RDONLY);
+        if (m_file < 0)
+        {
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(m_file, &status) != 0 || status.st_size == 0)
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<std::size_t>(status.st_size);
+
+        auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+        if (data == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+        m_data = static_cast<const std::uint8_t*>(data);
+
+        return true;
+    }
+
+    void Pack::close()
+    {
+        if (m_data != nullptr)
+        {
+            munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+        if (m_file >= 0)
+        {
+            ::close(m_file);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_file = -1;
+    }
+#endif
+
+    bool Pack::validate() const
+    {
+        if (m_size < sizeof(Header) || header().magic != MAGIC || header().version != VERSION)
+        {
+            return false;
+        }
+
+        auto indexSize = sizeof(Header) + sizeof(Page) * static_cast<std::uint64_t>(getPageCount()) + sizeof(Entry) * static_cast<std::uint64_t>(getEntryCount());
+        if (indexSize > m_size)
+        {
+            return false;
+        }
+
+        for (std::uint32_t i = 0; i < getPageCount(); i++)
+        {
+            auto& page = getPage(i);
+            auto pixelsSize = static_cast<std::uint64_t>(page.width) * page.height * 4;
+            if (page.offset < indexSize || page.offset > m_size || pixelsSize > m_size - page.offset)
+            {
+                return false;
+            }
+        }
+
+        for (std::uint32_t i = 0; i < getEntryCount(); i++)
+        {
+            auto& entry = getEntry(i);
+            if (entry.page >= getPageCount() || entry.frameCount == 0)
+            {
+                return false;
+            }
+            auto& page = getPage(entry.page);
+            if (static_cast<std::uint64_t>(entry.left) + entry.width > page.width || static_cast<std::uint64_t>(entry.top) + entry.height > page.height)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string getName(const Entry& entry)
+    {
+        return std::string(entry.name, std::find(entry.name, entry.name + NAME_SIZE, '\0'));
+    }
+} // namespace assetpack
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --------------------------------------------------------------
+//
+// The client's images, packed offline by the AssetPack tool into a
+// single file of already decoded pixels.  The client maps the file
+// into memory and creates its textures straight from the mapped
+// bytes, no image decoding at runtime.
+//
+// The layout, in the machine's byte order:
+//
+//      Header
+//      Page[pageCount]     atlas pages: size and where their pixels are
+//      Entry[entryCount]   images: name, page, rectangle, frame count
+//      pixels              each page's RGBA pixels, row by row
+//
+// A sprite sheet's frames are equal slices across its width.
+//
+// --------------------------------------------------------------
+namespace assetpack
+{
+    constexpr std::uint32_t MAGIC = 0x4B415041; // "APAK"
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::size_t NAME_SIZE = 64;
+    constexpr std::uint32_t PAGE_SIZE = 2048;
+    constexpr std::uint32_t PADDING = 1;       // between packed images, so filtering doesn't bleed
+    constexpr std::uint32_t PIXELS_ALIGNMENT = 16;
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t pageCount;
+        std::uint32_t entryCount;
+    };
+
+    struct Page
+    {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint64_t offset; // from the start of the file
+    };
+
+    struct Entry
+    {
+        char name[NAME_SIZE]; // nul padded, not terminated if it fills the array
+        std::uint32_t page;
+        std::uint32_t left;
+        std::uint32_t top;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t frameCount;
+    };
+
+    static_assert(sizeof(Header) == 16 && sizeof(Page) == 16 && sizeof(Entry) == NAME_SIZE + 24, "the pack layout must not have padding");
+
+    // --------------------------------------------------------------
+    //
+    // A pack file mapped into memory, read only.  The pointers it hands
+    // out are good until it is closed.
+    //
+    // --------------------------------------------------------------
+    class Pack
+    {
+      public:
+        Pack() {}
+        Pack(const Pack&) = delete;
+        Pack& operator=(const Pack&) = delete;
+        ~Pack() { close(); }
+
+        bool open(const std::string& path);
+        void close();
+
+        std::uint32_t getPageCount() const { return header().pageCount; }
+        std::uint32_t getEntryCount() const { return header().entryCount; }
+        const Page& getPage(std::uint32_t index) const { return reinterpret_cast<const Page*>(m_data + sizeof(Header))[index]; }
+        const Entry& getEntry(std::uint32_t index) const { return reinterpret_cast<const Entry*>(m_data + sizeof(Header) + sizeof(Page) * getPageCount())[index]; }
+        const std::uint8_t* getPixels(const Page& page) const { return m_data + page.offset; }
+
+      private:
+        const std::uint8_t* m_data{nullptr};
+        std::size_t m_size{0};
+#if defined(_WIN32)
+        void* m_file{nullptr};
+        void* m_mapping{nullptr};
+#else
+        int m_file{-1};
+#endif
+
+        const Header& header() const { return *reinterpret_cast<const Header*>(m_data); }
+        bool map(const std::string& path);
+        bool validate() const;
+    };
+
+    std::string getName(const Entry& entry);
+} // namespace assetpack
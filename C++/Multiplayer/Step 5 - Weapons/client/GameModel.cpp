@@ -1,5 +1,6 @@
 #include "GameModel.hpp"
 
+#include "AssetCache.hpp"
 #include "MessageQueueClient.hpp"
 #include "components/AnimatedSprite.hpp"
 #include "components/Input.hpp"
@@ -9,13 +10,27 @@
 #include "components/Position.hpp"
 #include "components/Size.hpp"
 #include "components/Sprite.hpp"
+#include "misc/GameClock.hpp"
+#include "misc/Profiler.hpp"
 
-#include <SFML/Graphics/Texture.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Keyboard.hpp>
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <tuple>
 
+//
+// How long each update may spend turning loaded images into textures
+const auto ASSET_UPLOAD_BUDGET = std::chrono::microseconds(2000);
+//
+// How often the textures and animation clips no entity uses any longer are freed
+const auto ASSET_TRIM_INTERVAL = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(30));
+//
+// Side of the square around the origin that is divided up for finding the entities in
+// view, in views; entities outside of it are still found, just not as quickly
+const float VISIBILITY_AREA = 16.0f;
+
 // --------------------------------------------------------------
 //
 // This is where all game model initialization occurs.  In the case
@@ -32,7 +47,7 @@ bool GameModel::initialize(math::Vector2f viewSize)
     m_systemNetwork = std::make_unique<systems::Network>();
 
     m_systemNetwork->registerNewEntityHandler(std::bind(&GameModel::handleNewEntity, this, std::placeholders::_1));
-    m_systemNetwork->registerRemoveEntityHandler(std::bind(&GameModel::handleRemoveEntity, this, std::placeholders::_1));
+    m_systemNetwork->registerReconnectHandler(std::bind(&GameModel::handleReconnect, this));
 
     //
     // Initialize the keyboard input system.
@@ -42,6 +57,7 @@ bool GameModel::initialize(math::Vector2f viewSize)
         std::make_tuple(components::Input::Type::Thrust, sf::Keyboard::W),
         std::make_tuple(components::Input::Type::FireWeapon, sf::Keyboard::Space)};
     m_systemKeyboardInput = std::make_unique<systems::KeyboardInput>(inputMapping);
+    m_systemKeyboardInput->registerViewTimeHandler([this]() { return m_systemNetwork->getViewTime(); });
 
     //
     // Initialize the client interpolation system.
@@ -49,7 +65,12 @@ bool GameModel::initialize(math::Vector2f viewSize)
 
     //
     // Initialize the lifeftime system.
-    m_systemLifetime = std::make_unique<systems::Lifetime>(std::bind(&GameModel::handleRemoveEntity, this, std::placeholders::_1));
+    m_systemLifetime = std::make_unique<systems::Lifetime>();
+
+    //
+    // Initialize the visibility system, which finds the entities in view for the
+    // animation and renderer systems.
+    m_systemVisibility = std::make_unique<systems::Visibility>(math::Vector2f(0.0f, 0.0f), std::max(viewSize.x, viewSize.y) * VISIBILITY_AREA);
 
     //
     // Initialize the animation system.
@@ -79,23 +100,28 @@ void GameModel::signalKeyReleased(sf::Event::KeyEvent event, std::chrono::micros
 // must complete before rendering can start.
 //
 // --------------------------------------------------------------
-void GameModel::update(const std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget)
+void GameModel::update(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget)
 {
+    PROFILE_SCOPE("GameModel::update");
+
     //
-    // Add any new entities we've been notified about
-    for (auto&& entity : m_newEntities)
-    {
-        addEntity(entity);
-    }
-    m_newEntities.clear();
+    // Make the structural changes recorded since the last update, by the
+    // game model and by the systems, before any system runs
+    playbackCommands();
+    GameClock::instance().advance(elapsedTime);
 
     //
-    // Remove any entites we've been notified to get rid of first
-    for (auto&& id : m_removeEntities)
+    // Textures finished loading in the background are made ready, their entities get
+    // them with the next update
+    replacePlaceholders(AssetCache::instance().update(ASSET_UPLOAD_BUDGET));
+    //
+    // Now and then, free what the entities that are gone were the last to use
+    m_sinceAssetTrim += elapsedTime;
+    if (m_sinceAssetTrim >= ASSET_TRIM_INTERVAL)
     {
-        removeEntity(id);
+        AssetCache::instance().trim();
+        m_sinceAssetTrim = std::chrono::microseconds::zero();
     }
-    m_removeEntities.clear();
 
     //
     // Then, process the network system before anything else, it is like local input, so should
@@ -105,11 +131,14 @@ void GameModel::update(const std::chrono::microseconds elapsedTime, const std::c
     m_systemKeyboardInput->update(elapsedTime, now);
     m_systemMomentum->update(elapsedTime, now);
     m_systemLifetime->update(elapsedTime, now);
-    m_systemAnimation->update(elapsedTime, now);
+    //
+    // Once everything has moved, find what is in view, only that is animated and rendered
+    m_systemVisibility->update(elapsedTime, now, renderTarget->getView());
+    m_systemAnimation->update(elapsedTime, now, m_systemVisibility->getVisible());
 
     //
     // Rendering must always be done last
-    m_systemRender->update(elapsedTime, now, renderTarget);
+    m_systemRender->update(elapsedTime, now, renderTarget, m_systemVisibility->getVisible());
 }
 
 // --------------------------------------------------------------
@@ -125,70 +154,54 @@ std::shared_ptr<entities::Entity> GameModel::createEntity(const shared::Entity&
 
     if (pbEntity.has_animatedappearance())
     {
-        //
-        // Get the associated texture (sprite sheet) loaded first
-        auto textureSheet = std::make_shared<sf::Texture>();
-        m_textures.insert(textureSheet);
-        if (!textureSheet->loadFromFile("assets/" + pbEntity.animatedappearance().texture()))
-        {
-            return nullptr;
-        }
-
-        //
-        // Extract the frame times and create SFML sprites at the same timeyy
         std::vector<std::chrono::milliseconds> spriteTime;
-        std::vector<std::shared_ptr<sf::Sprite>> sprites;
-        auto spriteSizeX = textureSheet->getSize().x / pbEntity.animatedappearance().spritetime().size();
         for (auto time : pbEntity.animatedappearance().spritetime())
         {
             spriteTime.push_back(std::chrono::milliseconds(time));
+        }
 
-            auto spriteX = sprites.size() * spriteSizeX;
-            auto spriteAnim = std::make_shared<sf::Sprite>(*textureSheet, sf::IntRect(static_cast<int>(spriteX), 0, spriteSizeX, textureSheet->getSize().y));
-            // This sets the point about which rotation takes place - center of the sprite/texture
-            spriteAnim->setOrigin({spriteSizeX / 2.0f, spriteAnim->getTexture()->getSize().y / 2.0f});
-
-            //
-            // Original inspiration: https://en.sfml-dev.org/forums/index.php?topic=15755.0
-            // Define a scaling that converts from the texture size in pixels to unit coordinates
-            // that match the view.  This makes the texture have the same size/shape as the view.
-            sf::Vector2f scaleToUnitSize(m_viewSize.x / spriteSizeX, m_viewSize.y / spriteAnim->getTexture()->getSize().y);
-
-            // Now, set the actual render size based on the size provided in the entity description
-            spriteAnim->setScale(pbEntity.size().size().x() * scaleToUnitSize.x, pbEntity.size().size().x() * scaleToUnitSize.y);
-
-            sprites.push_back(spriteAnim);
+        //
+        // Get the associated texture (sprite sheet) from the cache, if it is still loading
+        // show the placeholder until it is ready.  One that failed to load keeps the
+        // placeholder for good.
+        auto sheet = AssetCache::instance().getTexture(pbEntity.animatedappearance().texture());
+        if (sheet == nullptr)
+        {
+            sheet = AssetCache::instance().getPlaceholder();
+            if (sheet == nullptr)
+            {
+                return nullptr;
+            }
+            if (AssetCache::instance().isPending(pbEntity.animatedappearance().texture()))
+            {
+                m_awaitingAssets[pbEntity.animatedappearance().texture()].push_back({entity->getId(), pbEntity.size().size().x(), spriteTime});
+            }
         }
 
-        entity->addComponent(std::make_unique<components::AnimatedSprite>(sprites, spriteTime));
+        entity->addComponent(createAnimatedSprite(sheet, spriteTime, pbEntity.size().size().x()));
     }
 
     if (pbEntity.has_appearance())
     {
         //
-        // Get the associated texture loaded first
-        auto texture = std::make_shared<sf::Texture>();
-        m_textures.insert(texture);
-        if (!texture->loadFromFile("assets/" + pbEntity.appearance().texture()))
+        // Get the associated texture from the cache, if it is still loading show the
+        // placeholder until it is ready.  One that failed to load keeps the placeholder
+        // for good.
+        auto region = AssetCache::instance().getTexture(pbEntity.appearance().texture());
+        if (region == nullptr)
         {
-            return nullptr;
+            region = AssetCache::instance().getPlaceholder();
+            if (region == nullptr)
+            {
+                return nullptr;
+            }
+            if (AssetCache::instance().isPending(pbEntity.appearance().texture()))
+            {
+                m_awaitingAssets[pbEntity.appearance().texture()].push_back({entity->getId(), pbEntity.size().size().x(), {}});
+            }
         }
 
-        auto sprite = std::make_shared<sf::Sprite>();
-        sprite->setTexture(*texture);
-        // This sets the point about which rotation takes place - center of the sprite/texture
-        sprite->setOrigin({texture->getSize().x / 2.0f, texture->getSize().y / 2.0f});
-
-        //
-        // Original inspiration: https://en.sfml-dev.org/forums/index.php?topic=15755.0
-        // Define a scaling that converts from the texture size in pixels to unit coordinates
-        // that match the view.  This makes the texture have the same size/shape as the view.
-        sf::Vector2f scaleToUnitSize(m_viewSize.x / texture->getSize().x, m_viewSize.y / texture->getSize().y);
-
-        // Now, set the actual render size based on the size provided in the entity description
-        sprite->setScale(pbEntity.size().size().x() * scaleToUnitSize.x, pbEntity.size().size().x() * scaleToUnitSize.y);
-
-        entity->addComponent(std::make_unique<components::Sprite>(sprite));
+        entity->addComponent(createSprite(region, pbEntity.size().size().x()));
     }
 
     if (pbEntity.has_position())
@@ -200,7 +213,7 @@ std::shared_ptr<entities::Entity> GameModel::createEntity(const shared::Entity&
 
     if (pbEntity.has_size())
     {
-        entity->addComponent(std::make_unique<components::Size>(m_viewSize));
+        entity->addComponent(std::make_unique<components::Size>(math::Vector2f(pbEntity.size().size().x(), pbEntity.size().size().y())));
     }
 
     if (pbEntity.has_movement())
@@ -258,42 +271,96 @@ std::shared_ptr<entities::Entity> GameModel::createEntity(const shared::Entity&
 
 // --------------------------------------------------------------
 //
-// As entities are added to the game model, they are run by the systems
-// to see if they are interested in knowing about them during their
-// updates.
+// A sprite showing the texture region at the given size.
 //
 // --------------------------------------------------------------
-void GameModel::addEntity(std::shared_ptr<entities::Entity> entity)
+std::unique_ptr<components::Sprite> GameModel::createSprite(std::shared_ptr<const TextureRegion> region, float size)
 {
-    if (entity == nullptr)
-        return;
-
-    m_entities[entity->getId()] = entity;
-    m_systemKeyboardInput->addEntity(entity);
-    m_systemRender->addEntity(entity);
-    m_systemAnimation->addEntity(entity);
-    m_systemNetwork->addEntity(entity);
-    m_systemMomentum->addEntity(entity);
-    m_systemLifetime->addEntity(entity);
+    auto sprite = std::make_shared<sf::Sprite>(*region->texture, region->rect);
+    // This sets the point about which rotation takes place - center of the sprite/texture
+    sprite->setOrigin({region->rect.width / 2.0f, region->rect.height / 2.0f});
+
+    //
+    // Original inspiration: https://en.sfml-dev.org/forums/index.php?topic=15755.0
+    // Define a scaling that converts from the texture size in pixels to unit coordinates
+    // that match the view.  This makes the texture have the same size/shape as the view.
+    sf::Vector2f scaleToUnitSize(m_viewSize.x / region->rect.width, m_viewSize.y / region->rect.height);
+
+    // Now, set the actual render size based on the size provided in the entity description
+    sprite->setScale(size * scaleToUnitSize.x, size * scaleToUnitSize.y);
+
+    return std::make_unique<components::Sprite>(region, sprite);
 }
 
 // --------------------------------------------------------------
 //
-// All entity lists for the systems must be given a chance to remove
-// the entity.
+// An animated sprite playing the sheet's clip (made once for each
+// sheet and set of frame times, then shared) at the given size.
 //
 // --------------------------------------------------------------
-void GameModel::removeEntity(entities::Entity::IdType entityId)
+std::unique_ptr<components::AnimatedSprite> GameModel::createAnimatedSprite(std::shared_ptr<const TextureRegion> sheet, const std::vector<std::chrono::milliseconds>& spriteTime, float size)
 {
-    m_entities.erase(entityId);
+    auto clip = AssetCache::instance().getClip(sheet, spriteTime);
+    auto& frame = clip->frames.front();
+
     //
-    // Let each of the systems know to remove the entity
-    m_systemKeyboardInput->removeEntity(entityId);
-    m_systemRender->removeEntity(entityId);
-    m_systemAnimation->removeEntity(entityId);
-    m_systemNetwork->removeEntity(entityId);
-    m_systemMomentum->removeEntity(entityId);
-    m_systemLifetime->removeEntity(entityId);
+    // Original inspiration: https://en.sfml-dev.org/forums/index.php?topic=15755.0
+    // Define a scaling that converts from the texture size in pixels to unit coordinates
+    // that match the view.  This makes the texture have the same size/shape as the view.
+    sf::Vector2f scaleToUnitSize(m_viewSize.x / frame.width, m_viewSize.y / frame.height);
+
+    // Now, set the actual render size based on the size provided in the entity description
+    return std::make_unique<components::AnimatedSprite>(clip, sf::Vector2f(size * scaleToUnitSize.x, size * scaleToUnitSize.y));
+}
+
+// --------------------------------------------------------------
+//
+// Gives the entities that were waiting on the just loaded textures
+// their real sprites, in place of the placeholder.
+//
+// --------------------------------------------------------------
+void GameModel::replacePlaceholders(const std::vector<std::string>& loaded)
+{
+    for (auto&& name : loaded)
+    {
+        auto awaiting = m_awaitingAssets.find(name);
+        if (awaiting == m_awaitingAssets.end())
+        {
+            continue;
+        }
+
+        auto region = AssetCache::instance().getTexture(name);
+        if (region != nullptr)
+        {
+            for (auto&& waiting : awaiting->second)
+            {
+                if (m_entities.find(waiting.entityId) == m_entities.end())
+                {
+                    continue; // already gone
+                }
+                if (waiting.spriteTime.empty())
+                {
+                    m_commands.addComponent(waiting.entityId, createSprite(region, waiting.size));
+                }
+                else
+                {
+                    m_commands.addComponent(waiting.entityId, createAnimatedSprite(region, waiting.spriteTime, waiting.size));
+                }
+            }
+        }
+        m_awaitingAssets.erase(awaiting);
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Makes the structural changes recorded by the game model and the
+// systems.
+//
+// --------------------------------------------------------------
+void GameModel::playbackCommands()
+{
+    m_commands.playback(m_entities, {m_systemNetwork.get(), m_systemKeyboardInput.get(), m_systemMomentum.get(), m_systemLifetime.get(), m_systemVisibility.get(), m_systemAnimation.get(), m_systemRender.get()});
 }
 
 // --------------------------------------------------------------
@@ -303,16 +370,25 @@ void GameModel::removeEntity(entities::Entity::IdType entityId)
 // --------------------------------------------------------------
 void GameModel::handleNewEntity(const shared::Entity& pbEntity)
 {
-    m_newEntities.push_back(createEntity(pbEntity));
+    m_commands.spawn(createEntity(pbEntity));
 }
 
 // --------------------------------------------------------------
 //
-// Handler for the RemoveEntity message.  It removes the entity from
-// the client game model (that's us!).
+// The connection to the server was made again, the server is about to
+// send the whole world.  Everything from the old connection goes now,
+// not with the next update, because in a playback destroys win over
+// spawns and the server may send entities with the same ids again.
 //
 // --------------------------------------------------------------
-void GameModel::handleRemoveEntity(entities::Entity::IdType entityId)
+void GameModel::handleReconnect()
 {
-    m_removeEntities.insert(entityId);
+    playbackCommands();
+    for (auto&& [id, entity] : m_entities)
+    {
+        (void)entity; // unused
+        m_commands.destroy(id);
+    }
+    playbackCommands();
+    m_awaitingAssets.clear();
 }
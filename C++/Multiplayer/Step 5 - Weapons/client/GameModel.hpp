@@ -11,8 +11,12 @@
     #pragma warning(pop)
 #endif
 
+#include "AssetCache.hpp"
+#include "components/AnimatedSprite.hpp"
 #include "components/Movement.hpp"
 #include "components/Position.hpp"
+#include "components/Sprite.hpp"
+#include "entities/CommandBuffer.hpp"
 #include "entities/Entity.hpp"
 #include "misc/math.hpp"
 #include "systems/Animation.hpp"
@@ -21,12 +25,14 @@
 #include "systems/Momentum.hpp"
 #include "systems/Network.hpp"
 #include "systems/Renderer.hpp"
+#include "systems/Visibility.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window/Event.hpp>
 #include <chrono>
 #include <memory>
-#include <unordered_set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class GameModel
@@ -36,28 +42,40 @@ class GameModel
 
     void signalKeyPressed(sf::Event::KeyEvent event, std::chrono::microseconds elapsedTime);
     void signalKeyReleased(sf::Event::KeyEvent event, std::chrono::microseconds elapsedTime);
-    void update(const std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget);
+    void update(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget);
 
   private:
-    // The purpose of this is to have a container that keeps the textures alive throughout the program
-    std::unordered_set<std::shared_ptr<sf::Texture>> m_textures;
+    //
+    // An entity shown with the placeholder until its texture is loaded, with what
+    // is needed to create its sprite then
+    struct AwaitingAsset
+    {
+        entities::Entity::IdType entityId;
+        float size;
+        std::vector<std::chrono::milliseconds> spriteTime; // empty for a sprite that isn't animated
+    };
+
     math::Vector2f m_viewSize;
+    std::unordered_map<std::string, std::vector<AwaitingAsset>> m_awaitingAssets;
+    std::chrono::microseconds m_sinceAssetTrim{0};
 
     entities::EntityMap m_entities;
-    entities::EntityVector m_newEntities;
-    entities::EntitySet m_removeEntities;
+    entities::CommandBuffer m_commands;
 
     std::unique_ptr<systems::KeyboardInput> m_systemKeyboardInput;
     std::unique_ptr<systems::Lifetime> m_systemLifetime;
     std::unique_ptr<systems::Momentum> m_systemMomentum;
     std::unique_ptr<systems::Network> m_systemNetwork;
+    std::unique_ptr<systems::Visibility> m_systemVisibility;
     std::unique_ptr<systems::Animation> m_systemAnimation;
     std::unique_ptr<systems::Renderer> m_systemRender;
 
     std::shared_ptr<entities::Entity> createEntity(const shared::Entity& pbEntity);
-    void addEntity(std::shared_ptr<entities::Entity> entity);
-    void removeEntity(entities::Entity::IdType entityId);
+    std::unique_ptr<components::Sprite> createSprite(std::shared_ptr<const TextureRegion> region, float size);
+    std::unique_ptr<components::AnimatedSprite> createAnimatedSprite(std::shared_ptr<const TextureRegion> sheet, const std::vector<std::chrono::milliseconds>& spriteTime, float size);
+    void replacePlaceholders(const std::vector<std::string>& loaded);
+    void playbackCommands();
 
     void handleNewEntity(const shared::Entity& pbEntity);
-    void handleRemoveEntity(entities::Entity::IdType entityId);
+    void handleReconnect();
 };
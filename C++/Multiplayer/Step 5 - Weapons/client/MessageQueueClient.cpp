@@ -1,12 +1,19 @@
 #include "MessageQueueClient.hpp"
 
 #include "messages/ConnectAck.hpp"
+#include "messages/JoinAck.hpp"
 #include "messages/NewEntity.hpp"
+#include "messages/Pong.hpp"
 #include "messages/RemoveEntity.hpp"
 #include "messages/UpdateEntity.hpp"
+#include "messages/WorldState.hpp"
+#include "misc/Profiler.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <iostream>
 
 // For htonl and ntohl
 #if defined(_MSC_VER)
@@ -24,6 +31,8 @@
 // -----------------------------------------------------------------
 bool MessageQueueClient::initialize(std::string serverIP, std::uint16_t serverPort)
 {
+    m_serverIP = serverIP;
+    m_serverPort = serverPort;
     m_socketServer = std::make_unique<sf::TcpSocket>();
     if (m_socketServer->connect(serverIP, serverPort) != sf::Socket::Done)
     {
@@ -46,6 +55,15 @@ bool MessageQueueClient::initialize(std::string serverIP, std::uint16_t serverPo
     m_messageCommand[messages::Type::RemoveEntity] = []() {
         return std::make_shared<messages::RemoveEntity>();
     };
+    m_messageCommand[messages::Type::WorldState] = []() {
+        return std::make_shared<messages::WorldState>();
+    };
+    m_messageCommand[messages::Type::Pong] = []() {
+        return std::make_shared<messages::Pong>();
+    };
+    m_messageCommand[messages::Type::JoinAck] = []() {
+        return std::make_shared<messages::JoinAck>();
+    };
 
     initializeSender();
     initializeReceiver();
@@ -60,6 +78,8 @@ bool MessageQueueClient::initialize(std::string serverIP, std::uint16_t serverPo
 // -----------------------------------------------------------------
 void MessageQueueClient::shutdown()
 {
+    m_keepRunning = false;
+    std::lock_guard<std::mutex> lock(m_mutexSocket);
     m_socketServer->disconnect();
 }
 
@@ -125,6 +145,17 @@ std::queue<std::shared_ptr<messages::Message>> MessageQueueClient::getSendMessag
     return std::queue<std::shared_ptr<messages::Message>>(m_sendHistory);
 }
 
+// --------------------------------------------------------------
+//
+// The messages sent over a lost connection are never going to be
+// acknowledged, after reconnecting they are forgotten.
+//
+// --------------------------------------------------------------
+void MessageQueueClient::clearSendMessageHistory()
+{
+    m_sendHistory = {};
+}
+
 // --------------------------------------------------------------
 //
 // Prepares the message queue for sending of messages.  As messages
@@ -135,11 +166,13 @@ std::queue<std::shared_ptr<messages::Message>> MessageQueueClient::getSendMessag
 void MessageQueueClient::initializeSender()
 {
     m_threadSender = std::thread([this]() {
+        PROFILE_THREAD("Sender");
         while (m_keepRunning)
         {
             auto item = m_sendMessages.dequeue();
             if (item)
             {
+                PROFILE_SCOPE("MessageQueueClient::send");
                 // Need to track messages with a sequence number for server reconciliation
                 if (item.value()->getMessageId())
                 {
@@ -160,6 +193,7 @@ void MessageQueueClient::initializeSender()
                 header[3] = ptrSize[2];
                 header[4] = ptrSize[3];
 
+                std::lock_guard<std::mutex> lock(m_mutexSocket);
                 // Send the header
                 m_socketServer->send(header.data(), header.size());
                 // Send the message body
@@ -190,16 +224,23 @@ void MessageQueueClient::initializeSender()
 void MessageQueueClient::initializeReceiver()
 {
     m_threadReceiver = std::thread([this]() {
+        PROFILE_THREAD("Receiver");
         while (m_keepRunning)
         {
             if (m_selector.wait(sf::seconds(1.0f)))
             {
                 if (m_selector.isReady(*m_socketServer))
                 {
+                    PROFILE_SCOPE("MessageQueueClient::receive");
                     std::array<messages::Type, 1> type;
                     std::array<uint32_t, 1> size;
                     std::size_t received;
-                    if (m_socketServer->receive(type.data(), 1, received) == sf::Socket::Done)
+                    auto status = m_socketServer->receive(type.data(), 1, received);
+                    if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+                    {
+                        reconnect();
+                    }
+                    else if (status == sf::Socket::Done)
                     {
                         if (m_socketServer->receive(size.data(), sizeof(std::uint32_t), received) == sf::Socket::Done)
                         {
@@ -212,6 +253,7 @@ void MessageQueueClient::initializeReceiver()
                                 if (m_socketServer->receive(data.data(), size[0], received) == sf::Socket::Done)
                                 {
                                     auto message = m_messageCommand[type[0]]();
+                                    message->setReceivedTime(std::chrono::steady_clock::now());
                                     message->parseFromString(data);
                                     std::lock_guard<std::mutex> lock(m_mutexReceivedMessages);
                                     m_receivedMessages.push(message);
@@ -220,6 +262,7 @@ void MessageQueueClient::initializeReceiver()
                             else
                             {
                                 auto message = m_messageCommand[type[0]]();
+                                message->setReceivedTime(std::chrono::steady_clock::now());
                                 std::lock_guard<std::mutex> lock(m_mutexReceivedMessages);
                                 m_receivedMessages.push(message);
                             }
@@ -230,3 +273,33 @@ void MessageQueueClient::initializeReceiver()
         }
     });
 }
+
+// --------------------------------------------------------------
+//
+// Called on the receiver thread when the server closes the connection.
+// Tries to connect again until it works (or the client is shutting
+// down), doubling the wait after each failed attempt.
+//
+// --------------------------------------------------------------
+void MessageQueueClient::reconnect()
+{
+    std::cout << "Lost the connection to the server, reconnecting..." << std::endl;
+    m_selector.clear();
+
+    auto backoff = std::chrono::duration_cast<std::chrono::milliseconds>(RECONNECT_BACKOFF_MIN);
+    while (m_keepRunning)
+    {
+        auto socket = std::make_unique<sf::TcpSocket>();
+        if (socket->connect(m_serverIP, m_serverPort) == sf::Socket::Done)
+        {
+            std::lock_guard<std::mutex> lock(m_mutexSocket);
+            m_socketServer = std::move(socket);
+            m_selector.add(*m_socketServer);
+            std::cout << "Reconnected to the server" << std::endl;
+            return;
+        }
+
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, std::chrono::duration_cast<std::chrono::milliseconds>(RECONNECT_BACKOFF_MAX));
+    }
+}
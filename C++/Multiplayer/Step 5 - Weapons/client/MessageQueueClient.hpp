@@ -4,11 +4,14 @@
 #include "messages/Message.hpp"
 
 #include <SFML/Network.hpp>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 #include <unordered_map>
 
@@ -17,6 +20,12 @@
 // This provides the network message communication for the client.
 // All connections and messages to and from the server are servied here.
 //
+// When the connection to the server is lost (e.g. the server was
+// restarted), the receiver thread keeps trying to connect again,
+// waiting longer after each failed attempt.  The server acknowledges
+// the new connection like any other, that is how the game model finds
+// out it was reconnected.
+//
 // Note: This is a Singleton
 //
 // --------------------------------------------------------------
@@ -41,13 +50,20 @@ class MessageQueueClient
     void sendMessageWithId(std::shared_ptr<messages::Message> message);
     std::queue<std::shared_ptr<messages::Message>> getMessages();
     std::queue<std::shared_ptr<messages::Message>> getSendMessageHistory(std::uint32_t lastMessageId);
+    void clearSendMessageHistory();
 
   private:
     MessageQueueClient() {}
 
-    bool m_keepRunning{true};
+    static constexpr auto RECONNECT_BACKOFF_MIN = std::chrono::milliseconds(250);
+    static constexpr auto RECONNECT_BACKOFF_MAX = std::chrono::milliseconds(8000);
+
+    std::atomic<bool> m_keepRunning{true};
+    std::string m_serverIP;
+    std::uint16_t m_serverPort{0};
     sf::SocketSelector m_selector;
     std::unique_ptr<sf::TcpSocket> m_socketServer;
+    std::mutex m_mutexSocket; // the sender uses the socket while the receiver may replace it
 
     std::uint32_t m_nextMessageId{0};
     std::thread m_threadSender;
@@ -63,4 +79,5 @@ class MessageQueueClient
 
     void initializeSender();
     void initializeReceiver();
+    void reconnect();
 };
@@ -0,0 +1,200 @@
+#include "QuadTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    math::Vector2f centerOf(const QuadTree::Bounds& bounds) { return (bounds.min + bounds.max) * 0.5f; }
+    float extentOf(const QuadTree::Bounds& bounds) { return std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y); }
+
+    bool intersects(const QuadTree::Bounds& a, const QuadTree::Bounds& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y;
+    }
+} // namespace
+
+QuadTree::QuadTree(math::Vector2f center, float size) :
+    m_root(nullptr, center, size, 0)
+{
+}
+
+void QuadTree::insert(entities::Entity::IdType id, const Bounds& bounds)
+{
+    if (m_locations.find(id) != m_locations.end())
+    {
+        update(id, bounds);
+        return;
+    }
+
+    add(findNode(bounds), id, bounds);
+}
+
+// --------------------------------------------------------------
+//
+// Records the entity's new bounds, moving it to another node only if
+// it no longer belongs in the one it is in.
+//
+// --------------------------------------------------------------
+void QuadTree::update(entities::Entity::IdType id, const Bounds& bounds)
+{
+    auto location = m_locations.find(id);
+    if (location == m_locations.end())
+    {
+        insert(id, bounds);
+        return;
+    }
+
+    if (belongsIn(*location->second.node, bounds))
+    {
+        location->second.node->items[location->second.slot].bounds = bounds;
+        return;
+    }
+
+    take(location->second);
+    add(findNode(bounds), id, bounds);
+}
+
+void QuadTree::remove(entities::Entity::IdType id)
+{
+    auto location = m_locations.find(id);
+    if (location != m_locations.end())
+    {
+        take(location->second);
+        m_locations.erase(location);
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Adds the entities whose bounds overlap the area to those found.
+//
+// --------------------------------------------------------------
+void QuadTree::query(const Bounds& area, std::vector<entities::Entity::IdType>& found) const
+{
+    query(m_root, area, found);
+}
+
+// --------------------------------------------------------------
+//
+// The node the bounds belong in, created if it doesn't exist yet:
+// going down from the root toward the center of the bounds, for as
+// long as they fit in the next level's squares.
+//
+// --------------------------------------------------------------
+QuadTree::Node* QuadTree::findNode(const Bounds& bounds)
+{
+    auto center = centerOf(bounds);
+    auto extent = extentOf(bounds);
+    auto half = m_root.size / 2;
+    if (std::fabs(center.x - m_root.center.x) > half || std::fabs(center.y - m_root.center.y) > half)
+    {
+        return &m_root;
+    }
+
+    auto node = &m_root;
+    while (node->depth < MAX_DEPTH && extent <= node->size / 2)
+    {
+        auto quadrant = (center.x >= node->center.x ? 1 : 0) + (center.y >= node->center.y ? 2 : 0);
+        auto& child = node->children[quadrant];
+        if (child == nullptr)
+        {
+            auto quarter = node->size / 4;
+            math::Vector2f childCenter(node->center.x + ((quadrant & 1) ? quarter : -quarter), node->center.y + ((quadrant & 2) ? quarter : -quarter));
+            child = std::make_unique<Node>(node, childCenter, node->size / 2, node->depth + 1);
+        }
+        node = child.get();
+    }
+
+    return node;
+}
+
+// --------------------------------------------------------------
+//
+// Whether the node is where findNode would put the bounds, without
+// going down the tree: the center is in its square, and the bounds
+// fit in it but not in the next level's squares.  The root takes
+// the bounds with their center outside of it too.
+//
+// --------------------------------------------------------------
+bool QuadTree::belongsIn(const Node& node, const Bounds& bounds) const
+{
+    auto center = centerOf(bounds);
+    auto extent = extentOf(bounds);
+    auto half = node.size / 2;
+    auto inside = std::fabs(center.x - node.center.x) <= half && std::fabs(center.y - node.center.y) <= half;
+    auto deeper = node.depth < MAX_DEPTH && extent <= half;
+    if (node.parent == nullptr)
+    {
+        return !inside || !deeper;
+    }
+
+    return inside && extent <= node.size && !deeper;
+}
+
+void QuadTree::add(Node* node, entities::Entity::IdType id, const Bounds& bounds)
+{
+    m_locations[id] = {node, node->items.size()};
+    node->items.push_back({id, bounds});
+    for (; node != nullptr; node = node->parent)
+    {
+        node->count++;
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Takes the item out of its node, the node's last item taking its
+// place.  The location itself is left for the caller to replace or
+// erase.
+//
+// --------------------------------------------------------------
+void QuadTree::take(const Location& location)
+{
+    auto node = location.node;
+    if (location.slot + 1 < node->items.size())
+    {
+        node->items[location.slot] = node->items.back();
+        m_locations[node->items[location.slot].id].slot = location.slot;
+    }
+    node->items.pop_back();
+    for (; node != nullptr; node = node->parent)
+    {
+        node->count--;
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Skips the nodes with nothing in them, and those whose loose bounds
+// (twice the size of their square) are clear of the area; nothing in
+// them could overlap it.  The root is always searched, it holds the
+// entities outside of the tree's square.
+//
+// --------------------------------------------------------------
+void QuadTree::query(const Node& node, const Bounds& area, std::vector<entities::Entity::IdType>& found) const
+{
+    if (node.count == 0)
+    {
+        return;
+    }
+    if (node.parent != nullptr && !intersects({node.center - math::Vector2f(node.size, node.size), node.center + math::Vector2f(node.size, node.size)}, area))
+    {
+        return;
+    }
+
+    for (auto& item : node.items)
+    {
+        if (intersects(item.bounds, area))
+        {
+            found.push_back(item.id);
+        }
+    }
+    for (auto& child : node.children)
+    {
+        if (child != nullptr)
+        {
+            query(*child, area, found);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "entities/Entity.hpp"
+#include "misc/math.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// A loose quadtree of entity bounds, for finding the entities inside
+// an area (the view) without looking at all of them.
+//
+// The tree divides a square of the world into four, those into four,
+// and so on.  Each node's loose bounds are twice the size of its
+// square, so an entity is kept in the single node where its center
+// is, at the deepest level whose squares are at least as large as the
+// entity.  Finding that node takes no searching, and an entity only
+// moves to a different node when its center leaves the square; most
+// of the time an update just records the new bounds.
+//
+// An entity outside of the square is kept at the root, which is
+// always searched.  Nodes are created as entities are placed in them,
+// and remember how many entities they and their children hold, so a
+// search skips the empty parts of the world.
+//
+// This is the C++ version of the JavaScript QuadTree demo, loose and
+// updated in place rather than rebuilt every frame.
+//
+// --------------------------------------------------------------
+class QuadTree
+{
+  public:
+    static constexpr std::uint32_t MAX_DEPTH = 8;
+
+    struct Bounds
+    {
+        math::Vector2f min;
+        math::Vector2f max;
+    };
+
+    QuadTree(math::Vector2f center, float size);
+
+    void insert(entities::Entity::IdType id, const Bounds& bounds);
+    void update(entities::Entity::IdType id, const Bounds& bounds);
+    void remove(entities::Entity::IdType id);
+    void query(const Bounds& area, std::vector<entities::Entity::IdType>& found) const;
+
+    auto getCount() const { return m_locations.size(); }
+
+  private:
+    struct Item
+    {
+        entities::Entity::IdType id;
+        Bounds bounds;
+    };
+
+    struct Node
+    {
+        Node(Node* parent, math::Vector2f center, float size, std::uint32_t depth) :
+            parent(parent),
+            center(center),
+            size(size),
+            depth(depth)
+        {
+        }
+
+        Node* parent;
+        math::Vector2f center;
+        float size; // of the square, the loose bounds are twice this
+        std::uint32_t depth;
+        std::vector<Item> items;
+        std::size_t count{0}; // items in this node and its children
+        std::array<std::unique_ptr<Node>, 4> children;
+    };
+
+    struct Location
+    {
+        Node* node;
+        std::size_t slot;
+    };
+
+    Node m_root;
+    std::unordered_map<entities::Entity::IdType, Location> m_locations;
+
+    Node* findNode(const Bounds& bounds);
+    bool belongsIn(const Node& node, const Bounds& bounds) const;
+    void add(Node* node, entities::Entity::IdType id, const Bounds& bounds);
+    void take(const Location& location);
+    void query(const Node& node, const Bounds& area, std::vector<entities::Entity::IdType>& found) const;
+};
@@ -0,0 +1,44 @@
+#include "ServerClock.hpp"
+
+#include <algorithm>
+
+// --------------------------------------------------------------
+//
+// Adds the times from a Pong to the samples and updates the offset
+// and round trip estimates.
+//
+// --------------------------------------------------------------
+void ServerClock::addSample(const messages::Pong& pong)
+{
+    using namespace std::chrono;
+
+    auto t0 = pong.getClientTime();
+    auto t1 = pong.getServerReceiveTime();
+    auto t2 = pong.getServerTransmitTime();
+    auto t3 = pong.getReceivedTime();
+
+    Sample sample;
+    sample.roundTrip = std::max(microseconds(0), duration_cast<microseconds>((t3 - t0) - (t2 - t1)));
+    sample.offset = duration_cast<microseconds>(((t1 - t0) + (t2 - t3)) / 2);
+
+    //
+    // Exponentially weighted moving average (1/8 weight), same as TCP's SRTT
+    if (m_sampleCount == 0)
+    {
+        m_roundTripTime = sample.roundTrip;
+    }
+    else
+    {
+        m_roundTripTime += (sample.roundTrip - m_roundTripTime) / 8;
+    }
+
+    m_samples[m_nextSample] = sample;
+    m_nextSample = (m_nextSample + 1) % SAMPLE_COUNT;
+    m_sampleCount = std::min(m_sampleCount + 1, SAMPLE_COUNT);
+
+    auto best = std::min_element(m_samples.begin(), m_samples.begin() + m_sampleCount,
+                                 [](const Sample& a, const Sample& b) { return a.roundTrip < b.roundTrip; });
+    m_offset = best->offset;
+
+    m_lastTick = std::max(m_lastTick, pong.getTick());
+}
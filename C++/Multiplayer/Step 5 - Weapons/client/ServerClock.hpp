@@ -0,0 +1,57 @@
+#pragma once
+
+#include "messages/Pong.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------
+//
+// Estimates the offset between the server's clock and ours, along
+// with the round trip time, from Ping/Pong exchanges (the NTP
+// approach).  With the four times of an exchange:
+//
+//      t0: client sends Ping       t1: server receives it
+//      t2: server sends Pong       t3: client receives it
+//
+//      round trip = (t3 - t0) - (t2 - t1)
+//      offset     = ((t1 - t0) + (t2 - t3)) / 2
+//
+// The offset is only as good as the assumption the trip was the same
+// both ways, so it is taken from the sample with the smallest round
+// trip of the last few, the one least disturbed by queuing.  The
+// round trip time reported is smoothed over all samples.
+//
+// --------------------------------------------------------------
+class ServerClock
+{
+  public:
+    void addSample(const messages::Pong& pong);
+
+    bool isSynchronized() const { return m_sampleCount > 0; }
+    auto getSampleCount() const { return m_sampleCount; }
+    auto getRoundTripTime() const { return m_roundTripTime; }
+    auto getOffset() const { return m_offset; }
+    auto getLastTick() const { return m_lastTick; }
+
+    std::chrono::steady_clock::time_point toLocal(std::chrono::steady_clock::time_point serverTime) const { return serverTime - m_offset; }
+    std::chrono::steady_clock::time_point serverNow() const { return std::chrono::steady_clock::now() + m_offset; }
+
+  private:
+    static constexpr std::size_t SAMPLE_COUNT = 8;
+
+    struct Sample
+    {
+        std::chrono::microseconds roundTrip{0};
+        std::chrono::microseconds offset{0};
+    };
+
+    std::array<Sample, SAMPLE_COUNT> m_samples;
+    std::size_t m_sampleCount{0};
+    std::size_t m_nextSample{0};
+    std::chrono::microseconds m_roundTripTime{0};
+    std::chrono::microseconds m_offset{0};
+    std::uint64_t m_lastTick{0};
+};
@@ -0,0 +1,40 @@
+#include "ShelfPacker.hpp"
+
+// --------------------------------------------------------------
+//
+// Finds room for a rectangle, returning false if there is none.
+//
+// --------------------------------------------------------------
+bool ShelfPacker::place(std::uint32_t width, std::uint32_t height, std::uint32_t& x, std::uint32_t& y)
+{
+    if (width > m_size)
+    {
+        return false;
+    }
+
+    Shelf* best = nullptr;
+    for (auto&& shelf : m_shelves)
+    {
+        if (shelf.height >= height && m_size - shelf.used >= width && (best == nullptr || shelf.height < best->height))
+        {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr)
+    {
+        if (m_size - m_used < height)
+        {
+            return false;
+        }
+        m_shelves.push_back({m_used, height, 0});
+        m_used += height;
+        best = &m_shelves.back();
+    }
+
+    x = best->used;
+    y = best->top;
+    best->used += width;
+
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Packs rectangles into a square area, shelf by shelf: a rectangle
+// goes on the shelf that wastes the least height and still has room
+// for it, or on a new shelf under the others.
+//
+// Used for packing images into atlas textures, both by the asset
+// cache and by the offline asset pack tool.
+//
+// --------------------------------------------------------------
+class ShelfPacker
+{
+  public:
+    ShelfPacker(std::uint32_t size) :
+        m_size(size)
+    {
+    }
+
+    bool place(std::uint32_t width, std::uint32_t height, std::uint32_t& x, std::uint32_t& y);
+    auto getSize() const { return m_size; }
+    auto getUsedHeight() const { return m_used; }
+
+  private:
+    struct Shelf
+    {
+        std::uint32_t top;
+        std::uint32_t height;
+        std::uint32_t used; // width taken so far
+    };
+
+    std::uint32_t m_size;
+    std::vector<Shelf> m_shelves;
+    std::uint32_t m_used{0}; // height taken by the shelves so far
+};
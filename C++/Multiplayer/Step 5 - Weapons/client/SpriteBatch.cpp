@@ -0,0 +1,123 @@
+#include "SpriteBatch.hpp"
+
+#include "misc/math.hpp"
+
+void SpriteBatch::clear()
+{
+    for (std::size_t i = 0; i < m_used; i++)
+    {
+        m_batches[i].vertices.clear();
+    }
+    m_used = 0;
+    m_current = 0;
+}
+
+// --------------------------------------------------------------
+//
+// Adds the quad showing the texture's rectangle, with the transform
+// an sf::Sprite with the same origin, scale, position and rotation
+// (in degrees) would have.
+//
+// --------------------------------------------------------------
+void SpriteBatch::add(const sf::Texture& texture, const sf::IntRect& rect, sf::Vector2f origin, sf::Vector2f scale, sf::Vector2f position, float rotation)
+{
+    auto& vertices = findBatch(texture).vertices;
+    auto first = vertices.getVertexCount();
+    vertices.resize(first + VERTICES_PER_QUAD);
+    auto quad = &vertices[first];
+
+    float sine{0};
+    float cosine{0};
+    math::sincosDegrees(rotation, sine, cosine);
+
+    //
+    // The corners, relative to the origin and scaled, before rotating them
+    auto left = -origin.x * scale.x;
+    auto top = -origin.y * scale.y;
+    auto right = (static_cast<float>(rect.width) - origin.x) * scale.x;
+    auto bottom = (static_cast<float>(rect.height) - origin.y) * scale.y;
+    auto place = [&](float x, float y) { return sf::Vector2f(position.x + x * cosine - y * sine, position.y + x * sine + y * cosine); };
+    auto topLeft = place(left, top);
+    auto topRight = place(right, top);
+    auto bottomLeft = place(left, bottom);
+    auto bottomRight = place(right, bottom);
+
+    auto texLeft = static_cast<float>(rect.left);
+    auto texTop = static_cast<float>(rect.top);
+    auto texRight = static_cast<float>(rect.left + rect.width);
+    auto texBottom = static_cast<float>(rect.top + rect.height);
+
+    //
+    // The vertices are white, as resize made them, only their positions and
+    // texture coordinates are set
+    auto set = [](sf::Vertex& vertex, sf::Vector2f position, float u, float v) {
+        vertex.position = position;
+        vertex.texCoords.x = u;
+        vertex.texCoords.y = v;
+    };
+    set(quad[0], topLeft, texLeft, texTop);
+    set(quad[1], topRight, texRight, texTop);
+    set(quad[2], bottomLeft, texLeft, texBottom);
+    set(quad[3], bottomLeft, texLeft, texBottom);
+    set(quad[4], topRight, texRight, texTop);
+    set(quad[5], bottomRight, texRight, texBottom);
+}
+
+std::size_t SpriteBatch::getQuadCount() const
+{
+    std::size_t count{0};
+    for (std::size_t i = 0; i < m_used; i++)
+    {
+        count += m_batches[i].vertices.getVertexCount() / VERTICES_PER_QUAD;
+    }
+
+    return count;
+}
+
+// --------------------------------------------------------------
+//
+// One draw call for each texture, in the order the textures were first
+// used this frame.
+//
+// --------------------------------------------------------------
+void SpriteBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    for (std::size_t i = 0; i < m_used; i++)
+    {
+        states.texture = m_batches[i].texture;
+        target.draw(m_batches[i].vertices, states);
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Finds the batch for the texture, starting one (reusing the storage
+// of a batch from an earlier frame, if there is one) the first time
+// the texture is used this frame.  There are only ever a few textures,
+// a linear search is all it takes.
+//
+// --------------------------------------------------------------
+SpriteBatch::Batch& SpriteBatch::findBatch(const sf::Texture& texture)
+{
+    if (m_current < m_used && m_batches[m_current].texture == &texture)
+    {
+        return m_batches[m_current];
+    }
+
+    for (m_current = 0; m_current < m_used; m_current++)
+    {
+        if (m_batches[m_current].texture == &texture)
+        {
+            return m_batches[m_current];
+        }
+    }
+
+    if (m_used == m_batches.size())
+    {
+        m_batches.push_back({nullptr, sf::VertexArray(sf::Triangles)});
+    }
+    m_current = m_used++;
+    m_batches[m_current].texture = &texture;
+
+    return m_batches[m_current];
+}
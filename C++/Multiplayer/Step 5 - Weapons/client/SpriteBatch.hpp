@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Collects the sprites of a frame as textured quads, one vertex array
+// for each texture, so all of the sprites drawn from the same texture
+// (an atlas page holds many images) take a single draw call.
+//
+// Each quad is transformed on the CPU, the same way sf::Sprite does
+// it: about its origin, scaled, rotated, then moved to its position.
+// Building the batches needs no window or render target, only drawing
+// them does.
+//
+// The vertex arrays are kept from one frame to the next, clear only
+// empties them, so once they have grown to the size of a frame adding
+// sprites doesn't allocate.
+//
+// --------------------------------------------------------------
+class SpriteBatch : public sf::Drawable
+{
+  public:
+    static constexpr std::size_t VERTICES_PER_QUAD = 6; // two triangles
+
+    struct Batch
+    {
+        const sf::Texture* texture;
+        sf::VertexArray vertices;
+    };
+
+    void clear();
+    void add(const sf::Texture& texture, const sf::IntRect& rect, sf::Vector2f origin, sf::Vector2f scale, sf::Vector2f position, float rotation);
+
+    auto getBatchCount() const { return m_used; }
+    const Batch& getBatch(std::size_t index) const { return m_batches[index]; }
+    std::size_t getQuadCount() const;
+
+  protected:
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+  private:
+    std::vector<Batch> m_batches;
+    std::size_t m_used{0};    // batches holding this frame's quads, the rest are kept for their storage
+    std::size_t m_current{0}; // batch of the last quad added, the next is most likely from the same texture
+
+    Batch& findBatch(const sf::Texture& texture);
+};
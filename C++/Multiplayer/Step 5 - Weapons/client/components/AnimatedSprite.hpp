@@ -1,16 +1,19 @@
 #pragma once
 
+#include "AssetCache.hpp"
 #include "components/Component.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <chrono>
 #include <cstdint>
 #include <memory>
-#include <vector>
 
 // --------------------------------------------------------------
 //
-// Specifies the visual appearance of an aminated sprite.
+// Specifies the visual appearance of an aminated sprite: the clip it
+// plays, shared with every other entity playing it, and where it is
+// in that clip.  The scale takes the clip's frames to the entity's
+// size in the view.
 //
 // --------------------------------------------------------------
 namespace components
@@ -18,22 +21,28 @@ namespace components
     class AnimatedSprite : public Component
     {
       public:
-        AnimatedSprite(std::vector<std::shared_ptr<sf::Sprite>> sprites, std::vector<std::chrono::milliseconds> spriteTime) :
-            m_sprites(sprites),
-            m_spriteTime(spriteTime)
+        AnimatedSprite(std::shared_ptr<const AnimationClip> clip, sf::Vector2f scale) :
+            m_clip(clip),
+            m_scale(scale)
         {
         }
 
         void updateElapsedTime(std::chrono::microseconds howMuch) { m_elapsedTime += howMuch; }
-        auto get() { return m_sprites[m_currentSprite]; }
-        auto getCurrentSpriteTime() { return m_spriteTime[m_currentSprite]; };
+        const auto& getClip() { return *m_clip; }
+        const auto& getFrame() { return m_clip->frames[m_currentSprite]; }
+        auto getScale() { return m_scale; }
+        auto getCurrentSpriteTime() { return m_clip->frameTimes[m_currentSprite]; };
         auto getElapsedTime() { return m_elapsedTime; }
-        void incrementSprite() { m_currentSprite = (m_currentSprite + 1) % static_cast<std::uint8_t>(m_sprites.size()); }
+        void incrementSprite()
+        {
+            m_currentSprite = (m_currentSprite + 1) % static_cast<std::uint16_t>(m_clip->frames.size());
+            markChanged();
+        }
 
       private:
-        std::vector<std::shared_ptr<sf::Sprite>> m_sprites;
-        std::vector<std::chrono::milliseconds> m_spriteTime;
-        std::uint8_t m_currentSprite{0};
+        std::shared_ptr<const AnimationClip> m_clip;
+        sf::Vector2f m_scale;
+        std::uint16_t m_currentSprite{0};
         std::chrono::microseconds m_elapsedTime{0};
     };
 } // namespace components
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AssetCache.hpp"
 #include "components/Component.hpp"
 
 #include <SFML/Graphics.hpp>
@@ -7,7 +8,8 @@
 
 // --------------------------------------------------------------
 //
-// Specifies the visual appearance.
+// Specifies the visual appearance.  The texture region is the
+// image the sprite is drawn from, held so it stays loaded.
 //
 // --------------------------------------------------------------
 namespace components
@@ -15,14 +17,17 @@ namespace components
     class Sprite : public Component
     {
       public:
-        Sprite(std::shared_ptr<sf::Sprite> sprite) :
+        Sprite(std::shared_ptr<const TextureRegion> region, std::shared_ptr<sf::Sprite> sprite) :
+            m_region(region),
             m_sprite(sprite)
         {
         }
 
         auto get() { return m_sprite; }
+        auto getRegion() { return m_region; }
 
       private:
+        std::shared_ptr<const TextureRegion> m_region;
         std::shared_ptr<sf::Sprite> m_sprite;
     };
 } // namespace components
@@ -1,13 +1,25 @@
+#include "AssetCache.hpp"
 #include "GameModel.hpp"
 #include "MessageQueueClient.hpp"
+#include "misc/Profiler.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
 
+//
+// With the profiler compiled in (the PROFILER CMake option), F12 writes the
+// timings recorded since the last time to this file, as does quitting.
+const std::string TRACE_FILE = "client.trace.json";
+
+//
+// Built by the AssetPack tool, the loose images are used when it isn't there
+const std::string ASSET_PACK = "assets/assets.pack";
+
 std::shared_ptr<sf::RenderWindow> prepareWindow()
 {
     //
@@ -52,32 +64,49 @@ void prepareView(std::shared_ptr<sf::RenderWindow> window)
     window->setView(view);
 }
 
-int main()
+//
+// The server address and port can be given on the command line, e.g. to
+// connect through the NetProxy: Client 127.0.0.1 3001
+int main(int argc, char* argv[])
 {
+    std::string serverAddress = argc > 1 ? argv[1] : "127.0.0.1";
+    std::uint16_t serverPort = argc > 2 ? static_cast<std::uint16_t>(std::stoul(argv[2])) : 3000;
+
     //
     // Create and activate the window for rendering on the main thread
     auto window = prepareWindow();
     prepareView(window);
     window->setActive(true);
 
-    if (!MessageQueueClient::instance().initialize("127.0.0.1", 3000))
+    if (!MessageQueueClient::instance().initialize(serverAddress, serverPort))
     {
         std::cout << "Failed to initialize connection to the server, terminating..." << std::endl;
         exit(0);
     }
 
+    //
+    // Textures are created from the asset pack up front, so entities never wait on
+    // loading one
+    if (!AssetCache::instance().loadPack(ASSET_PACK))
+    {
+        std::cout << "No asset pack at " << ASSET_PACK << ", loading the images as they are used" << std::endl;
+    }
+    AssetCache::instance().startLoader();
+
     //
     // Get the game model initialized and ready to run
     GameModel model;
     if (!model.initialize({window->getView().getSize().x, window->getView().getSize().y}))
     {
         std::cout << "Game model failed to initialize, terminating..." << std::endl;
+        AssetCache::instance().shutdown();
         exit(0);
     }
 
     //
     // Grab an initial time-stamp to get the elapsed time working
-    auto previousTime = std::chrono::system_clock::now();
+    auto previousTime = std::chrono::steady_clock::now();
+    PROFILE_THREAD("Game loop");
 
     //
     // Get the Window loop running.  The game loop runs inside of this loop
@@ -87,7 +116,7 @@ int main()
         //
         // Figure out the elapsed time in microseconds.  Need this to pass on to
         // the game model.
-        auto currentTime = std::chrono::system_clock::now();
+        auto currentTime = std::chrono::steady_clock::now();
         auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - previousTime);
         previousTime = currentTime;
 
@@ -101,6 +130,10 @@ int main()
                 running = false;
             }
 
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12)
+            {
+                profiler::Profiler::instance().writeTrace(TRACE_FILE);
+            }
             if (event.type == sf::Event::KeyPressed)
             {
                 model.signalKeyPressed(event.key, elapsedTime);
@@ -124,6 +157,8 @@ int main()
     }
 
     MessageQueueClient::instance().shutdown();
+    AssetCache::instance().shutdown();
+    profiler::Profiler::instance().writeTrace(TRACE_FILE);
 
     return 0;
 }
@@ -1,32 +1,103 @@
 #include "Animation.hpp"
 
+#include "misc/Profiler.hpp"
+
+#include <algorithm>
+
 namespace systems
 {
     // --------------------------------------------------------------
     //
-    // Update the state of the sprite based on elapsed time.
+    // The sprite is packed along with the others when the entity is
+    // added, and goes along with it.
     //
     // --------------------------------------------------------------
-    void Animation::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+    bool Animation::addEntity(std::shared_ptr<entities::Entity> entity)
     {
-        for (auto&& [id, entity] : m_entities)
+        if (System::addEntity(entity))
         {
-            (void)id; // unused
-            auto sprite = entity->getComponent<components::AnimatedSprite>();
-            sprite->updateElapsedTime(elapsedTime);
-            //
-            // Check to see if we have expired the current sprite time and need to
-            // move to the next sprite.
-            if (sprite->getElapsedTime() >= std::chrono::duration_cast<std::chrono::microseconds>(sprite->getCurrentSpriteTime()))
+            m_animatedIndex[entity->getId()] = m_animated.size();
+            m_animated.push_back({entity->getId(), entity->getComponent<components::AnimatedSprite>(), std::chrono::steady_clock::now()});
+            return true;
+        }
+
+        return false;
+    }
+
+    void Animation::removeEntity(entities::Entity::IdType entityId)
+    {
+        System::removeEntity(entityId);
+
+        auto index = m_animatedIndex.find(entityId);
+        if (index != m_animatedIndex.end())
+        {
+            m_animated[index->second] = m_animated.back();
+            m_animatedIndex[m_animated.back().id] = index->second;
+            m_animated.pop_back();
+            m_animatedIndex.erase(entityId);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Update the state of all the sprites.
+    //
+    // --------------------------------------------------------------
+    void Animation::update([[maybe_unused]] std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now)
+    {
+        PROFILE_SCOPE("Animation::update");
+
+        for (auto& animated : m_animated)
+        {
+            animate(animated, now);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Update the state of the sprites in view.
+    //
+    // --------------------------------------------------------------
+    void Animation::update([[maybe_unused]] std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, const std::vector<entities::Entity::IdType>& visible)
+    {
+        PROFILE_SCOPE("Animation::update");
+
+        for (auto id : visible)
+        {
+            auto index = m_animatedIndex.find(id);
+            if (index != m_animatedIndex.end())
             {
-                //
-                // Keep the leftover time
-                sprite->updateElapsedTime(-std::chrono::duration_cast<std::chrono::microseconds>(sprite->getCurrentSpriteTime()));
-                //
-                // Update to next sprite, wrapping around if necessary
-                sprite->incrementSprite();
+                animate(m_animated[index->second], now);
             }
         }
     }
 
+    // --------------------------------------------------------------
+    //
+    // Update the state of the sprite based on the time since it was last
+    // updated.
+    //
+    // --------------------------------------------------------------
+    void Animation::animate(Animated& animated, const std::chrono::steady_clock::time_point now)
+    {
+        auto sprite = animated.sprite;
+        //
+        // An entity added during this update's playback was stamped a little after 'now'
+        auto elapsedTime = std::max(std::chrono::duration_cast<std::chrono::microseconds>(now - animated.updated), std::chrono::microseconds(0));
+        animated.updated = now;
+        sprite->updateElapsedTime(elapsedTime);
+        //
+        // Check to see if we have expired the current sprite time and need to
+        // move to the next sprite, more than once for a sprite that was out of view.
+        while (sprite->getElapsedTime() >= sprite->getCurrentSpriteTime() && sprite->getCurrentSpriteTime().count() > 0)
+        {
+            //
+            // Keep the leftover time
+            sprite->updateElapsedTime(-sprite->getCurrentSpriteTime());
+            //
+            // Update to next sprite, wrapping around if necessary
+            sprite->incrementSprite();
+        }
+    }
+
 } // namespace systems
@@ -4,6 +4,10 @@
 #include "systems/System.hpp"
 
 #include <chrono>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace systems
 {
@@ -11,6 +15,13 @@ namespace systems
     //
     // This system is used to update animated sprites.
     //
+    // The sprites are kept packed together, so the update walks a flat
+    // array instead of looking each one up through its entity.
+    //
+    // Given the entities in view, only their sprites are updated.  Each
+    // sprite remembers when it was last updated, one that comes back
+    // into view catches up on all of the time it was out of it.
+    //
     // --------------------------------------------------------------
     class Animation : public System
     {
@@ -20,6 +31,22 @@ namespace systems
         {
         }
 
-        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
+        virtual void removeEntity(entities::Entity::IdType entityId) override;
+        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, const std::vector<entities::Entity::IdType>& visible);
+
+      private:
+        struct Animated
+        {
+            entities::Entity::IdType id;
+            components::AnimatedSprite* sprite;
+            std::chrono::steady_clock::time_point updated;
+        };
+
+        std::vector<Animated> m_animated;
+        std::unordered_map<entities::Entity::IdType, std::size_t> m_animatedIndex;
+
+        static void animate(Animated& animated, const std::chrono::steady_clock::time_point now);
     };
 } // namespace systems
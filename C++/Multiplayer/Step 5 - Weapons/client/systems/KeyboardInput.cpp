@@ -1,8 +1,9 @@
 #include "KeyboardInput.hpp"
 
-#include "MessageQueueClient.hpp"
 #include "entities/Update.hpp"
+#include "MessageQueueClient.hpp"
 #include "messages/Input.hpp"
+#include "misc/Profiler.hpp"
 
 namespace systems
 {
@@ -51,8 +52,10 @@ namespace systems
     // update based upon the current keyboard state.
     //
     // --------------------------------------------------------------
-    void KeyboardInput::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+    void KeyboardInput::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now)
     {
+        PROFILE_SCOPE("KeyboardInput::update");
+
         for (auto&& [id, entity] : m_entities)
         {
             std::vector<components::Input::Type> inputs;
@@ -85,7 +88,8 @@ namespace systems
             }
             if (!inputs.empty())
             {
-                MessageQueueClient::instance().sendMessageWithId(std::make_shared<messages::Input>(id, inputs, elapsedTime));
+                auto viewTime = m_viewTimeHandler ? m_viewTimeHandler() : std::nullopt;
+                MessageQueueClient::instance().sendMessageWithId(std::make_shared<messages::Input>(id, inputs, elapsedTime, viewTime));
             }
         }
     }
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <functional>
 #include <initializer_list>
+#include <optional>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -36,7 +37,8 @@ namespace systems
         virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
         virtual void removeEntity(entities::Entity::IdType entityId) override;
 
-        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
+        void registerViewTimeHandler(std::function<std::optional<std::chrono::steady_clock::time_point>()> handler) { m_viewTimeHandler = handler; }
 
         void keyPressed(sf::Event::KeyEvent keyEvent, std::chrono::microseconds elapsedTime);
         void keyReleased(sf::Event::KeyEvent keyEvent, std::chrono::microseconds elapsedTime);
@@ -53,5 +55,6 @@ namespace systems
 
         std::unordered_map<components::Input::Type, sf::Keyboard::Key> m_typeToKeyMap;
         std::unordered_map<entities::Entity::IdType, KeyToType> m_keyToFunctionMap;
+        std::function<std::optional<std::chrono::steady_clock::time_point>()> m_viewTimeHandler{nullptr};
     };
 } // namespace systems
@@ -4,6 +4,9 @@
 #include "components/Input.hpp"
 #include "entities/Update.hpp"
 #include "misc/math.hpp"
+#include "misc/Profiler.hpp"
+
+#include <algorithm>
 
 namespace systems
 {
@@ -11,8 +14,8 @@ namespace systems
     //
     // Interested in entities that have both Movement and Position components,
     // but not if they have an Input component.  Furthermore, this
-    // system adds an Goal component in order to properly update the
-    // entity's state during the update stage.
+    // system adds an Goal component (through its command buffer) in order
+    // to properly update the entity's state during the update stage.
     //
     // --------------------------------------------------------------
     bool Momentum::addEntity(std::shared_ptr<entities::Entity> entity)
@@ -21,38 +24,63 @@ namespace systems
         if (System::addEntity(entity))
         {
             interested = true;
-            if (!entity->hasComponent<components::Input>())
+            if (!entity->hasComponent<components::Input>() && !entity->hasComponent<components::Goal>())
             {
                 auto position = entity->getComponent<components::Position>();
-                entity->addComponent(std::make_unique<components::Goal>(position->get(), position->getOrientation()));
+                m_commands.addComponent(entity->getId(), std::make_unique<components::Goal>(position->get(), position->getOrientation()));
             }
+
+            auto goal = entity->hasComponent<components::Goal>() ? entity->getComponent<components::Goal>() : nullptr;
+            m_movingIndex[entity->getId()] = m_moving.size();
+            m_moving.push_back({entity->getId(), entity.get(), entity->getComponent<components::Position>(), entity->getComponent<components::Momentum>(), goal});
         }
 
         return interested;
     }
 
+    // --------------------------------------------------------------
+    //
+    // The packed components go along with the entity.
+    //
+    // --------------------------------------------------------------
+    void Momentum::removeEntity(entities::Entity::IdType entityId)
+    {
+        System::removeEntity(entityId);
+
+        auto index = m_movingIndex.find(entityId);
+        if (index != m_movingIndex.end())
+        {
+            m_moving[index->second] = m_moving.back();
+            m_movingIndex[m_moving.back().id] = index->second;
+            m_moving.pop_back();
+            m_movingIndex.erase(entityId);
+        }
+    }
+
     // --------------------------------------------------------------
     //
     // Update each entitiy's postion.  Some entities move based on a goal
     // provided by the server.  Some require entity (clien) prediction.
     //
     // --------------------------------------------------------------
-    void Momentum::update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now)
+    void Momentum::update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now)
     {
-        for (auto&& [id, entity] : m_entities)
+        PROFILE_SCOPE("Momentum::update");
+
+        m_batch.clear();
+        m_floating.clear();
+        for (auto& [id, entity, position, momentum, goal] : m_moving)
         {
             (void)id; // unused
             bool floating = true;
             auto floatingTime = elapsedTime;
-            if (entity->hasComponent<components::Goal>())
+            if (goal != nullptr)
             {
-                auto goal = entity->getComponent<components::Goal>();
                 //
                 // Protect against divide by 0 in addition to checking for remaining update window time
                 if (goal->getUpdateWindow().count() != 0 && goal->getUpdatedTime() < goal->getUpdateWindow())
                 {
                     floating = false;
-                    auto position = entity->getComponent<components::Position>();
 
                     // Don't want to interpolate longer than the update window
                     auto howMuch = elapsedTime;
@@ -72,29 +100,35 @@ namespace systems
                     position->setOrientation(position->getOrientation() - (goal->getStartOrientation() - goal->getGoalOrientation()) * updateFraction);
                     //
                     // Then move
-                    position->set(
-                        math::Vector2f(
-                            position->get().x - (goal->getStartPosition().x - goal->getGoalPosition().x) * updateFraction,
-                            position->get().y - (goal->getStartPosition().y - goal->getGoalPosition().y) * updateFraction));
+                    position->set(position->get() - (goal->getStartPosition() - goal->getGoalPosition()) * updateFraction);
                 }
             }
             if (floating)
             {
                 // Just floating along based on momentum
-                auto position = entity->getComponent<components::Position>();
                 if (position->getNeedsEntityPrediction())
                 {
-                    auto predictLength = std::chrono::duration_cast<std::chrono::microseconds>(position->getLastServerUpdate() - position->getLastClientUpdate());
-                    entities::drift(entity.get(), predictLength);
+                    //
+                    // Bring the server's state forward to where the client has simulated to,
+                    // the floating below takes it the rest of the way.
+                    auto predictLength = std::max(std::chrono::microseconds(0), std::chrono::duration_cast<std::chrono::microseconds>(position->getLastClientUpdate() - position->getLastServerUpdate()));
+                    entities::drift(entity, predictLength);
                     position->resetEntityPrediction();
                 }
                 //else  // TODO: Still not sure if this should be an else
                 {
-                    entities::drift(entity.get(), floatingTime);
+                    m_batch.push_back(position->get(), momentum->get(), static_cast<float>(floatingTime.count()));
+                    m_floating.push_back(position);
                     position->setLastClientUpdate(now);
                 }
             }
         }
+
+        kinematics::drift(m_batch);
+        for (std::size_t i = 0; i < m_floating.size(); i++)
+        {
+            m_floating[i]->set(m_batch.position.get(i));
+        }
     }
 
 } // namespace systems
@@ -2,12 +2,17 @@
 
 #include "components/Momentum.hpp"
 #include "components/Position.hpp"
+#include "components/Goal.hpp"
 #include "entities/Entity.hpp"
+#include "misc/Kinematics.hpp"
 #include "systems/System.hpp"
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace systems
 {
@@ -16,6 +21,11 @@ namespace systems
     // This system is used perform entity movement, which includes
     // entity interpolation and entity prediction.
     //
+    // The components of each entity are looked up once, when it is
+    // added, and kept packed together.  The entities floating along on
+    // their momentum are gathered into a kinematics::Batch and moved
+    // all at once.
+    //
     // --------------------------------------------------------------
     class Momentum : public System
     {
@@ -27,8 +37,22 @@ namespace systems
         }
 
         virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
-        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual void removeEntity(entities::Entity::IdType entityId) override;
+        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
 
       private:
+        struct Moving
+        {
+            entities::Entity::IdType id;
+            entities::Entity* entity;
+            components::Position* position;
+            components::Momentum* momentum;
+            components::Goal* goal; // nullptr if it doesn't have one
+        };
+
+        std::vector<Moving> m_moving;
+        std::unordered_map<entities::Entity::IdType, std::size_t> m_movingIndex;
+        kinematics::Batch m_batch;
+        std::vector<components::Position*> m_floating; // the position of each entity in the batch
     };
 } // namespace systems
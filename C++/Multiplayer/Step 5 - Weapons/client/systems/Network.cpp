@@ -1,18 +1,23 @@
 #include "Network.hpp"
 
-#include "MessageQueueClient.hpp"
+#include "AssetCache.hpp"
 #include "components/Goal.hpp"
 #include "components/Input.hpp"
 #include "components/Momentum.hpp"
 #include "components/Movement.hpp"
 #include "components/Position.hpp"
 #include "entities/Update.hpp"
+#include "MessageQueueClient.hpp"
 #include "messages/Input.hpp"
 #include "messages/Join.hpp"
+#include "messages/JoinAck.hpp"
 #include "messages/MessageTypes.hpp"
 #include "messages/NewEntity.hpp"
+#include "messages/Ping.hpp"
 #include "messages/RemoveEntity.hpp"
+#include "messages/WorldState.hpp"
 #include "misc/math.hpp"
+#include "misc/Profiler.hpp"
 
 #include <chrono>
 
@@ -30,25 +35,51 @@ namespace systems
         //
         // We know how to privately handle these messages
         registerHandler(messages::Type::ConnectAck,
-                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
                             // Not completely in love with having to do a static_pointer_cast, but living with it for now
                             handleConnectAck(std::static_pointer_cast<messages::ConnectAck>(message));
                         });
 
         registerHandler(messages::Type::NewEntity,
-                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message> message) {
-                            m_newEntityHandler(std::static_pointer_cast<messages::NewEntity>(message)->getPBEntity());
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                            auto& pbEntity = std::static_pointer_cast<messages::NewEntity>(message)->getPBEntity();
+                            //
+                            // The only entity we are sent with an input component is our player
+                            if (pbEntity.has_input())
+                            {
+                                m_playerId = pbEntity.id();
+                            }
+                            m_newEntityHandler(pbEntity);
+                        });
+
+        //
+        // Kept for asking the server for the same player after reconnecting
+        registerHandler(messages::Type::JoinAck,
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                            auto joinAck = std::static_pointer_cast<messages::JoinAck>(message);
+                            m_playerId = joinAck->getPlayerId();
+                            m_resumeToken = joinAck->getResumeToken();
                         });
 
         registerHandler(messages::Type::UpdateEntity,
-                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message> message) {
-                            handleUpdateEntity(std::static_pointer_cast<messages::UpdateEntity>(message), now);
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                            handleUpdateEntity(std::static_pointer_cast<messages::UpdateEntity>(message));
                         });
 
         registerHandler(messages::Type::RemoveEntity,
-                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
                             auto entityId = std::static_pointer_cast<messages::RemoveEntity>(message)->getPBEntity().id();
-                            m_removeEntityHandler(entityId);
+                            m_commands.destroy(entityId);
+                        });
+
+        registerHandler(messages::Type::WorldState,
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                            handleWorldState(std::static_pointer_cast<messages::WorldState>(message));
+                        });
+
+        registerHandler(messages::Type::Pong,
+                        [this]([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message> message) {
+                            handlePong(std::static_pointer_cast<messages::Pong>(message));
                         });
     }
 
@@ -57,7 +88,7 @@ namespace systems
     // Allow handlers for messages to be registered.
     //
     // --------------------------------------------------------------
-    void Network::registerHandler(messages::Type type, std::function<void(std::chrono::microseconds, const std::chrono::system_clock::time_point, std::shared_ptr<messages::Message>)> handler)
+    void Network::registerHandler(messages::Type type, std::function<void(std::chrono::microseconds, const std::chrono::steady_clock::time_point, std::shared_ptr<messages::Message>)> handler)
     {
         m_commandMap[type] = handler;
     }
@@ -67,9 +98,22 @@ namespace systems
     // Process all outstanding messages since the last update.
     //
     // --------------------------------------------------------------
-    void Network::update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::queue<std::shared_ptr<messages::Message>> messages)
+    void Network::update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::queue<std::shared_ptr<messages::Message>> messages)
     {
+        PROFILE_SCOPE("Network::update");
+
         m_updatedEntities.clear();
+        //
+        // Updates that arrived along with their entity, it has been added since
+        auto deferred = std::move(m_deferredUpdates);
+        m_deferredUpdates.clear();
+        for (auto&& message : deferred)
+        {
+            if (m_entities.find(message->getPBEntity().id()) != m_entities.end())
+            {
+                handleUpdateEntity(message);
+            }
+        }
         while (!messages.empty())
         {
             auto message = messages.front();
@@ -87,6 +131,8 @@ namespace systems
             }
         }
 
+        sendPing(elapsedTime);
+
         //
         // After processing all the messages, perform server reconciliation by
         // resimulating the inputs from any sent messages not yet acknowledged by the server.
@@ -98,7 +144,12 @@ namespace systems
             if (message->getType() == messages::Type::Input)
             {
                 auto* inputMessage = static_cast<messages::Input*>(message.get());
-                auto entity = m_entities[inputMessage->getEntityId()].get();
+                auto found = m_entities.find(inputMessage->getEntityId());
+                if (found == m_entities.end())
+                {
+                    continue;
+                }
+                auto entity = found->second.get();
 
                 if (m_updatedEntities.find(entity->getId()) != m_updatedEntities.end())
                 {
@@ -129,26 +180,117 @@ namespace systems
     //
     // Handler for the ConnectAck message.  This records the clientId
     // assigned to it by the server, it also sends a request to the server
-    // to join the game.
+    // to join the game.  If we already had a player, ask for it back.
+    // The assets listed in it start loading in the background.
+    //
+    // A second ConnectAck means the connection was lost and made again.
+    // Everything known about the old connection is thrown away, the
+    // server sends the world again, but the player id and resume token
+    // are kept so the server can hand the same ship back.
     //
     // --------------------------------------------------------------
-    void Network::handleConnectAck([[maybe_unused]] std::shared_ptr<messages::ConnectAck> message)
+    void Network::handleConnectAck(std::shared_ptr<messages::ConnectAck> message)
     {
+        if (m_connected)
+        {
+            if (m_reconnectHandler)
+            {
+                m_reconnectHandler();
+            }
+            m_lastMessageId = 0;
+            m_deferredUpdates.clear();
+            m_serverClock = ServerClock{};
+            m_timeSincePing = std::chrono::microseconds(0);
+            MessageQueueClient::instance().clearSendMessageHistory();
+        }
+        m_connected = true;
+        //
+        // Start loading everything the server says we'll need, before any entity arrives
+        for (auto&& asset : message->getAssets())
+        {
+            AssetCache::instance().request(asset);
+        }
         //
         // Now, send a Join message back to the server so we can get into the game!
-        MessageQueueClient::instance().sendMessage(std::make_shared<messages::Join>());
+        MessageQueueClient::instance().sendMessage(std::make_shared<messages::Join>(m_playerId, m_resumeToken));
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Handler for the Pong message, it is another sample for the
+    // server clock estimate.
+    //
+    // --------------------------------------------------------------
+    void Network::handlePong(std::shared_ptr<messages::Pong> message)
+    {
+        m_serverClock.addSample(*message);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The server time of the world currently on screen.  Remote entities
+    // are shown interpolating toward the last state received, so they
+    // are behind the server by the trip here plus an update window.
+    //
+    // --------------------------------------------------------------
+    std::optional<std::chrono::steady_clock::time_point> Network::getViewTime() const
+    {
+        if (!m_serverClock.isSynchronized())
+        {
+            return std::nullopt;
+        }
+        return m_serverClock.serverNow() - m_serverClock.getRoundTripTime() / 2 - m_updateWindow;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Once connected, periodically ping the server to keep the clock
+    // offset and round trip time current.
+    //
+    // --------------------------------------------------------------
+    void Network::sendPing(std::chrono::microseconds elapsedTime)
+    {
+        if (!m_connected)
+        {
+            return;
+        }
+
+        m_timeSincePing += elapsedTime;
+        auto interval = m_serverClock.getSampleCount() < PING_SYNCHRONIZING_SAMPLES ? PING_INTERVAL_SYNCHRONIZING : PING_INTERVAL;
+        if (m_timeSincePing >= interval)
+        {
+            m_timeSincePing = std::chrono::microseconds(0);
+            MessageQueueClient::instance().sendMessage(std::make_shared<messages::Ping>(m_serverClock.getRoundTripTime()));
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Handler for the WorldState message.  Each chunk of the world sent
+    // to us after joining is a batch of new entities.
+    //
+    // --------------------------------------------------------------
+    void Network::handleWorldState(std::shared_ptr<messages::WorldState> message)
+    {
+        for (int index = 0; index < message->getPBWorldState().entities_size(); index++)
+        {
+            m_newEntityHandler(message->getPBEntity(index));
+        }
     }
 
     // --------------------------------------------------------------
     //
     // Handler for the UpdateEntity message.  It checks to see if the client
     // actually has the entity, and if it does, updates the components
-    // that are in common between the message and the entity.
+    // that are in common between the message and the entity.  An entity
+    // sent in the same batch of messages isn't added until the next
+    // update, its update is tried once more then.
     //
     // --------------------------------------------------------------
-    void Network::handleUpdateEntity(std::shared_ptr<messages::UpdateEntity> message, const std::chrono::system_clock::time_point now)
+    void Network::handleUpdateEntity(std::shared_ptr<messages::UpdateEntity> message)
     {
         auto& pbEntity = message->getPBEntity();
+        m_updateWindow = std::chrono::microseconds(pbEntity.updatewindow());
         if (m_entities.find(pbEntity.id()) != m_entities.end())
         {
             auto entity = m_entities[pbEntity.id()];
@@ -172,7 +314,11 @@ namespace systems
 
                 position->set(math::Vector2f(pbEntity.position().center().x(), pbEntity.position().center().y()));
                 position->setOrientation(pbEntity.position().orientation());
-                position->setLastServerUpdate(now);
+                //
+                // The update describes the entity at the server time it was sent with,
+                // once the clock is synchronized that is translated to our time,
+                // until then, the best guess is when it arrived.
+                position->setLastServerUpdate(m_serverClock.isSynchronized() ? m_serverClock.toLocal(message->getServerTime()) : message->getReceivedTime());
             }
 
             //
@@ -184,5 +330,9 @@ namespace systems
                 m_updatedEntities.insert(entity->getId());
             }
         }
+        else
+        {
+            m_deferredUpdates.push_back(message);
+        }
     }
 } // namespace systems
@@ -2,22 +2,28 @@
 
 #include "components/Input.hpp"
 #include "components/Movement.hpp"
+#include "ServerClock.hpp"
 #include "components/Position.hpp"
 #include "entities/Entity.hpp"
 #include "messages/ConnectAck.hpp"
 #include "messages/Message.hpp"
+#include "messages/Pong.hpp"
 #include "messages/UpdateEntity.hpp"
+#include "messages/WorldState.hpp"
 #include "systems/System.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace systems
 {
@@ -33,19 +39,38 @@ namespace systems
         Network();
 
         void registerNewEntityHandler(std::function<void(const shared::Entity&)> handler) { m_newEntityHandler = handler; }
-        void registerRemoveEntityHandler(std::function<void(entities::Entity::IdType)> handler) { m_removeEntityHandler = handler; }
-        void registerHandler(messages::Type type, std::function<void(std::chrono::microseconds, const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message>)> handler);
-        void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::queue<std::shared_ptr<messages::Message>> messages);
+        void registerReconnectHandler(std::function<void()> handler) { m_reconnectHandler = handler; }
+        void registerHandler(messages::Type type, std::function<void(std::chrono::microseconds, const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message>)> handler);
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::queue<std::shared_ptr<messages::Message>> messages);
+
+        const ServerClock& getServerClock() const { return m_serverClock; }
+        std::optional<std::chrono::steady_clock::time_point> getViewTime() const;
 
       private:
-        std::unordered_map<messages::Type, std::function<void(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::shared_ptr<messages::Message>)>> m_commandMap;
-        std::function<void(entities::Entity::IdType)> m_removeEntityHandler{nullptr};
+        //
+        // Pings go out quickly until the clock has a few samples, then settle down
+        static constexpr auto PING_INTERVAL_SYNCHRONIZING = std::chrono::milliseconds(100);
+        static constexpr auto PING_INTERVAL = std::chrono::milliseconds(1000);
+        static constexpr std::size_t PING_SYNCHRONIZING_SAMPLES = 4;
+
+        std::unordered_map<messages::Type, std::function<void(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::shared_ptr<messages::Message>)>> m_commandMap;
         std::function<void(const shared::Entity&)> m_newEntityHandler{nullptr};
+        std::function<void()> m_reconnectHandler{nullptr};
         std::uint32_t m_lastMessageId{0};
+        std::optional<entities::Entity::IdType> m_playerId;
+        std::uint64_t m_resumeToken{0};
+        bool m_connected{false};
+        ServerClock m_serverClock;
+        std::chrono::microseconds m_timeSincePing{0};
+        std::chrono::microseconds m_updateWindow{0};
 
         entities::EntitySet m_updatedEntities;
+        std::vector<std::shared_ptr<messages::UpdateEntity>> m_deferredUpdates; // for entities not added yet
 
         void handleConnectAck(std::shared_ptr<messages::ConnectAck> message);
-        void handleUpdateEntity(std::shared_ptr<messages::UpdateEntity> message, const std::chrono::system_clock::time_point now);
+        void handleWorldState(std::shared_ptr<messages::WorldState> message);
+        void handlePong(std::shared_ptr<messages::Pong> message);
+        void sendPing(std::chrono::microseconds elapsedTime);
+        void handleUpdateEntity(std::shared_ptr<messages::UpdateEntity> message);
     };
 } // namespace systems
@@ -2,6 +2,7 @@
 #include "Renderer.hpp"
 
 #include "entities/Entity.hpp"
+#include "misc/Profiler.hpp"
 
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <tuple>
@@ -16,9 +17,16 @@ namespace systems
     // Probably a terrible idea to hard-code the background rendering here,
     // I'll eventually find a better home for it.
     //
+    // Only the entities in view are drawn.  Sprites aren't drawn one at
+    // a time, they are all collected into the batch, placed where their
+    // entity is, and drawn with one call for each texture.  Animated
+    // sprites have no SFML sprite, the batch is given their current frame.
+    //
     // --------------------------------------------------------------
-    void Renderer::update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget)
+    void Renderer::update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget, const std::vector<entities::Entity::IdType>& visible)
     {
+        PROFILE_SCOPE("Renderer::update");
+
         // Draw the blue background
         sf::RectangleShape square({1.0f, 1.0f});
         square.setFillColor(sf::Color::Blue);
@@ -28,32 +36,36 @@ namespace systems
         renderTarget->draw(square);
 
         // Render each of the entities
-        for (auto&& [id, entity] : m_entities)
+        m_batch.clear();
+        for (auto id : visible)
         {
-            (void)id; // unused
+            auto found = m_entities.find(id);
+            if (found == m_entities.end())
+            {
+                continue;
+            }
+            auto& entity = found->second;
             //
             // I know having these if statements isn't great for performance, but for this demo
             // code (for now), I'm okay with it.
             // Could bucket entities into Sprite and AnimatedSprite collections and render
             // them from those.
             auto position = entity->getComponent<components::Position>();
+            sf::Vector2f center(position->get().x, position->get().y);
             if (entity->hasComponent<components::Sprite>())
             {
-                auto sprite = entity->getComponent<components::Sprite>();
-                sprite->get()->setPosition({position->get().x, position->get().y});
-                sprite->get()->setRotation(position->getOrientation());
-
-                renderTarget->draw(*sprite->get());
+                auto& sprite = *entity->getComponent<components::Sprite>()->get();
+                m_batch.add(*sprite.getTexture(), sprite.getTextureRect(), sprite.getOrigin(), sprite.getScale(), center, position->getOrientation());
             }
             else if (entity->hasComponent<components::AnimatedSprite>())
             {
                 auto sprite = entity->getComponent<components::AnimatedSprite>();
-                sprite->get()->setPosition({position->get().x, position->get().y});
-                sprite->get()->setRotation(position->getOrientation());
-
-                renderTarget->draw(*sprite->get());
+                auto& frame = sprite->getFrame();
+                // Rotation takes place about the center of the frame
+                m_batch.add(*sprite->getClip().sheet->texture, frame, {frame.width / 2.0f, frame.height / 2.0f}, sprite->getScale(), center, position->getOrientation());
             }
         }
+        renderTarget->draw(m_batch);
     }
 
     // --------------------------------------------------------------
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "SpriteBatch.hpp"
 #include "components/AnimatedSprite.hpp"
 #include "components/Position.hpp"
 #include "components/Size.hpp"
@@ -9,6 +10,7 @@
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <chrono>
 #include <memory>
+#include <vector>
 
 namespace systems
 {
@@ -26,11 +28,12 @@ namespace systems
         {
         }
 
-        void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget);
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::shared_ptr<sf::RenderTarget> renderTarget, const std::vector<entities::Entity::IdType>& visible);
 
       protected:
         virtual bool isInterested(entities::Entity* entity) override;
 
       private:
+        SpriteBatch m_batch; // the frame's sprites, drawn a texture at a time
     };
 } // namespace systems
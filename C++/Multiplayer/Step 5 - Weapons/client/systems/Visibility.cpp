@@ -0,0 +1,85 @@
+#include "Visibility.hpp"
+
+#include "misc/Profiler.hpp"
+
+#include <algorithm>
+
+namespace systems
+{
+    // --------------------------------------------------------------
+    //
+    // The entity is placed in the tree as soon as it is added, and
+    // packed along with the others so the update can check for moves
+    // without looking up its components.
+    //
+    // --------------------------------------------------------------
+    bool Visibility::addEntity(std::shared_ptr<entities::Entity> entity)
+    {
+        if (System::addEntity(entity))
+        {
+            Placed placed{entity->getId(), entity->getComponent<components::Position>(), entity->getComponent<components::Size>()};
+            m_placedIndex[placed.id] = m_placed.size();
+            m_placed.push_back(placed);
+            m_tree.insert(placed.id, getBounds(placed));
+            return true;
+        }
+
+        return false;
+    }
+
+    void Visibility::removeEntity(entities::Entity::IdType entityId)
+    {
+        System::removeEntity(entityId);
+
+        auto index = m_placedIndex.find(entityId);
+        if (index != m_placedIndex.end())
+        {
+            m_placed[index->second] = m_placed.back();
+            m_placedIndex[m_placed.back().id] = index->second;
+            m_placed.pop_back();
+            m_placedIndex.erase(entityId);
+            m_tree.remove(entityId);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Moves the entities whose position changed since the last update,
+    // then finds those overlapping the view.
+    //
+    // --------------------------------------------------------------
+    void Visibility::update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now, const sf::View& view)
+    {
+        PROFILE_SCOPE("Visibility::update");
+
+        for (auto& placed : m_placed)
+        {
+            if (placed.position->changedSince(m_placedVersion))
+            {
+                m_tree.update(placed.id, getBounds(placed));
+            }
+        }
+        m_placedVersion = components::Component::closeVersion();
+
+        math::Vector2f center(view.getCenter().x, view.getCenter().y);
+        math::Vector2f half(view.getSize().x / 2, view.getSize().y / 2);
+        m_visible.clear();
+        m_tree.query({center - half, center + half}, m_visible);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The bounds of the entity however it is turned, the sprite is
+    // centered on the position and may be rotated.
+    //
+    // --------------------------------------------------------------
+    QuadTree::Bounds Visibility::getBounds(const Placed& placed)
+    {
+        const float HALF_DIAGONAL = 0.7071068f; // of a unit square
+        auto size = placed.size->get();
+        auto radius = std::max(size.x, size.y) * HALF_DIAGONAL;
+        auto position = placed.position->get();
+
+        return {position - math::Vector2f(radius, radius), position + math::Vector2f(radius, radius)};
+    }
+} // namespace systems
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "QuadTree.hpp"
+#include "components/Component.hpp"
+#include "components/Position.hpp"
+#include "components/Size.hpp"
+#include "misc/math.hpp"
+#include "systems/System.hpp"
+
+#include <SFML/Graphics/View.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace systems
+{
+    // --------------------------------------------------------------
+    //
+    // This system finds the entities in view, for the systems that only
+    // need to work on what can be seen (rendering, animation).
+    //
+    // The entities are kept in a loose quadtree, placed there when they
+    // are added and moved whenever their position changes, so finding
+    // those in view costs about as much as there are to be seen.  The
+    // tree covers a square of the given size around the center, beyond
+    // that entities are still found, just tested one at a time.
+    //
+    // --------------------------------------------------------------
+    class Visibility : public System
+    {
+      public:
+        Visibility(math::Vector2f center, float size) :
+            System({ctti::unnamed_type_id<components::Position>(),
+                    ctti::unnamed_type_id<components::Size>()}),
+            m_tree(center, size)
+        {
+        }
+
+        virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
+        virtual void removeEntity(entities::Entity::IdType entityId) override;
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, const sf::View& view);
+
+        const auto& getVisible() const { return m_visible; }
+
+      private:
+        struct Placed
+        {
+            entities::Entity::IdType id;
+            components::Position* position;
+            components::Size* size;
+        };
+
+        QuadTree m_tree;
+        std::vector<Placed> m_placed;
+        std::unordered_map<entities::Entity::IdType, std::size_t> m_placedIndex;
+        components::Component::Version m_placedVersion{0}; // the tree has all position changes up to this
+        std::vector<entities::Entity::IdType> m_visible;
+
+        static QuadTree::Bounds getBounds(const Placed& placed);
+    };
+} // namespace systems
@@ -0,0 +1,68 @@
+#include "Impairment.hpp"
+
+#include <algorithm>
+
+Impairment::Impairment(Settings settings, std::uint64_t seed) :
+    m_settings(settings),
+    m_random(seed)
+{
+}
+
+// --------------------------------------------------------------
+//
+// Returns the time the message should be delivered, or nothing if
+// the message is lost.
+//
+// --------------------------------------------------------------
+std::optional<std::chrono::steady_clock::time_point> Impairment::schedule(messages::Type type, std::size_t bytes, std::chrono::steady_clock::time_point arrival)
+{
+    //
+    // Every roll is made for every message, whether or not it is used, so
+    // changing one setting doesn't shift the random sequence of the others.
+    auto lossRoll = m_chance(m_random);
+    auto jitterRoll = m_chance(m_random);
+    auto reorderRoll = m_chance(m_random);
+
+    if (isUnreliable(type) && lossRoll < m_settings.loss)
+    {
+        return std::nullopt;
+    }
+
+    m_linkFree = std::max(m_linkFree, arrival);
+    if (m_settings.bandwidth > 0)
+    {
+        m_linkFree += std::chrono::microseconds(bytes * 1000000 / m_settings.bandwidth);
+    }
+
+    auto jitter = std::chrono::microseconds(static_cast<std::int64_t>((jitterRoll * 2.0 - 1.0) * m_settings.jitter.count()));
+    auto delivery = m_linkFree + std::max(std::chrono::microseconds(0), m_settings.latency + jitter);
+
+    if (reorderRoll < m_settings.reorder)
+    {
+        return delivery + m_settings.reorderDelay;
+    }
+
+    delivery = std::max(delivery, m_lastDelivery);
+    m_lastDelivery = delivery;
+
+    return delivery;
+}
+
+// --------------------------------------------------------------
+//
+// The messages that would be fine to lose, a newer one replaces them
+// before long.
+//
+// --------------------------------------------------------------
+bool Impairment::isUnreliable(messages::Type type)
+{
+    switch (type)
+    {
+        case messages::Type::UpdateEntity:
+        case messages::Type::Ping:
+        case messages::Type::Pong:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "messages/MessageTypes.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+
+// --------------------------------------------------------------
+//
+// Decides when (and whether) each message travelling one direction
+// through the proxy is delivered, simulating a network link:
+//
+//  - bandwidth: messages queue behind each other on the link, each
+//    taking its size / bandwidth to get through.
+//  - latency and jitter: after the link, each message is delayed by
+//    latency +/- a uniformly random jitter.  Messages stay in order,
+//    as they would on a TCP connection.
+//  - reorder: the chance a message is held back an extra reorder
+//    delay, letting the messages after it overtake it.
+//  - loss: the chance a message is dropped.  This only applies to
+//    message types that would go over an unreliable (UDP) path, the
+//    rest of the protocol depends on every message arriving.
+//
+// All random decisions come from a generator seeded at construction,
+// the same seed and the same sequence of messages give the same
+// schedule.
+//
+// --------------------------------------------------------------
+class Impairment
+{
+  public:
+    struct Settings
+    {
+        std::chrono::microseconds latency{0};
+        std::chrono::microseconds jitter{0};
+        std::uint64_t bandwidth{0}; // bytes per second, 0 is unlimited
+        double reorder{0};
+        std::chrono::microseconds reorderDelay{std::chrono::milliseconds(50)};
+        double loss{0};
+    };
+
+    Impairment(Settings settings, std::uint64_t seed);
+
+    std::optional<std::chrono::steady_clock::time_point> schedule(messages::Type type, std::size_t bytes, std::chrono::steady_clock::time_point arrival);
+
+    static bool isUnreliable(messages::Type type);
+
+  private:
+    Settings m_settings;
+    std::mt19937_64 m_random;
+    std::uniform_real_distribution<double> m_chance{0.0, 1.0};
+    std::chrono::steady_clock::time_point m_linkFree;
+    std::chrono::steady_clock::time_point m_lastDelivery;
+};
@@ -0,0 +1,261 @@
+#include "NetProxy.hpp"
+
+#include <array>
+#include <cstring>
+#include <iostream>
+
+//
+// For ntohl
+#if defined(_MSC_VER)
+    #include <winsock2.h>
+#else
+    #include <arpa/inet.h>
+#endif
+
+namespace
+{
+    // --------------------------------------------------------------
+    //
+    // Blocking sockets may hand back less than was asked for, keep
+    // reading until all of it has arrived.
+    //
+    // --------------------------------------------------------------
+    bool receiveAll(sf::TcpSocket& socket, char* data, std::size_t size)
+    {
+        std::size_t total = 0;
+        while (total < size)
+        {
+            std::size_t received = 0;
+            if (socket.receive(data + total, size - total, received) != sf::Socket::Done)
+            {
+                return false;
+            }
+            total += received;
+        }
+        return true;
+    }
+} // namespace
+
+// --------------------------------------------------------------
+//
+// Starts listening for clients.  The impairment seed for each
+// connection is derived from the given seed and the order the
+// connections arrive in.
+//
+// --------------------------------------------------------------
+bool NetProxy::initialize(std::uint16_t listenPort, std::string serverAddress, std::uint16_t serverPort, Impairment::Settings toServer, Impairment::Settings toClient, std::uint64_t seed)
+{
+    m_serverAddress = serverAddress;
+    m_serverPort = serverPort;
+    m_toServer = toServer;
+    m_toClient = toClient;
+    m_seed = seed;
+
+    if (m_listener.listen(listenPort) != sf::Socket::Done)
+    {
+        std::cout << "Failed to listen on port " << listenPort << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// Accepts clients until shutdown, cleaning up closed connections
+// along the way.
+//
+// --------------------------------------------------------------
+void NetProxy::run()
+{
+    sf::SocketSelector selector;
+    selector.add(m_listener);
+    while (m_keepRunning)
+    {
+        if (selector.wait(sf::seconds(1.0f)))
+        {
+            auto client = std::make_unique<sf::TcpSocket>();
+            if (m_listener.accept(*client) == sf::Socket::Done)
+            {
+                addConnection(std::move(client));
+            }
+        }
+        removeClosed();
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Closes all connections and waits for their threads to finish.
+//
+// --------------------------------------------------------------
+void NetProxy::shutdown()
+{
+    m_keepRunning = false;
+    m_listener.close();
+    for (auto& connection : m_connections)
+    {
+        closeConnection(*connection);
+    }
+    removeClosed();
+}
+
+// --------------------------------------------------------------
+//
+// Opens the client's connection through to the server and starts
+// moving messages in both directions.
+//
+// --------------------------------------------------------------
+void NetProxy::addConnection(std::unique_ptr<sf::TcpSocket> client)
+{
+    auto connection = std::make_unique<Connection>();
+    connection->id = m_nextConnectionId++;
+    connection->client = std::move(client);
+    connection->server = std::make_unique<sf::TcpSocket>();
+    if (connection->server->connect(m_serverAddress, m_serverPort) != sf::Socket::Done)
+    {
+        std::cout << "Failed to connect to the server at " << m_serverAddress << ":" << m_serverPort << std::endl;
+        connection->client->disconnect();
+        return;
+    }
+
+    auto seed = m_seed + connection->id * 2;
+    connection->toServer = std::make_unique<Direction>("to server", m_toServer, seed);
+    connection->toServer->from = connection->client.get();
+    connection->toServer->to = connection->server.get();
+    connection->toClient = std::make_unique<Direction>("to client", m_toClient, seed + 1);
+    connection->toClient->from = connection->server.get();
+    connection->toClient->to = connection->client.get();
+
+    startDirection(*connection, *connection->toServer);
+    startDirection(*connection, *connection->toClient);
+
+    std::cout << "Connection " << connection->id << " opened from " << connection->client->getRemoteAddress().toString() << std::endl;
+    m_connections.push_back(std::move(connection));
+}
+
+// --------------------------------------------------------------
+//
+// The reader pulls whole messages off the socket and schedules them,
+// the writer sends each one when its delivery time arrives.  Either
+// one failing closes the whole connection.
+//
+// --------------------------------------------------------------
+void NetProxy::startDirection(Connection& connection, Direction& direction)
+{
+    direction.threadReader = std::thread([this, &connection, &direction]() {
+        sf::SocketSelector selector;
+        selector.add(*direction.from);
+        while (connection.open)
+        {
+            if (!selector.wait(sf::seconds(1.0f)))
+            {
+                continue;
+            }
+            std::array<char, 5> header;
+            if (!receiveAll(*direction.from, header.data(), header.size()))
+            {
+                break;
+            }
+            std::uint32_t size;
+            std::memcpy(&size, header.data() + 1, sizeof(size));
+            size = ntohl(size);
+
+            std::string frame(header.data(), header.size());
+            frame.resize(header.size() + size);
+            if (size > 0 && !receiveAll(*direction.from, frame.data() + header.size(), size))
+            {
+                break;
+            }
+
+            auto type = static_cast<messages::Type>(header[0]);
+            std::lock_guard<std::mutex> lock(direction.mutexPending);
+            auto delivery = direction.impairment.schedule(type, frame.size(), std::chrono::steady_clock::now());
+            if (!delivery.has_value())
+            {
+                direction.dropped++;
+                continue;
+            }
+            direction.pending.push({delivery.value(), direction.nextSequence++, std::move(frame)});
+            direction.eventPending.notify_one();
+        }
+        closeConnection(connection);
+    });
+
+    direction.threadWriter = std::thread([this, &connection, &direction]() {
+        std::unique_lock<std::mutex> lock(direction.mutexPending);
+        while (connection.open)
+        {
+            if (direction.pending.empty())
+            {
+                direction.eventPending.wait(lock);
+                continue;
+            }
+
+            auto delivery = direction.pending.top().delivery;
+            if (std::chrono::steady_clock::now() < delivery)
+            {
+                direction.eventPending.wait_until(lock, delivery);
+                continue;
+            }
+
+            auto frame = std::move(const_cast<Direction::Pending&>(direction.pending.top()).frame);
+            direction.pending.pop();
+            lock.unlock();
+            auto sent = direction.to->send(frame.data(), frame.size()) == sf::Socket::Done;
+            lock.lock();
+            if (!sent)
+            {
+                lock.unlock();
+                closeConnection(connection);
+                lock.lock();
+                break;
+            }
+            direction.messages++;
+            direction.bytes += frame.size();
+        }
+    });
+}
+
+// --------------------------------------------------------------
+//
+// Readers notice within a second of selector waiting, notifying
+// wakes up the writers.  The sockets are closed once all the threads
+// are done with them.
+//
+// --------------------------------------------------------------
+void NetProxy::closeConnection(Connection& connection)
+{
+    connection.open = false;
+    for (auto direction : {connection.toServer.get(), connection.toClient.get()})
+    {
+        std::lock_guard<std::mutex> lock(direction->mutexPending);
+        direction->eventPending.notify_all();
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Joins the threads of closed connections and reports what went
+// through them.
+//
+// --------------------------------------------------------------
+void NetProxy::removeClosed()
+{
+    for (auto connection = m_connections.begin(); connection != m_connections.end();)
+    {
+        if ((*connection)->open)
+        {
+            ++connection;
+            continue;
+        }
+
+        std::cout << "Connection " << (*connection)->id << " closed" << std::endl;
+        for (auto direction : {(*connection)->toServer.get(), (*connection)->toClient.get()})
+        {
+            direction->threadReader.join();
+            direction->threadWriter.join();
+            std::cout << "    " << direction->name << ": " << direction->messages << " messages, " << direction->bytes << " bytes, " << direction->dropped << " dropped" << std::endl;
+        }
+        connection = m_connections.erase(connection);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Impairment.hpp"
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// A TCP proxy that sits between clients and the server and makes the
+// connection behave like a real network.  Each client connection gets
+// its own connection to the server.  The bytes going each way are
+// split into [type | size | payload] messages, and each message is
+// held until the direction's Impairment says it is delivered.
+//
+// Each direction of each connection has a reader thread, pulling
+// messages off one socket and scheduling them, and a writer thread,
+// sending them on to the other socket when their time comes.
+//
+// --------------------------------------------------------------
+class NetProxy
+{
+  public:
+    bool initialize(std::uint16_t listenPort, std::string serverAddress, std::uint16_t serverPort, Impairment::Settings toServer, Impairment::Settings toClient, std::uint64_t seed);
+    void run();
+    void shutdown();
+
+  private:
+    // --------------------------------------------------------------
+    //
+    // One way through a proxied connection.
+    //
+    // --------------------------------------------------------------
+    struct Direction
+    {
+        Direction(std::string name, Impairment::Settings settings, std::uint64_t seed) :
+            name(name),
+            impairment(settings, seed)
+        {
+        }
+
+        struct Pending
+        {
+            std::chrono::steady_clock::time_point delivery;
+            std::uint64_t sequence;
+            std::string frame;
+
+            bool operator>(const Pending& rhs) const { return delivery > rhs.delivery || (delivery == rhs.delivery && sequence > rhs.sequence); }
+        };
+
+        std::string name;
+        Impairment impairment;
+        sf::TcpSocket* from{nullptr};
+        sf::TcpSocket* to{nullptr};
+        std::thread threadReader;
+        std::thread threadWriter;
+
+        std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+        std::uint64_t nextSequence{0};
+        std::mutex mutexPending;
+        std::condition_variable eventPending;
+
+        std::uint64_t messages{0};
+        std::uint64_t bytes{0};
+        std::uint64_t dropped{0};
+    };
+
+    struct Connection
+    {
+        std::uint64_t id{0};
+        std::unique_ptr<sf::TcpSocket> client;
+        std::unique_ptr<sf::TcpSocket> server;
+        std::unique_ptr<Direction> toServer;
+        std::unique_ptr<Direction> toClient;
+        std::atomic<bool> open{true};
+    };
+
+    std::atomic<bool> m_keepRunning{true};
+    sf::TcpListener m_listener;
+    std::string m_serverAddress;
+    std::uint16_t m_serverPort{0};
+    Impairment::Settings m_toServer;
+    Impairment::Settings m_toClient;
+    std::uint64_t m_seed{0};
+    std::uint64_t m_nextConnectionId{0};
+    std::vector<std::unique_ptr<Connection>> m_connections;
+
+    void addConnection(std::unique_ptr<sf::TcpSocket> client);
+    void startDirection(Connection& connection, Direction& direction);
+    void closeConnection(Connection& connection);
+    void removeClosed();
+};
@@ -0,0 +1,150 @@
+#include "NetProxy.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// --------------------------------------------------------------
+//
+// Usage: NetProxy [options]
+//
+//  --listen <port>          port clients connect to (default 3001)
+//  --server <address>       server address (default 127.0.0.1)
+//  --server-port <port>     server port (default 3000)
+//  --seed <n>               seed for all random decisions (default 1)
+//
+// Impairments, each applies to both directions, or to one direction
+// when prefixed with --up- (client to server) or --down- (server to
+// client), e.g. --latency 50 --down-jitter 10
+//
+//  --latency <ms>           one way delay
+//  --jitter <ms>            +/- random variation on the delay
+//  --bandwidth <bytes/s>    link capacity, 0 for unlimited
+//  --reorder <0..1>         chance a message is held back and overtaken
+//  --reorder-delay <ms>     how long a reordered message is held back
+//  --loss <0..1>            chance an unreliable message is dropped
+//
+// --------------------------------------------------------------
+
+void usage()
+{
+    std::cout << "Usage: NetProxy [--listen port] [--server address] [--server-port port] [--seed n]" << std::endl;
+    std::cout << "                [--[up-|down-]latency ms] [--[up-|down-]jitter ms] [--[up-|down-]bandwidth bytes/s]" << std::endl;
+    std::cout << "                [--[up-|down-]reorder 0..1] [--[up-|down-]reorder-delay ms] [--[up-|down-]loss 0..1]" << std::endl;
+}
+
+bool setImpairment(Impairment::Settings& settings, const std::string& name, const std::string& value)
+{
+    if (name == "latency")
+    {
+        settings.latency = std::chrono::milliseconds(std::stoll(value));
+    }
+    else if (name == "jitter")
+    {
+        settings.jitter = std::chrono::milliseconds(std::stoll(value));
+    }
+    else if (name == "bandwidth")
+    {
+        settings.bandwidth = std::stoull(value);
+    }
+    else if (name == "reorder")
+    {
+        settings.reorder = std::stod(value);
+    }
+    else if (name == "reorder-delay")
+    {
+        settings.reorderDelay = std::chrono::milliseconds(std::stoll(value));
+    }
+    else if (name == "loss")
+    {
+        settings.loss = std::stod(value);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::uint16_t listenPort = 3001;
+    std::string serverAddress = "127.0.0.1";
+    std::uint16_t serverPort = 3000;
+    std::uint64_t seed = 1;
+    Impairment::Settings toServer;
+    Impairment::Settings toClient;
+
+    for (int arg = 1; arg < argc; arg++)
+    {
+        std::string option = argv[arg];
+        if (option.rfind("--", 0) != 0 || arg + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        option = option.substr(2);
+        std::string value = argv[++arg];
+
+        try
+        {
+            if (option == "listen")
+            {
+                listenPort = static_cast<std::uint16_t>(std::stoul(value));
+            }
+            else if (option == "server")
+            {
+                serverAddress = value;
+            }
+            else if (option == "server-port")
+            {
+                serverPort = static_cast<std::uint16_t>(std::stoul(value));
+            }
+            else if (option == "seed")
+            {
+                seed = std::stoull(value);
+            }
+            else if (option.rfind("up-", 0) == 0)
+            {
+                if (!setImpairment(toServer, option.substr(3), value))
+                {
+                    usage();
+                    return 1;
+                }
+            }
+            else if (option.rfind("down-", 0) == 0)
+            {
+                if (!setImpairment(toClient, option.substr(5), value))
+                {
+                    usage();
+                    return 1;
+                }
+            }
+            else if (!setImpairment(toServer, option, value) || !setImpairment(toClient, option, value))
+            {
+                usage();
+                return 1;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cout << "Invalid value for --" << option << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    NetProxy proxy;
+    if (!proxy.initialize(listenPort, serverAddress, serverPort, toServer, toClient, seed))
+    {
+        std::cout << "Failed to initialize the proxy, terminating..." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Proxying port " << listenPort << " to " << serverAddress << ":" << serverPort << " (seed " << seed << ")" << std::endl;
+    proxy.run();
+    proxy.shutdown();
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "GameModel.hpp"
+#include "MessageQueueServer.hpp"
+#include "TrafficLog.hpp"
+#include "misc/Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <google/protobuf/stubs/common.h>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Usage: Replay <traffic log> [--csv <file>]
+//
+// Runs a traffic log recorded by the server (Server --record <file>)
+// back through the server's GameModel, as fast as it will go and
+// without any sockets.  Each update gets the same elapsed time, and
+// the same connects, disconnects and messages, as it did when it was
+// recorded.  Reports how long the updates took, optionally writing
+// the time of every update to a CSV file.
+//
+// With the profiler compiled in (the PROFILER CMake option), the
+// timings of the whole replay are written to replay.trace.json.
+//
+// --------------------------------------------------------------
+const std::string TRACE_FILE = "replay.trace.json";
+
+int main(int argc, char* argv[])
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    if (argc != 2 && !(argc == 4 && std::string(argv[2]) == "--csv"))
+    {
+        std::cout << "Usage: Replay <traffic log> [--csv <file>]" << std::endl;
+        return 1;
+    }
+
+    traffic::Reader reader;
+    if (!reader.open(argv[1]))
+    {
+        return 1;
+    }
+
+    MessageQueueServer::instance().initializeReplay();
+    GameModel model;
+    if (!model.initialize(false))
+    {
+        std::cout << "Failed to initialize the game model" << std::endl;
+        return 1;
+    }
+
+    //
+    // The log's times are relative to the start of the recording, the
+    // replay's clock starts now.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::chrono::nanoseconds> updateTimes;
+    std::uint64_t messageCount = 0;
+
+    //
+    // The messages following a Tick belong to it, so each update is run
+    // when the next Tick (or the end of the log) is reached.
+    std::optional<traffic::Record> tick;
+    auto runTick = [&]() {
+        if (tick)
+        {
+            auto before = std::chrono::steady_clock::now();
+            model.update(tick->elapsedTime, start + tick->time);
+            updateTimes.push_back(std::chrono::steady_clock::now() - before);
+        }
+    };
+
+    while (auto record = reader.next())
+    {
+        switch (record->kind)
+        {
+            case traffic::Kind::Tick:
+                runTick();
+                tick = record;
+                break;
+            case traffic::Kind::Connect:
+                MessageQueueServer::instance().replayConnect(record->clientId);
+                break;
+            case traffic::Kind::Disconnect:
+                MessageQueueServer::instance().replayDisconnect(record->clientId);
+                break;
+            case traffic::Kind::Message:
+                MessageQueueServer::instance().replayMessage(record->clientId, start + record->time, record->type, record->data);
+                messageCount++;
+                break;
+        }
+    }
+    runTick();
+    model.shutdown();
+    profiler::Profiler::instance().writeTrace(TRACE_FILE);
+
+    if (updateTimes.empty())
+    {
+        std::cout << "No updates in the traffic log" << std::endl;
+        return 0;
+    }
+
+    if (argc == 4)
+    {
+        std::ofstream csv(argv[3]);
+        csv << "update,microseconds" << std::endl;
+        for (std::size_t update = 0; update < updateTimes.size(); update++)
+        {
+            csv << update << "," << std::chrono::duration<double, std::micro>(updateTimes[update]).count() << std::endl;
+        }
+    }
+
+    auto total = std::chrono::nanoseconds(0);
+    for (auto time : updateTimes)
+    {
+        total += time;
+    }
+    auto sorted = updateTimes;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        return std::chrono::duration<double, std::micro>(sorted[static_cast<std::size_t>(p * (sorted.size() - 1))]).count();
+    };
+
+    std::cout << "Updates:   " << updateTimes.size() << std::endl;
+    std::cout << "Messages:  " << messageCount << std::endl;
+    std::cout << "Sent:      " << MessageQueueServer::instance().getReplayBytesSent() << " bytes" << std::endl;
+    std::cout << "Total:     " << std::chrono::duration<double, std::milli>(total).count() << " ms" << std::endl;
+    std::cout << "Mean:      " << std::chrono::duration<double, std::micro>(total).count() / updateTimes.size() << " us" << std::endl;
+    std::cout << "Median:    " << percentile(0.5) << " us" << std::endl;
+    std::cout << "99th:      " << percentile(0.99) << " us" << std::endl;
+    std::cout << "Max:       " << percentile(1.0) << " us" << std::endl;
+
+    google::protobuf::ShutdownProtobufLibrary();
+
+    return 0;
+}
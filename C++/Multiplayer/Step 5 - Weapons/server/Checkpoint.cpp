@@ -0,0 +1,790 @@
+#include "Checkpoint.hpp"
+
+#include "components/AnimatedAppearance.hpp"
+#include "components/Appearance.hpp"
+#include "components/Health.hpp"
+#include "components/Input.hpp"
+#include "components/Lifetime.hpp"
+#include "components/Momentum.hpp"
+#include "components/Movement.hpp"
+#include "components/Position.hpp"
+#include "components/Size.hpp"
+#include "components/Weapon.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+    #if !defined(NOMINMAX)
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    const std::uint32_t CHECKPOINT_MAGIC = 0x544b4843; // "CHKT"
+    const std::uint32_t CHECKPOINT_VERSION = 2;
+    const std::size_t CHECKPOINT_MIN_CAPACITY = 64 * 1024;
+
+    struct SlotHeader
+    {
+        std::uint64_t sequence;
+        std::uint64_t size;
+        std::uint64_t checksum;
+    };
+
+    struct FileHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t headerSize; // slot 0 starts here, it is a multiple of the page size
+        std::uint64_t capacity;   // size of each slot, also a multiple of the page size
+        std::array<SlotHeader, 2> slots;
+    };
+
+    //
+    // Which components are present on an entity, the components follow
+    // the entity id in the order of these bits.
+    enum ComponentBits : std::uint16_t
+    {
+        PositionBit = 1 << 0,
+        SizeBit = 1 << 1,
+        MovementBit = 1 << 2,
+        MomentumBit = 1 << 3,
+        HealthBit = 1 << 4,
+        LifetimeBit = 1 << 5,
+        WeaponBit = 1 << 6,
+        InputBit = 1 << 7,
+        AppearanceBit = 1 << 8,
+        AnimatedAppearanceBit = 1 << 9
+    };
+
+    // --------------------------------------------------------------
+    //
+    // 64 bit FNV-1a hash, used to detect a slot that was only partially
+    // written.
+    //
+    // --------------------------------------------------------------
+    std::uint64_t checksum(const char* data, std::size_t size)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (std::size_t index = 0; index < size; index++)
+        {
+            hash ^= static_cast<std::uint8_t>(data[index]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void append(std::string& image, T value)
+    {
+        image.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void appendString(std::string& image, const std::string& value)
+    {
+        append(image, static_cast<std::uint16_t>(value.size()));
+        image.append(value);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Reads values back out of an image, failing (rather than reading
+    // past the end) if the image is shorter than expected.
+    //
+    // --------------------------------------------------------------
+    class Reader
+    {
+      public:
+        Reader(const char* data, std::size_t size) :
+            m_data(data),
+            m_size(size)
+        {
+        }
+
+        template <typename T>
+        bool read(T& value)
+        {
+            if (m_offset + sizeof(T) > m_size)
+            {
+                return false;
+            }
+            std::memcpy(&value, m_data + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string& value)
+        {
+            std::uint16_t length;
+            if (!read(length) || m_offset + length > m_size)
+            {
+                return false;
+            }
+            value.assign(m_data + m_offset, length);
+            m_offset += length;
+            return true;
+        }
+
+      private:
+        const char* m_data;
+        std::size_t m_size;
+        std::size_t m_offset{0};
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Image layout: next entity id, player count, each player id and
+    // resume token, entity count, then each entity as its id, component
+    // bits and components.
+    //
+    // --------------------------------------------------------------
+    void encode(std::string& image, const entities::EntityMap& entities, const Checkpoint::PlayerTokens& players, entities::Entity::IdType nextId)
+    {
+        image.clear();
+        append(image, nextId);
+        append(image, static_cast<std::uint32_t>(players.size()));
+        for (auto& [playerId, token] : players)
+        {
+            append(image, playerId);
+            append(image, token);
+        }
+
+        append(image, static_cast<std::uint32_t>(entities.size()));
+        for (auto& [entityId, entity] : entities)
+        {
+            std::uint16_t bits = 0;
+            bits |= entity->hasComponent<components::Position>() ? PositionBit : 0;
+            bits |= entity->hasComponent<components::Size>() ? SizeBit : 0;
+            bits |= entity->hasComponent<components::Movement>() ? MovementBit : 0;
+            bits |= entity->hasComponent<components::Momentum>() ? MomentumBit : 0;
+            bits |= entity->hasComponent<components::Health>() ? HealthBit : 0;
+            bits |= entity->hasComponent<components::Lifetime>() ? LifetimeBit : 0;
+            bits |= entity->hasComponent<components::Weapon>() ? WeaponBit : 0;
+            bits |= entity->hasComponent<components::Input>() ? InputBit : 0;
+            bits |= entity->hasComponent<components::Appearance>() ? AppearanceBit : 0;
+            bits |= entity->hasComponent<components::AnimatedAppearance>() ? AnimatedAppearanceBit : 0;
+
+            append(image, entityId);
+            append(image, bits);
+            if (bits & PositionBit)
+            {
+                auto position = entity->getComponent<components::Position>();
+                append(image, position->get().x);
+                append(image, position->get().y);
+                append(image, position->getOrientation());
+            }
+            if (bits & SizeBit)
+            {
+                append(image, entity->getComponent<components::Size>()->get().x);
+                append(image, entity->getComponent<components::Size>()->get().y);
+            }
+            if (bits & MovementBit)
+            {
+                append(image, entity->getComponent<components::Movement>()->getThrustRate());
+                append(image, entity->getComponent<components::Movement>()->getRotateRate());
+            }
+            if (bits & MomentumBit)
+            {
+                append(image, entity->getComponent<components::Momentum>()->get().x);
+                append(image, entity->getComponent<components::Momentum>()->get().y);
+            }
+            if (bits & HealthBit)
+            {
+                append(image, entity->getComponent<components::Health>()->get());
+            }
+            if (bits & LifetimeBit)
+            {
+                append(image, static_cast<std::int64_t>(entity->getComponent<components::Lifetime>()->get().count()));
+            }
+            if (bits & WeaponBit)
+            {
+                append(image, entity->getComponent<components::Weapon>()->getDamage());
+                append(image, entity->getComponent<components::Weapon>()->getOwnerId());
+            }
+            if (bits & InputBit)
+            {
+                auto input = entity->getComponent<components::Input>();
+                append(image, static_cast<std::uint8_t>(input->getInputs().size()));
+                for (auto& [type, time] : input->getInputs())
+                {
+                    append(image, type);
+                    append(image, static_cast<std::int64_t>(time.count()));
+                    append(image, static_cast<std::int64_t>(input->getLimit(type).count()));
+                }
+            }
+            if (bits & AppearanceBit)
+            {
+                appendString(image, entity->getComponent<components::Appearance>()->getTexture());
+            }
+            if (bits & AnimatedAppearanceBit)
+            {
+                auto appearance = entity->getComponent<components::AnimatedAppearance>();
+                appendString(image, appearance->getTexture());
+                append(image, static_cast<std::uint16_t>(appearance->getSpriteTime().size()));
+                for (auto time : appearance->getSpriteTime())
+                {
+                    append(image, static_cast<std::int64_t>(time.count()));
+                }
+            }
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Rebuilds the entities from an image created by encode.
+    //
+    // --------------------------------------------------------------
+    bool decode(const char* data, std::size_t size, entities::EntityMap& entities, Checkpoint::PlayerTokens& players, entities::Entity::IdType& nextId)
+    {
+        Reader reader(data, size);
+
+        std::uint32_t playerCount;
+        if (!reader.read(nextId) || !reader.read(playerCount))
+        {
+            return false;
+        }
+        for (std::uint32_t player = 0; player < playerCount; player++)
+        {
+            entities::Entity::IdType playerId;
+            std::uint64_t token;
+            if (!reader.read(playerId) || !reader.read(token))
+            {
+                return false;
+            }
+            players[playerId] = token;
+        }
+
+        std::uint32_t entityCount;
+        if (!reader.read(entityCount))
+        {
+            return false;
+        }
+        for (std::uint32_t index = 0; index < entityCount; index++)
+        {
+            entities::Entity::IdType entityId;
+            std::uint16_t bits;
+            if (!reader.read(entityId) || !reader.read(bits))
+            {
+                return false;
+            }
+            auto entity = std::make_shared<entities::Entity>(entityId);
+
+            if (bits & PositionBit)
+            {
+                math::Vector2f position;
+                float orientation;
+                if (!reader.read(position.x) || !reader.read(position.y) || !reader.read(orientation))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Position>(position, orientation));
+            }
+            if (bits & SizeBit)
+            {
+                math::Vector2f size;
+                if (!reader.read(size.x) || !reader.read(size.y))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Size>(size));
+            }
+            if (bits & MovementBit)
+            {
+                float thrustRate;
+                float rotateRate;
+                if (!reader.read(thrustRate) || !reader.read(rotateRate))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Movement>(thrustRate, rotateRate));
+            }
+            if (bits & MomentumBit)
+            {
+                math::Vector2f momentum;
+                if (!reader.read(momentum.x) || !reader.read(momentum.y))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Momentum>(momentum));
+            }
+            if (bits & HealthBit)
+            {
+                float health;
+                if (!reader.read(health))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Health>(health));
+            }
+            if (bits & LifetimeBit)
+            {
+                std::int64_t howLong;
+                if (!reader.read(howLong))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Lifetime>(std::chrono::microseconds(howLong)));
+            }
+            if (bits & WeaponBit)
+            {
+                float damage;
+                entities::Entity::IdType ownerId;
+                if (!reader.read(damage) || !reader.read(ownerId))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Weapon>(damage, ownerId));
+            }
+            if (bits & InputBit)
+            {
+                std::uint8_t count;
+                if (!reader.read(count))
+                {
+                    return false;
+                }
+                std::vector<std::pair<components::Input::Type, std::chrono::microseconds>> inputs;
+                std::vector<std::chrono::microseconds> limits;
+                for (std::uint8_t input = 0; input < count; input++)
+                {
+                    components::Input::Type type;
+                    std::int64_t time;
+                    std::int64_t limit;
+                    if (!reader.read(type) || !reader.read(time) || !reader.read(limit))
+                    {
+                        return false;
+                    }
+                    inputs.push_back({type, std::chrono::microseconds(time)});
+                    limits.push_back(std::chrono::microseconds(limit));
+                }
+                auto component = std::make_unique<components::Input>(inputs);
+                for (std::size_t input = 0; input < inputs.size(); input++)
+                {
+                    component->setLimit(inputs[input].first, limits[input]);
+                }
+                entity->addComponent(std::move(component));
+            }
+            if (bits & AppearanceBit)
+            {
+                std::string texture;
+                if (!reader.readString(texture))
+                {
+                    return false;
+                }
+                entity->addComponent(std::make_unique<components::Appearance>(texture));
+            }
+            if (bits & AnimatedAppearanceBit)
+            {
+                std::string texture;
+                std::uint16_t count;
+                if (!reader.readString(texture) || !reader.read(count))
+                {
+                    return false;
+                }
+                std::vector<std::chrono::milliseconds> spriteTime;
+                for (std::uint16_t sprite = 0; sprite < count; sprite++)
+                {
+                    std::int64_t time;
+                    if (!reader.read(time))
+                    {
+                        return false;
+                    }
+                    spriteTime.push_back(std::chrono::milliseconds(time));
+                }
+                entity->addComponent(std::make_unique<components::AnimatedAppearance>(texture, spriteTime));
+            }
+
+            entities[entityId] = entity;
+        }
+
+        return true;
+    }
+} // namespace
+
+// --------------------------------------------------------------
+//
+// A read/write, shared memory mapping of an entire file.
+//
+// --------------------------------------------------------------
+class Checkpoint::MappedFile
+{
+  public:
+    ~MappedFile() { close(); }
+
+    // --------------------------------------------------------------
+    //
+    // Maps the file at path.  When create is true the file is
+    // (re)created with the given size, otherwise the existing file
+    // is mapped at its current size.
+    //
+    // --------------------------------------------------------------
+    bool open(const std::string& path, std::size_t size, bool create)
+    {
+#if defined(_WIN32)
+        m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(size);
+        if (create && (!SetFilePointerEx(m_file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(m_file)))
+        {
+            close();
+            return false;
+        }
+        if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<std::size_t>(fileSize.QuadPart);
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        m_data = m_mapping ? static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0)) : nullptr;
+#else
+        m_file = ::open(path.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0644);
+        if (m_file < 0)
+        {
+            return false;
+        }
+        struct stat status;
+        if ((create && ::ftruncate(m_file, static_cast<off_t>(size)) != 0) || ::fstat(m_file, &status) != 0 || status.st_size == 0)
+        {
+            close();
+            return false;
+        }
+        m_size = static_cast<std::size_t>(status.st_size);
+        auto data = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+        m_data = data != MAP_FAILED ? static_cast<char*>(data) : nullptr;
+#endif
+        if (m_data == nullptr)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+#if defined(_WIN32)
+        if (m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_data != nullptr)
+        {
+            ::munmap(m_data, m_size);
+        }
+        if (m_file >= 0)
+        {
+            ::close(m_file);
+            m_file = -1;
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Blocks until the given range of the mapping is on disk.
+    //
+    // --------------------------------------------------------------
+    void sync(std::size_t offset, std::size_t length)
+    {
+#if defined(_WIN32)
+        FlushViewOfFile(m_data + offset, length);
+        FlushFileBuffers(m_file);
+#else
+        auto start = offset - offset % pageSize();
+        ::msync(m_data + start, length + (offset - start), MS_SYNC);
+#endif
+    }
+
+    char* data() { return m_data; }
+    std::size_t size() { return m_size; }
+
+    static std::size_t pageSize()
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwAllocationGranularity);
+#else
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+  private:
+#if defined(_WIN32)
+    HANDLE m_file{INVALID_HANDLE_VALUE};
+    HANDLE m_mapping{nullptr};
+#else
+    int m_file{-1};
+#endif
+    char* m_data{nullptr};
+    std::size_t m_size{0};
+};
+
+Checkpoint::Checkpoint()
+{
+}
+
+Checkpoint::~Checkpoint()
+{
+    shutdown();
+}
+
+// --------------------------------------------------------------
+//
+// Starts the writer thread, it waits for images handed to it by save.
+//
+// --------------------------------------------------------------
+bool Checkpoint::initialize(std::string path)
+{
+    m_path = path;
+
+    m_threadWriter = std::thread([this]() {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutexPending);
+            m_eventPending.wait(lock, [this]() { return m_hasPending || !m_keepRunning; });
+            if (!m_hasPending)
+            {
+                break;
+            }
+            std::swap(m_pending, m_writing);
+            m_hasPending = false;
+            lock.unlock();
+
+            write(m_writing);
+        }
+    });
+
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// Writes out any checkpoint still waiting, then stops the writer.
+//
+// --------------------------------------------------------------
+void Checkpoint::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPending);
+        m_keepRunning = false;
+    }
+    m_eventPending.notify_one();
+    if (m_threadWriter.joinable())
+    {
+        m_threadWriter.join();
+    }
+    m_file.reset();
+}
+
+// --------------------------------------------------------------
+//
+// Loads the newest intact checkpoint, if there is one.  The file
+// stays mapped so the following checkpoints can be written into it.
+//
+// --------------------------------------------------------------
+bool Checkpoint::load(entities::EntityMap& entities, PlayerTokens& players, entities::Entity::IdType& nextId)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(m_path, error))
+    {
+        return false;
+    }
+
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(m_path, 0, false) || file->size() < sizeof(FileHeader))
+    {
+        return false;
+    }
+
+    auto header = reinterpret_cast<FileHeader*>(file->data());
+    if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION ||
+        header->headerSize % MappedFile::pageSize() != 0 || header->capacity % MappedFile::pageSize() != 0 ||
+        file->size() < header->headerSize + 2 * header->capacity)
+    {
+        std::cout << "Ignoring checkpoint " << m_path << ", it isn't in a known format" << std::endl;
+        return false;
+    }
+
+    std::array<std::size_t, 2> order{0, 1};
+    if (header->slots[1].sequence > header->slots[0].sequence)
+    {
+        std::swap(order[0], order[1]);
+    }
+    for (auto slot : order)
+    {
+        auto& slotHeader = header->slots[slot];
+        if (slotHeader.sequence == 0 || slotHeader.size > header->capacity)
+        {
+            continue;
+        }
+        auto data = file->data() + header->headerSize + slot * header->capacity;
+        if (checksum(data, slotHeader.size) != slotHeader.checksum)
+        {
+            continue;
+        }
+
+        entities.clear();
+        players.clear();
+        if (decode(data, slotHeader.size, entities, players, nextId))
+        {
+            m_sequence = std::max(header->slots[0].sequence, header->slots[1].sequence);
+            m_activeSlot = slot;
+            m_file = std::move(file);
+            return true;
+        }
+    }
+
+    entities.clear();
+    players.clear();
+    return false;
+}
+
+// --------------------------------------------------------------
+//
+// Encodes the world and hands it to the writer thread.  If the writer
+// hasn't gotten to the previous checkpoint yet, it is replaced by this
+// one.
+//
+// --------------------------------------------------------------
+void Checkpoint::save(const entities::EntityMap& entities, const PlayerTokens& players, entities::Entity::IdType nextId)
+{
+    encode(m_image, entities, players, nextId);
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPending);
+        std::swap(m_image, m_pending);
+        m_hasPending = true;
+    }
+    m_eventPending.notify_one();
+}
+
+// --------------------------------------------------------------
+//
+// Writes the image into the slot not holding the latest checkpoint.
+// The slot still holds the checkpoint before that one, so only the
+// pages that have changed since then are copied and flushed.  The
+// header is flushed last, only then does the slot become the latest.
+//
+// --------------------------------------------------------------
+void Checkpoint::write(const std::string& image)
+{
+    if (m_file == nullptr || image.size() > reinterpret_cast<FileHeader*>(m_file->data())->capacity)
+    {
+        rebuild(image);
+        return;
+    }
+
+    auto header = reinterpret_cast<FileHeader*>(m_file->data());
+    auto slot = 1 - m_activeSlot;
+    auto base = header->headerSize + slot * header->capacity;
+    auto page = MappedFile::pageSize();
+
+    std::size_t dirtyBegin = 0;
+    std::size_t dirtyEnd = 0;
+    for (std::size_t offset = 0; offset < image.size(); offset += page)
+    {
+        auto length = std::min(page, image.size() - offset);
+        auto destination = m_file->data() + base + offset;
+        if (std::memcmp(destination, image.data() + offset, length) != 0)
+        {
+            std::memcpy(destination, image.data() + offset, length);
+            if (dirtyEnd != offset)
+            {
+                if (dirtyEnd > dirtyBegin)
+                {
+                    m_file->sync(base + dirtyBegin, dirtyEnd - dirtyBegin);
+                }
+                dirtyBegin = offset;
+            }
+            dirtyEnd = offset + length;
+        }
+    }
+    if (dirtyEnd > dirtyBegin)
+    {
+        m_file->sync(base + dirtyBegin, dirtyEnd - dirtyBegin);
+    }
+
+    header->slots[slot] = {++m_sequence, image.size(), checksum(image.data(), image.size())};
+    m_file->sync(0, sizeof(FileHeader));
+    m_activeSlot = slot;
+}
+
+// --------------------------------------------------------------
+//
+// The image doesn't fit (or there is no file yet), so a new, larger
+// file is written next to the old one and then renamed over it.
+//
+// --------------------------------------------------------------
+void Checkpoint::rebuild(const std::string& image)
+{
+    auto page = MappedFile::pageSize();
+    auto capacity = std::max(image.size() * 2, CHECKPOINT_MIN_CAPACITY);
+    capacity = (capacity + page - 1) / page * page;
+
+    m_file.reset();
+    auto temporary = m_path + ".tmp";
+    {
+        MappedFile file;
+        if (!file.open(temporary, page + 2 * capacity, true))
+        {
+            std::cout << "Failed to create checkpoint " << temporary << std::endl;
+            return;
+        }
+
+        auto header = reinterpret_cast<FileHeader*>(file.data());
+        header->magic = CHECKPOINT_MAGIC;
+        header->version = CHECKPOINT_VERSION;
+        header->headerSize = page;
+        header->capacity = capacity;
+        header->slots[0] = {++m_sequence, image.size(), checksum(image.data(), image.size())};
+        header->slots[1] = {0, 0, 0};
+        std::memcpy(file.data() + page, image.data(), image.size());
+        file.sync(0, file.size());
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, m_path, error);
+    if (error)
+    {
+        std::cout << "Failed to replace checkpoint " << m_path << ": " << error.message() << std::endl;
+        return;
+    }
+
+    m_activeSlot = 0;
+    m_file = std::make_unique<MappedFile>();
+    if (!m_file->open(m_path, 0, false))
+    {
+        m_file.reset();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "entities/Entity.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// --------------------------------------------------------------
+//
+// Persists the server's world to a memory-mapped file so a restarted
+// server can pick up where it left off.
+//
+// The file holds two slots, each a flat binary image of every entity,
+// its components, and the player entities with their resume tokens.  Checkpoints
+// alternate between the slots, so the previous checkpoint is always
+// intact if the server dies mid-write.  Each slot has a sequence
+// number and checksum in the file header, loading picks the newest
+// slot that checks out.
+//
+// Encoding the image is done on the game thread (it is a flat copy),
+// writing it is done on a background thread.  Only the pages of the
+// slot that differ from the new image are written and flushed.
+//
+// --------------------------------------------------------------
+class Checkpoint
+{
+  public:
+    //
+    // Player entity ids and the token their clients need to resume them
+    using PlayerTokens = std::unordered_map<entities::Entity::IdType, std::uint64_t>;
+
+    Checkpoint();
+    ~Checkpoint();
+
+    bool initialize(std::string path);
+    void shutdown();
+
+    bool load(entities::EntityMap& entities, PlayerTokens& players, entities::Entity::IdType& nextId);
+    void save(const entities::EntityMap& entities, const PlayerTokens& players, entities::Entity::IdType nextId);
+
+  private:
+    class MappedFile;
+
+    std::string m_path;
+    std::unique_ptr<MappedFile> m_file;
+    std::uint64_t m_sequence{0};
+    std::size_t m_activeSlot{1};
+
+    bool m_keepRunning{true};
+    std::thread m_threadWriter;
+    std::string m_image;   // used by the game thread to encode the world
+    std::string m_pending; // waiting to be written
+    std::string m_writing; // being written by the writer thread
+    bool m_hasPending{false};
+    std::condition_variable m_eventPending;
+    std::mutex m_mutexPending;
+
+    void write(const std::string& image);
+    void rebuild(const std::string& image);
+};
@@ -9,13 +9,42 @@
 #include "components/Size.hpp"
 #include "entities/Create.hpp"
 #include "messages/ConnectAck.hpp"
+#include "messages/JoinAck.hpp"
 #include "messages/NewEntity.hpp"
 #include "messages/RemoveEntity.hpp"
 #include "messages/Utility.hpp"
+#include "misc/GameClock.hpp"
+#include "misc/Profiler.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <iostream>
 #include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Late-joining clients receive the world in chunks of (roughly) this many bytes,
+// with only a few chunks per client sent each update so a join doesn't flood
+// the sender thread and delay updates to everyone else.
+const std::size_t WORLD_STATE_CHUNK_SIZE = 16 * 1024;
+const std::size_t WORLD_STATE_CHUNKS_PER_UPDATE = 4;
+
+//
+// The world is checkpointed this often, so a restarted server can resume the
+// match.  Players from the checkpoint are kept around for a while to give their
+// clients a chance to rejoin.
+const std::string CHECKPOINT_FILE = "server.checkpoint";
+const auto CHECKPOINT_INTERVAL = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(1));
+const auto PLAYER_RESUME_WINDOW = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(30));
+
+//
+// Every texture an entity can be given, sent to clients as they connect so they
+// can load them before the first entity using one arrives.  These are the
+// textures the entity factories and prefabs use.
+const std::vector<std::string> ASSET_MANIFEST = {entities::player::TEXTURE_OWN, entities::player::TEXTURE_OTHER, entities::missile::TEXTURE, entities::explosion::TEXTURE};
 
 // --------------------------------------------------------------
 //
@@ -24,43 +53,79 @@
 // updates are sent out.
 //
 // --------------------------------------------------------------
-void GameModel::update(const std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now)
+void GameModel::update(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now)
 {
+    MessageQueueServer::instance().recordTick(elapsedTime, now);
+    metrics::Timer timer(m_metricUpdate);
+    PROFILE_SCOPE("GameModel::update");
+
     //
-    // Add any new entities we've been notified about
-    for (auto&& entity : m_newEntities)
-    {
-        addEntity(entity);
-    }
-    m_newEntities.clear();
+    // Any world state encoded during the last update is now out of date
+    m_worldStateSnapshot.reset();
 
     //
-    // Remove any entites we've been notified to get rid of first
-    for (auto&& id : m_removeEntities)
-    {
-        removeEntity(id);
-    }
-    m_removeEntities.clear();
+    // Clients that came and went since the last update, the players of those
+    // that left are removed along with the other structural changes.  The
+    // messages are taken first: a client's connect is always queued before
+    // its first message, so none of them are from a client not yet known.
+    auto messages = MessageQueueServer::instance().getMessages();
+    applyConnectionEvents();
+
+    //
+    // Make the structural changes recorded since the last update, by the
+    // game model and by the systems, before any system runs
+    applyCommands();
+    GameClock::instance().advance(elapsedTime);
 
     //
     // Then, process the network system before anything else, it is like local input, so should
     // be processed early.
     // Note: It now has to be processed before movement in order to correctly
     //       match the order of KeyboardInput before movement on the client.
-    m_systemNetwork->update(elapsedTime, now, MessageQueueServer::instance().getMessages());
+    {
+        metrics::Timer timerSystem(m_metricNetworkUpdate);
+        m_systemNetwork->update(elapsedTime, now, std::move(messages));
+    }
+    {
+        metrics::Timer timerSystem(m_metricMomentumUpdate);
+        m_systemMomentum->update(elapsedTime, now);
+    }
+    {
+        metrics::Timer timerSystem(m_metricLifetimeUpdate);
+        m_systemLifetime->update(elapsedTime, now);
+    }
+    {
+        metrics::Timer timerSystem(m_metricDamageUpdate);
+        m_systemDamage->update(elapsedTime, now);
+    }
+    m_metricNetworkEntities.set(m_systemNetwork->getEntityCount());
+    m_metricMomentumEntities.set(m_systemMomentum->getEntityCount());
+    m_metricLifetimeEntities.set(m_systemLifetime->getEntityCount());
+    m_metricDamageEntities.set(m_systemDamage->getEntityCount());
+    m_metricEntities.set(m_entities.size());
+    m_metricClients.set(m_clients.size());
 
-    m_systemMomentum->update(elapsedTime, now);
-    m_systemLifetime->update(elapsedTime, now);
-    m_systemDamage->update(elapsedTime, now);
+    //
+    // Continue sending the world state to any clients that recently joined
+    streamWorldState();
+
+    MessageQueueServer::instance().flush();
+
+    expireResumablePlayers(elapsedTime);
+    saveCheckpoint(elapsedTime);
 }
 
 // --------------------------------------------------------------
 //
-// Setup notifications for when new clients connect.
+// Setup notifications for when new clients connect.  Replays don't
+// use the checkpoint, they start from an empty world like the server
+// they were recorded from.
 //
 // --------------------------------------------------------------
-bool GameModel::initialize()
+bool GameModel::initialize(bool useCheckpoint)
 {
+    m_useCheckpoint = useCheckpoint;
+
     //
     // TODO: Super dangerous, I know.  I'll eventually find a better solution that
     // doesn't require creating guids;
@@ -69,16 +134,24 @@ bool GameModel::initialize()
     //
     // Initialize the various systems
     m_systemNetwork = std::make_unique<systems::Network>();
-    m_systemNetwork->registerNewEntityHandler(std::bind(&GameModel::handleNewEntity, this, std::placeholders::_1));
-    m_systemNetwork->registerJoinHandler(std::bind(&GameModel::handleJoin, this, std::placeholders::_1));
+    m_systemNetwork->registerJoinHandler(std::bind(&GameModel::handleJoin, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 
     m_systemMomentum = std::make_unique<systems::Momentum>();
-    m_systemLifetime = std::make_unique<systems::Lifetime>(std::bind(&GameModel::handleRemoveEntity, this, std::placeholders::_1));
+    m_systemLifetime = std::make_unique<systems::Lifetime>();
     m_systemDamage = std::make_unique<systems::Damage>();
-    m_systemDamage->registerRemoveEntityHandler(std::bind(&GameModel::handleRemoveEntity, this, std::placeholders::_1));
 
-    MessageQueueServer::instance().registerConnectHandler(std::bind(&GameModel::handleConnect, this, std::placeholders::_1));
-    MessageQueueServer::instance().registerDisconnectHandler(std::bind(&GameModel::handleDisconnect, this, std::placeholders::_1));
+    //
+    // These are called on the network threads, the events are handled in the next update
+    MessageQueueServer::instance().registerConnectHandler([this](std::uint64_t clientId) { m_connectionEvents.enqueue({ConnectionEvent::Connected, clientId}); });
+    MessageQueueServer::instance().registerDisconnectHandler([this](std::uint64_t clientId) { m_connectionEvents.enqueue({ConnectionEvent::Disconnected, clientId}); });
+
+    //
+    // Pick up where the last server left off, if it left a checkpoint
+    if (m_useCheckpoint)
+    {
+        m_checkpoint.initialize(CHECKPOINT_FILE);
+        loadCheckpoint();
+    }
 
     return true;
 }
@@ -90,6 +163,148 @@ bool GameModel::initialize()
 // --------------------------------------------------------------
 void GameModel::shutdown()
 {
+    m_checkpoint.shutdown();
+}
+
+// --------------------------------------------------------------
+//
+// Restores the entities from the last checkpoint.  The player entities
+// don't have clients yet, they wait for them to rejoin.
+//
+// --------------------------------------------------------------
+void GameModel::loadCheckpoint()
+{
+    entities::EntityMap entities;
+    Checkpoint::PlayerTokens players;
+    entities::Entity::IdType nextId;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!m_checkpoint.load(entities, players, nextId))
+    {
+        return;
+    }
+
+    for (auto& [entityId, entity] : entities)
+    {
+        (void)entityId; // unused
+        m_commands.spawn(entity);
+    }
+    applyCommands();
+    for (auto& [playerId, resumeToken] : players)
+    {
+        if (m_entities.find(playerId) != m_entities.end())
+        {
+            m_resumablePlayers[playerId] = {PLAYER_RESUME_WINDOW, resumeToken};
+        }
+    }
+    entities::Entity::nextId = std::max(entities::Entity::nextId.load(), nextId);
+
+    auto howLong = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "Loaded " << entities.size() << " entities from checkpoint in " << howLong.count() << " us" << std::endl;
+}
+
+// --------------------------------------------------------------
+//
+// Hands a copy of the world to the checkpoint writer every so often.
+// The player entities, including those still waiting for their
+// clients to rejoin, are recorded so they can be resumed.
+//
+// --------------------------------------------------------------
+void GameModel::saveCheckpoint(const std::chrono::microseconds elapsedTime)
+{
+    if (!m_useCheckpoint)
+    {
+        return;
+    }
+    m_timeSinceCheckpoint += elapsedTime;
+    if (m_timeSinceCheckpoint < CHECKPOINT_INTERVAL)
+    {
+        return;
+    }
+    m_timeSinceCheckpoint = std::chrono::microseconds(0);
+    PROFILE_SCOPE("GameModel::saveCheckpoint");
+
+    Checkpoint::PlayerTokens players;
+    for (auto& client : m_clients.values())
+    {
+        if (client.playerId)
+        {
+            players[client.playerId.value()] = client.resumeToken;
+        }
+    }
+    for (auto& [playerId, player] : m_resumablePlayers)
+    {
+        players[playerId] = player.resumeToken;
+    }
+
+    m_checkpoint.save(m_entities, players, entities::Entity::nextId.load());
+}
+
+// --------------------------------------------------------------
+//
+// Restored players whose clients haven't rejoined in time are removed
+// from the game.
+//
+// --------------------------------------------------------------
+void GameModel::expireResumablePlayers(const std::chrono::microseconds elapsedTime)
+{
+    for (auto player = m_resumablePlayers.begin(); player != m_resumablePlayers.end();)
+    {
+        auto& [playerId, resumable] = *player;
+        resumable.remaining -= elapsedTime;
+        if (resumable.remaining <= std::chrono::microseconds(0))
+        {
+            MessageQueueServer::instance().broadcastMessage(std::make_shared<messages::RemoveEntity>(playerId));
+            m_commands.destroy(playerId);
+            player = m_resumablePlayers.erase(player);
+        }
+        else
+        {
+            ++player;
+        }
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Gives a restored player entity back to the client that rejoined
+// asking for it, if it has the token the player was given.  The client
+// is sent the world, which includes the player as everyone else sees
+// it, followed by the player as its own client sees it.
+//
+// --------------------------------------------------------------
+bool GameModel::resumePlayer(Client& client, entities::Entity::IdType playerId, std::uint64_t resumeToken)
+{
+    auto resumable = m_resumablePlayers.find(playerId);
+    if (resumable == m_resumablePlayers.end() || resumable->second.resumeToken != resumeToken)
+    {
+        return false;
+    }
+    m_resumablePlayers.erase(resumable);
+    if (m_entities.find(playerId) == m_entities.end())
+    {
+        return false;
+    }
+
+    auto clientId = client.clientId;
+    client.playerId = playerId;
+    client.resumeToken = resumeToken;
+    MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::JoinAck>(playerId, resumeToken));
+    reportAllEntities(clientId);
+    m_worldStateTransfers[clientId].resumedPlayerId = playerId;
+
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// A resume token has to be guessed to take over someone else's player,
+// so it comes from the OS's random source rather than a seeded engine.
+//
+// --------------------------------------------------------------
+std::uint64_t GameModel::makeResumeToken()
+{
+    return (static_cast<std::uint64_t>(m_randomDevice()) << 32) | static_cast<std::uint32_t>(m_randomDevice());
 }
 
 // --------------------------------------------------------------
@@ -101,9 +316,10 @@ void GameModel::shutdown()
 // --------------------------------------------------------------
 void GameModel::handleConnect(std::uint64_t clientId)
 {
-    m_clients.insert(clientId);
+    m_clients.emplace(clientId, {clientId, std::nullopt});
+    m_systemNetwork->addClient(clientId);
 
-    MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::ConnectAck>());
+    MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::ConnectAck>(ASSET_MANIFEST));
 }
 
 // --------------------------------------------------------------
@@ -114,68 +330,138 @@ void GameModel::handleConnect(std::uint64_t clientId)
 // --------------------------------------------------------------
 void GameModel::handleDisconnect(std::uint64_t clientId)
 {
+    auto client = m_clients.get(clientId);
+    if (client == nullptr)
+    {
+        return;
+    }
+    auto playerId = client->playerId;
     m_clients.erase(clientId);
+    m_worldStateTransfers.erase(clientId);
+    m_systemNetwork->removeClient(clientId);
 
-    auto message = std::make_shared<messages::RemoveEntity>(m_clientToEntityId[clientId]);
-    MessageQueueServer::instance().broadcastMessage(message);
     //
-    // Remove the player entity from the server simulation
-    removeEntity(m_clientToEntityId[clientId]);
-
-    m_clientToEntityId.erase(clientId);
+    // A client that never joined doesn't have a player to remove
+    if (playerId)
+    {
+        auto message = std::make_shared<messages::RemoveEntity>(playerId.value());
+        MessageQueueServer::instance().broadcastMessage(message);
+        //
+        // Remove the player entity from the server simulation
+        m_commands.destroy(playerId.value());
+    }
 }
 
 // --------------------------------------------------------------
 //
-// As entities are added to the game model, they are run by the systems
-// to see if they are interested in knowing about them during their
-// updates.
+// Handles the connects and disconnects reported by the network threads
+// since the last update, in the order they happened.
 //
 // --------------------------------------------------------------
-void GameModel::addEntity(std::shared_ptr<entities::Entity> entity)
+void GameModel::applyConnectionEvents()
 {
-    if (entity == nullptr)
-        return;
+    while (auto event = m_connectionEvents.dequeue())
+    {
+        auto [type, clientId] = event.value();
+        if (type == ConnectionEvent::Connected)
+        {
+            handleConnect(clientId);
+        }
+        else
+        {
+            handleDisconnect(clientId);
+        }
+    }
+}
 
-    m_entities[entity->getId()] = entity;
+// --------------------------------------------------------------
+//
+// Plays back the structural changes recorded by the game model and
+// the systems, as one batch for every system.
+//
+// --------------------------------------------------------------
+void GameModel::applyCommands()
+{
+    PROFILE_SCOPE("GameModel::applyCommands");
 
-    m_systemNetwork->addEntity(entity);
-    m_systemMomentum->addEntity(entity);
-    m_systemLifetime->addEntity(entity);
-    m_systemDamage->addEntity(entity);
+    m_commands.playback(m_entities, {m_systemNetwork.get(), m_systemMomentum.get(), m_systemLifetime.get(), m_systemDamage.get()});
 }
 
 // --------------------------------------------------------------
 //
-// All entity lists for the systems must be given a chance to remove
-// the entity.
+// For the indicated client, begins the transfer of all other entities
+// currently in the game simulation.  The encoded world state is built
+// once per update and shared by all clients joining during that update,
+// the chunks are sent over the next several updates by streamWorldState.
 //
 // --------------------------------------------------------------
-void GameModel::removeEntity(entities::Entity::IdType entityId)
+void GameModel::reportAllEntities(std::uint64_t clientId)
 {
-    m_entities.erase(entityId);
-    //
-    // Let each of the systems know to remove the entity
-    m_systemNetwork->removeEntity(entityId);
-    m_systemMomentum->removeEntity(entityId);
-    m_systemLifetime->removeEntity(entityId);
-    m_systemDamage->removeEntity(entityId);
+    if (m_worldStateSnapshot == nullptr)
+    {
+        m_worldStateSnapshot = std::make_shared<WorldStateSnapshot>();
+        m_worldStateSnapshot->chunks = messages::WorldState::createChunks(m_entities, WORLD_STATE_CHUNK_SIZE);
+        for (auto& [entityId, entity] : m_entities)
+        {
+            (void)entity; // unused
+            m_worldStateSnapshot->entityIds.insert(entityId);
+        }
+        m_worldStateSnapshot->version = components::Component::closeVersion();
+    }
+
+    m_worldStateTransfers[clientId] = {m_worldStateSnapshot, 0, std::nullopt};
 }
 
 // --------------------------------------------------------------
 //
-// For the indicated client, sends messages for all other entities
-// currently in the game simulation.
+// Sends the next few world state chunks to each client with a transfer
+// in progress.  Entities created after the snapshot was taken have already
+// been sent to the client as they were created, but entities removed since
+// then are still in the snapshot, so once a transfer completes the client
+// is told to remove those.  The updates to the others were sent before the
+// client had them and were ignored, so those that moved since the snapshot
+// are sent to the client again.
 //
 // --------------------------------------------------------------
-void GameModel::reportAllEntities(std::uint64_t clientId)
+void GameModel::streamWorldState()
 {
-    for (auto& [entityId, entity] : m_entities)
+    PROFILE_SCOPE("GameModel::streamWorldState");
+
+    for (auto transfer = m_worldStateTransfers.begin(); transfer != m_worldStateTransfers.end();)
     {
-        (void)entityId; // unused
-        auto pbEntity = messages::createReportablePBEntity(entity);
-        auto entityMessage = std::make_shared<messages::NewEntity>(pbEntity);
-        MessageQueueServer::instance().sendMessage(clientId, entityMessage);
+        auto& [clientId, state] = *transfer;
+        auto& chunks = state.snapshot->chunks;
+        for (std::size_t sent = 0; sent < WORLD_STATE_CHUNKS_PER_UPDATE && state.nextChunk < chunks.size(); sent++)
+        {
+            MessageQueueServer::instance().sendMessage(clientId, chunks[state.nextChunk++]);
+        }
+
+        if (state.nextChunk == chunks.size())
+        {
+            for (auto entityId : state.snapshot->entityIds)
+            {
+                auto entity = m_entities.find(entityId);
+                if (entity == m_entities.end())
+                {
+                    MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::RemoveEntity>(entityId));
+                }
+                else if (entity->second->changedSince<components::Position>(state.snapshot->version) || entity->second->changedSince<components::Momentum>(state.snapshot->version))
+                {
+                    m_systemNetwork->updateClient(clientId, entity->second);
+                }
+            }
+            if (state.resumedPlayerId && m_entities.find(state.resumedPlayerId.value()) != m_entities.end())
+            {
+                auto pbEntity = messages::createPBEntity(m_entities[state.resumedPlayerId.value()]);
+                pbEntity.mutable_appearance()->set_texture(entities::player::TEXTURE_OWN);
+                MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::NewEntity>(pbEntity));
+            }
+            transfer = m_worldStateTransfers.erase(transfer);
+        }
+        else
+        {
+            ++transfer;
+        }
     }
 }
 
@@ -183,11 +469,23 @@ void GameModel::reportAllEntities(std::uint64_t clientId)
 //
 // Handler for the Join message.  It gets a player entity created,
 // added to the server game model, and notifies the requesting client
-// of the player.
+// of the player.  A client that had a player before the server restarted
+// gets that player back instead, if it still has the player's resume
+// token.
 //
 // --------------------------------------------------------------
-void GameModel::handleJoin(std::uint64_t clientId)
+void GameModel::handleJoin(std::uint64_t clientId, std::optional<entities::Entity::IdType> playerId, std::uint64_t resumeToken)
 {
+    auto client = m_clients.get(clientId);
+    if (client == nullptr || client->playerId)
+    {
+        return;
+    }
+    if (playerId && resumePlayer(*client, playerId.value(), resumeToken))
+    {
+        return;
+    }
+
     //
     // Step 1: Tell the newly connected player about all other entities
     reportAllEntities(clientId);
@@ -197,17 +495,20 @@ void GameModel::handleJoin(std::uint64_t clientId)
     //         it to the newly joined client
 
     // Generate a player, add to server simulation, and send to the client
-    auto player = entities::player::create("playerShip1_blue.png", {0.0f, 0.0f}, 0.05f, 0.0000000002f, 180.0f / 1000, {0, 0}, 100.0f);
-    addEntity(player);
-    m_clientToEntityId[clientId] = player->getId();
+    auto player = entities::player::create(entities::player::TEXTURE_OWN, {0.0f, 0.0f}, 0.05f, 0.0000000002f, 180.0f / 1000, {0, 0}, 100.0f);
+    m_commands.spawn(player);
+    client->playerId = player->getId();
+    client->resumeToken = makeResumeToken();
 
     //
     // Build the protobuf representation and get it sent off to the client
     shared::Entity pbEntity = messages::createPBEntity(player);
 
     //
-    // Step 3: Send the new player entity to the newly joined client.
+    // Step 3: Send the new player entity to the newly joined client, along with
+    //         the token it needs to get the player back after reconnecting.
     MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::NewEntity>(pbEntity));
+    MessageQueueServer::instance().sendMessage(clientId, std::make_shared<messages::JoinAck>(player->getId(), client->resumeToken));
 
     //
     // Step 4: Let all other clients know about this new player entity
@@ -215,7 +516,7 @@ void GameModel::handleJoin(std::uint64_t clientId)
     // We change the appearance for a player ship entity for all other clients to a different
     // texture.
     player->removeComponent<components::Appearance>();
-    player->addComponent(std::make_unique<components::Appearance>("playerShip1_red.png"));
+    player->addComponent(std::make_unique<components::Appearance>(entities::player::TEXTURE_OTHER));
     pbEntity.mutable_appearance()->set_texture(player->getComponent<components::Appearance>()->getTexture());
 
     //
@@ -223,31 +524,11 @@ void GameModel::handleJoin(std::uint64_t clientId)
     // all other connected clients
     pbEntity.release_input();
     auto entityMessage = std::make_shared<messages::NewEntity>(pbEntity);
-    for (auto otherId : m_clients)
+    for (auto& other : m_clients.values())
     {
-        if (otherId != clientId)
+        if (other.clientId != clientId)
         {
-            MessageQueueServer::instance().sendMessage(otherId, entityMessage);
+            MessageQueueServer::instance().sendMessage(other.clientId, entityMessage);
         }
     }
 }
-
-// --------------------------------------------------------------
-//
-// Used to build up the list of entities to add in the next update.
-//
-// --------------------------------------------------------------
-void GameModel::handleNewEntity(std::shared_ptr<entities::Entity> entity)
-{
-    m_newEntities.push_back(entity);
-}
-
-// --------------------------------------------------------------
-//
-// Used to build up the list of entities to remove in the next update.
-//
-// --------------------------------------------------------------
-void GameModel::handleRemoveEntity(entities::Entity::IdType entityId)
-{
-    m_removeEntities.insert(entityId);
-}
@@ -11,7 +11,13 @@
     #pragma warning(pop)
 #endif
 
+#include "Checkpoint.hpp"
+#include "ConcurrentQueue.hpp"
+#include "Metrics.hpp"
+#include "SlotTable.hpp"
+#include "entities/CommandBuffer.hpp"
 #include "entities/Entity.hpp"
+#include "messages/WorldState.hpp"
 #include "systems/Damage.hpp"
 #include "systems/Lifetime.hpp"
 #include "systems/Momentum.hpp"
@@ -19,37 +25,110 @@
 
 #include <SFML/Network.hpp>
 #include <chrono>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <random>
+#include <tuple>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 class GameModel
 {
   public:
-    void update(const std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now);
-    bool initialize();
+    void update(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now);
+    bool initialize(bool useCheckpoint = true);
     void shutdown();
 
   private:
-    std::unordered_set<std::uint64_t> m_clients;
-    std::unordered_map<std::uint64_t, entities::Entity::IdType> m_clientToEntityId;
+    //
+    // The world state sent to joining clients is encoded at most once per update
+    // and shared by every client that joins during that update.
+    struct WorldStateSnapshot
+    {
+        std::vector<std::shared_ptr<messages::WorldState>> chunks;
+        entities::EntitySet entityIds;
+        components::Component::Version version; // changes after this aren't in the chunks
+    };
+    struct WorldStateTransfer
+    {
+        std::shared_ptr<WorldStateSnapshot> snapshot;
+        std::size_t nextChunk{0};
+        std::optional<entities::Entity::IdType> resumedPlayerId;
+    };
+
+    //
+    // Connected clients, addressed by the client id handed out by the
+    // MessageQueueServer (which is a key into its own connection table).
+    struct Client
+    {
+        std::uint64_t clientId;
+        std::optional<entities::Entity::IdType> playerId;
+        std::uint64_t resumeToken{0}; // given to the client with its player
+    };
+    SlotTable<Client> m_clients;
+    //
+    // Clients connect and disconnect on the network threads, the game model hears
+    // about it at the start of its next update, on the game thread.
+    enum class ConnectionEvent
+    {
+        Connected,
+        Disconnected
+    };
+    ConcurrentQueue<std::tuple<ConnectionEvent, std::uint64_t>> m_connectionEvents;
     entities::EntityMap m_entities;
-    entities::EntityVector m_newEntities;
-    entities::EntitySet m_removeEntities;
+    entities::CommandBuffer m_commands;
+    std::shared_ptr<WorldStateSnapshot> m_worldStateSnapshot;
+    std::unordered_map<std::uint64_t, WorldStateTransfer> m_worldStateTransfers;
+
+    bool m_useCheckpoint{true};
+    Checkpoint m_checkpoint;
+    std::chrono::microseconds m_timeSinceCheckpoint{0};
+    //
+    // Player entities restored from a checkpoint, each waits this much
+    // longer for its client to rejoin (with the right token) before it
+    // is removed.
+    struct ResumablePlayer
+    {
+        std::chrono::microseconds remaining;
+        std::uint64_t resumeToken;
+    };
+    std::unordered_map<entities::Entity::IdType, ResumablePlayer> m_resumablePlayers;
+    std::random_device m_randomDevice;
 
     std::unique_ptr<systems::Damage> m_systemDamage;
     std::unique_ptr<systems::Lifetime> m_systemLifetime;
     std::unique_ptr<systems::Momentum> m_systemMomentum;
     std::unique_ptr<systems::Network> m_systemNetwork;
 
-    void addEntity(std::shared_ptr<entities::Entity> entity);
-    void removeEntity(entities::Entity::IdType entityId);
+    //
+    // Time spent in each update and in each system's update, along with
+    // how many entities each system has.
+    metrics::Histogram& m_metricUpdate{metrics::Registry::instance().histogram("server_update_microseconds")};
+    metrics::Histogram& m_metricNetworkUpdate{metrics::Registry::instance().histogram("server_system_update_microseconds", {{"system", "Network"}})};
+    metrics::Histogram& m_metricMomentumUpdate{metrics::Registry::instance().histogram("server_system_update_microseconds", {{"system", "Momentum"}})};
+    metrics::Histogram& m_metricLifetimeUpdate{metrics::Registry::instance().histogram("server_system_update_microseconds", {{"system", "Lifetime"}})};
+    metrics::Histogram& m_metricDamageUpdate{metrics::Registry::instance().histogram("server_system_update_microseconds", {{"system", "Damage"}})};
+    metrics::Gauge& m_metricNetworkEntities{metrics::Registry::instance().gauge("server_system_entities", {{"system", "Network"}})};
+    metrics::Gauge& m_metricMomentumEntities{metrics::Registry::instance().gauge("server_system_entities", {{"system", "Momentum"}})};
+    metrics::Gauge& m_metricLifetimeEntities{metrics::Registry::instance().gauge("server_system_entities", {{"system", "Lifetime"}})};
+    metrics::Gauge& m_metricDamageEntities{metrics::Registry::instance().gauge("server_system_entities", {{"system", "Damage"}})};
+    metrics::Gauge& m_metricEntities{metrics::Registry::instance().gauge("server_entities")};
+    metrics::Gauge& m_metricClients{metrics::Registry::instance().gauge("server_clients")};
+
+    void applyConnectionEvents();
+    void applyCommands();
 
     void reportAllEntities(std::uint64_t clientId);
+    void streamWorldState();
+
+    void loadCheckpoint();
+    void saveCheckpoint(const std::chrono::microseconds elapsedTime);
+    void expireResumablePlayers(const std::chrono::microseconds elapsedTime);
+    bool resumePlayer(Client& client, entities::Entity::IdType playerId, std::uint64_t resumeToken);
+    std::uint64_t makeResumeToken();
 
     void handleConnect(std::uint64_t clientId);
     void handleDisconnect(std::uint64_t clientId);
-    void handleJoin(std::uint64_t clientId);
-    void handleNewEntity(std::shared_ptr<entities::Entity> entity);
-    void handleRemoveEntity(entities::Entity::IdType entityId);
+    void handleJoin(std::uint64_t clientId, std::optional<entities::Entity::IdType> playerId, std::uint64_t resumeToken);
 };
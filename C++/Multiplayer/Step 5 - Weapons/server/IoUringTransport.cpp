@@ -0,0 +1,600 @@
+#include "IoUringTransport.hpp"
+
+#include "misc/Profiler.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#if defined(HAVE_LIBURING)
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+
+const unsigned int RING_ENTRIES = 1024;
+const std::uint16_t BUFFER_GROUP = 1;
+const std::uint16_t BUFFER_COUNT = 256; // Must be a power of 2
+const std::size_t BUFFER_SIZE = 4096;
+
+const std::size_t MESSAGE_HEADER_SIZE = 5;
+
+//
+// How long to wait before accepting again, when the process or system is out
+// of file descriptors or memory
+const std::chrono::milliseconds ACCEPT_BACKOFF(100);
+
+// --------------------------------------------------------------
+//
+// Checks the ring supports the opcodes this transport submits, and
+// fast poll, so waiting on a socket doesn't tie up a kernel worker
+// thread for each request.
+//
+// --------------------------------------------------------------
+static bool ringSupported(io_uring& ring)
+{
+    if (!(ring.features & IORING_FEAT_FAST_POLL))
+    {
+        return false;
+    }
+    auto probe = io_uring_get_probe_ring(&ring);
+    if (probe == nullptr)
+    {
+        return false;
+    }
+
+    static const int OPCODES[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_READ, IORING_OP_TIMEOUT};
+    bool supported = true;
+    for (auto opcode : OPCODES)
+    {
+        supported = supported && io_uring_opcode_supported(probe, opcode);
+    }
+    io_uring_free_probe(probe);
+
+    return supported;
+}
+
+// --------------------------------------------------------------
+//
+// Multishot receive (Linux 6.0) is a flag of the receive, the probe
+// doesn't report it.  Tries one on a socket whose peer is already
+// closed, which completes right away: kernels without it reject the
+// flag with EINVAL.  Called before any receive buffers are provided,
+// so none of them is used up, and before the ring thread starts.
+//
+// --------------------------------------------------------------
+static bool multishotReceiveSupported(io_uring& ring)
+{
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    {
+        return false;
+    }
+    ::close(sockets[1]);
+
+    auto sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_recv_multishot(sqe, sockets[0], nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(&ring);
+
+    io_uring_cqe* cqe = nullptr;
+    bool supported = false;
+    if (io_uring_wait_cqe(&ring, &cqe) == 0)
+    {
+        supported = cqe->res != -EINVAL;
+        io_uring_cqe_seen(&ring, cqe);
+    }
+    ::close(sockets[0]);
+
+    return supported;
+}
+#endif
+
+IoUringTransport::~IoUringTransport()
+{
+    shutdown();
+}
+
+// --------------------------------------------------------------
+//
+// Sets up the ring, the provided receive buffers and the listening
+// socket, then starts the thread that services the ring.  Returns
+// false if io_uring can't be used, leaving nothing behind.
+//
+// --------------------------------------------------------------
+bool IoUringTransport::initialize([[maybe_unused]] std::uint16_t listenPort, ConnectHandler onConnect, MessageHandler onMessage, DisconnectHandler onDisconnect)
+{
+    m_onConnect = onConnect;
+    m_onMessage = onMessage;
+    m_onDisconnect = onDisconnect;
+
+#if defined(HAVE_LIBURING)
+    if (io_uring_queue_init(RING_ENTRIES, &m_ring, 0) < 0)
+    {
+        std::cout << "unable to create io_uring" << std::endl;
+        return false;
+    }
+    if (!ringSupported(m_ring))
+    {
+        std::cout << "io_uring doesn't support the operations needed" << std::endl;
+        io_uring_queue_exit(&m_ring);
+        return false;
+    }
+
+    //
+    // Provided buffer rings arrived with multishot accept (Linux 5.19), being
+    // able to register one shows that is available too
+    int result = 0;
+    m_bufferRing = io_uring_setup_buf_ring(&m_ring, BUFFER_COUNT, BUFFER_GROUP, 0, &result);
+    if (m_bufferRing == nullptr)
+    {
+        std::cout << "unable to register io_uring receive buffers" << std::endl;
+        io_uring_queue_exit(&m_ring);
+        return false;
+    }
+    if (!multishotReceiveSupported(m_ring))
+    {
+        std::cout << "io_uring doesn't support multishot receive" << std::endl;
+        io_uring_free_buf_ring(&m_ring, m_bufferRing, BUFFER_COUNT, BUFFER_GROUP);
+        io_uring_queue_exit(&m_ring);
+        return false;
+    }
+    m_buffers.resize(BUFFER_COUNT * BUFFER_SIZE);
+    for (std::uint16_t buffer = 0; buffer < BUFFER_COUNT; buffer++)
+    {
+        io_uring_buf_ring_add(m_bufferRing, m_buffers.data() + buffer * BUFFER_SIZE, BUFFER_SIZE, buffer, io_uring_buf_ring_mask(BUFFER_COUNT), buffer);
+    }
+    io_uring_buf_ring_advance(m_bufferRing, BUFFER_COUNT);
+
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int enable = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(listenPort);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    m_wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (m_listenFd < 0 || m_wakeFd < 0 ||
+        ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ||
+        ::listen(m_listenFd, SOMAXCONN) == -1)
+    {
+        std::cout << "error initializing network socket" << std::endl;
+        ::close(m_listenFd);
+        ::close(m_wakeFd);
+        io_uring_free_buf_ring(&m_ring, m_bufferRing, BUFFER_COUNT, BUFFER_GROUP);
+        io_uring_queue_exit(&m_ring);
+        return false;
+    }
+
+    submitAccept();
+    submitWake();
+    io_uring_submit(&m_ring);
+
+    m_initialized = true;
+    m_thread = std::thread([this]() { run(); });
+    std::cout << "successfully initialized io_uring sockets" << std::endl;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+// --------------------------------------------------------------
+//
+// Stops the ring thread and releases everything it owned.
+//
+// --------------------------------------------------------------
+void IoUringTransport::shutdown()
+{
+    if (!m_initialized)
+    {
+        return;
+    }
+    m_initialized = false;
+    m_keepRunning = false;
+    flush();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+#if defined(HAVE_LIBURING)
+    for (auto& connection : m_connections.values())
+    {
+        ::close(connection->fd);
+    }
+    m_connections = {};
+    ::close(m_listenFd);
+    ::close(m_wakeFd);
+    io_uring_free_buf_ring(&m_ring, m_bufferRing, BUFFER_COUNT, BUFFER_GROUP);
+    io_uring_queue_exit(&m_ring);
+#endif
+}
+
+// --------------------------------------------------------------
+//
+// Queues a framed message for a client, it goes out with the next
+// flush.  Safe to call from any thread.
+//
+// --------------------------------------------------------------
+void IoUringTransport::send(std::uint64_t clientId, std::string frame)
+{
+    m_sendFrames.enqueue(std::make_tuple(clientId, std::move(frame)));
+}
+
+// --------------------------------------------------------------
+//
+// Wakes the ring thread so that everything queued so far is
+// submitted, as a single batch.
+//
+// --------------------------------------------------------------
+void IoUringTransport::flush()
+{
+#if defined(HAVE_LIBURING)
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(m_wakeFd, &one, sizeof(one));
+#endif
+}
+
+// --------------------------------------------------------------
+//
+// Invokes the callback for every currently connected client.
+//
+// --------------------------------------------------------------
+void IoUringTransport::forEachClient(const std::function<void(std::uint64_t)>& callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutexClients);
+    for (auto clientId : m_clients.values())
+    {
+        callback(clientId);
+    }
+}
+
+#if defined(HAVE_LIBURING)
+// --------------------------------------------------------------
+//
+// The ring thread: submit whatever has been prepared, wait for at
+// least one completion, then handle all available completions.
+//
+// --------------------------------------------------------------
+void IoUringTransport::run()
+{
+    PROFILE_THREAD("io_uring");
+    while (m_keepRunning)
+    {
+        io_uring_submit_and_wait(&m_ring, 1);
+
+        PROFILE_SCOPE("IoUringTransport::completions");
+        io_uring_cqe* cqe;
+        unsigned int head;
+        unsigned int count = 0;
+        io_uring_for_each_cqe(&m_ring, head, cqe)
+        {
+            count++;
+            auto request = static_cast<Request*>(io_uring_cqe_get_data(cqe));
+            switch (request->operation)
+            {
+                case Operation::Accept:
+                    handleAccept(cqe->res, cqe->flags);
+                    break;
+                case Operation::AcceptBackoff:
+                    if (m_keepRunning)
+                    {
+                        submitAccept();
+                    }
+                    break;
+                case Operation::Receive:
+                    handleReceive(*request->connection, cqe->res, cqe->flags);
+                    break;
+                case Operation::Send:
+                    handleSend(*request->connection, cqe->res);
+                    break;
+                case Operation::Wake:
+                    handleWake();
+                    break;
+            }
+        }
+        io_uring_cq_advance(&m_ring, count);
+    }
+}
+
+// --------------------------------------------------------------
+//
+// The submission queue can fill up during a large batch, in which
+// case it is submitted to make room.
+//
+// --------------------------------------------------------------
+static io_uring_sqe* getSqe(io_uring* ring)
+{
+    auto sqe = io_uring_get_sqe(ring);
+    while (sqe == nullptr)
+    {
+        io_uring_submit(ring);
+        sqe = io_uring_get_sqe(ring);
+    }
+    return sqe;
+}
+
+void IoUringTransport::submitAccept()
+{
+    auto sqe = getSqe(&m_ring);
+    io_uring_prep_multishot_accept(sqe, m_listenFd, nullptr, nullptr, 0);
+    io_uring_sqe_set_data(sqe, &m_accept);
+}
+
+// --------------------------------------------------------------
+//
+// Accepting again is put off until a timeout completes, giving the
+// server time to release descriptors before it tries again.
+//
+// --------------------------------------------------------------
+void IoUringTransport::submitAcceptBackoff()
+{
+    m_acceptBackoffTime.tv_sec = 0;
+    m_acceptBackoffTime.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(ACCEPT_BACKOFF).count();
+    auto sqe = getSqe(&m_ring);
+    io_uring_prep_timeout(sqe, &m_acceptBackoffTime, 0, 0);
+    io_uring_sqe_set_data(sqe, &m_acceptBackoff);
+}
+
+void IoUringTransport::submitReceive(Connection& connection)
+{
+    auto sqe = getSqe(&m_ring);
+    io_uring_prep_recv_multishot(sqe, connection.fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    io_uring_sqe_set_data(sqe, &connection.receive);
+    connection.inFlight++;
+}
+
+// --------------------------------------------------------------
+//
+// Only one send per connection is ever in flight, that keeps the
+// byte stream in order.  Frames queued while it is in flight are
+// collected in outbound and go out when it completes.
+//
+// --------------------------------------------------------------
+void IoUringTransport::submitSend(Connection& connection)
+{
+    if (connection.sendBuffer.empty())
+    {
+        std::swap(connection.sendBuffer, connection.outbound);
+        connection.sent = 0;
+    }
+
+    auto sqe = getSqe(&m_ring);
+    io_uring_prep_send(sqe, connection.fd, connection.sendBuffer.data() + connection.sent, connection.sendBuffer.size() - connection.sent, MSG_NOSIGNAL);
+    io_uring_sqe_set_data(sqe, &connection.send);
+    connection.inFlight++;
+}
+
+void IoUringTransport::submitWake()
+{
+    auto sqe = getSqe(&m_ring);
+    io_uring_prep_read(sqe, m_wakeFd, &m_wakeValue, sizeof(m_wakeValue), 0);
+    io_uring_sqe_set_data(sqe, &m_wake);
+}
+
+// --------------------------------------------------------------
+//
+// A new client connection.  The client id is the connection's key in
+// the connection table.
+//
+// An error ends the multishot accept.  Running out of descriptors or
+// memory is retried after a backoff, rather than right away only to
+// fail again, errors with the listening socket itself stop accepting
+// altogether, anything else (a connection aborted before it was
+// accepted) is retried right away.
+//
+// --------------------------------------------------------------
+void IoUringTransport::handleAccept(int result, std::uint32_t flags)
+{
+    if (result >= 0)
+    {
+        int enable = 1;
+        setsockopt(result, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto clientId = m_connections.insert(std::make_unique<Connection>());
+        auto& connection = **m_connections.get(clientId);
+        connection.fd = result;
+        connection.clientId = clientId;
+        submitReceive(connection);
+        {
+            std::lock_guard<std::mutex> lock(m_mutexClients);
+            m_clients.emplace(clientId, clientId);
+        }
+        std::cout << "new client connection accepted" << std::endl;
+        m_onConnect(clientId);
+    }
+    else if (result != -ECANCELED)
+    {
+        std::cout << "error accepting a client connection: " << std::strerror(-result) << std::endl;
+    }
+
+    if ((flags & IORING_CQE_F_MORE) || !m_keepRunning)
+    {
+        return;
+    }
+    switch (-result)
+    {
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM:
+            submitAcceptBackoff();
+            break;
+        case EBADF:
+        case EINVAL:
+        case ENOTSOCK:
+        case EOPNOTSUPP:
+            std::cout << "no longer accepting client connections" << std::endl;
+            break;
+        default:
+            submitAccept();
+            break;
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Data arrived in one of the provided buffers, copy it into the
+// connection, return the buffer to the ring and parse out any
+// complete messages.
+//
+// --------------------------------------------------------------
+void IoUringTransport::handleReceive(Connection& connection, int result, std::uint32_t flags)
+{
+    if (result > 0 && (flags & IORING_CQE_F_BUFFER))
+    {
+        auto buffer = static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        auto data = m_buffers.data() + buffer * BUFFER_SIZE;
+        connection.inbound.append(data, result);
+        io_uring_buf_ring_add(m_bufferRing, data, BUFFER_SIZE, buffer, io_uring_buf_ring_mask(BUFFER_COUNT), 0);
+        io_uring_buf_ring_advance(m_bufferRing, 1);
+
+        if (!connection.closing)
+        {
+            parseMessages(connection);
+        }
+    }
+    else if (result != -ENOBUFS)
+    {
+        // Closed by the client (0) or an error
+        close(connection);
+    }
+
+    if (!(flags & IORING_CQE_F_MORE))
+    {
+        connection.inFlight--;
+        if (!connection.closing)
+        {
+            // Multishot ended, likely out of buffers, so start another one
+            submitReceive(connection);
+        }
+    }
+
+    releaseIfDone(connection);
+}
+
+void IoUringTransport::handleSend(Connection& connection, int result)
+{
+    connection.inFlight--;
+    if (result < 0)
+    {
+        close(connection);
+    }
+    else if (!connection.closing)
+    {
+        connection.sent += result;
+        if (connection.sent == connection.sendBuffer.size())
+        {
+            connection.sendBuffer.clear();
+        }
+        if (!connection.sendBuffer.empty() || !connection.outbound.empty())
+        {
+            submitSend(connection);
+        }
+    }
+
+    releaseIfDone(connection);
+}
+
+// --------------------------------------------------------------
+//
+// Someone called flush (or shutdown).  Every queued frame is appended
+// to its connection's outbound data, then each connection with data
+// and no send already in flight gets a single send.
+//
+// --------------------------------------------------------------
+void IoUringTransport::handleWake()
+{
+    std::vector<Connection*> pending;
+    for (auto item = m_sendFrames.dequeue(); item; item = m_sendFrames.dequeue())
+    {
+        auto& [clientId, frame] = item.value();
+        auto connection = m_connections.get(clientId);
+        if (connection != nullptr && !(*connection)->closing)
+        {
+            if ((*connection)->outbound.empty())
+            {
+                pending.push_back(connection->get());
+            }
+            (*connection)->outbound.append(frame);
+        }
+    }
+
+    for (auto connection : pending)
+    {
+        if (connection->sendBuffer.empty())
+        {
+            submitSend(*connection);
+        }
+    }
+
+    if (m_keepRunning)
+    {
+        submitWake();
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Messages are framed as [type (1 byte) | size (4 bytes, network order) | payload]
+//
+// --------------------------------------------------------------
+void IoUringTransport::parseMessages(Connection& connection)
+{
+    std::size_t offset = 0;
+    while (connection.inbound.size() - offset >= MESSAGE_HEADER_SIZE)
+    {
+        auto type = static_cast<messages::Type>(connection.inbound[offset]);
+        std::uint32_t size;
+        std::memcpy(&size, connection.inbound.data() + offset + 1, sizeof(size));
+        size = ntohl(size);
+        if (connection.inbound.size() - offset - MESSAGE_HEADER_SIZE < size)
+        {
+            break;
+        }
+
+        m_onMessage(connection.clientId, type, connection.inbound.substr(offset + MESSAGE_HEADER_SIZE, size));
+        offset += MESSAGE_HEADER_SIZE + size;
+    }
+    connection.inbound.erase(0, offset);
+}
+
+// --------------------------------------------------------------
+//
+// Shutting down the socket completes the outstanding receive, the
+// connection is released once nothing else references it.
+//
+// --------------------------------------------------------------
+void IoUringTransport::close(Connection& connection)
+{
+    if (connection.closing)
+    {
+        return;
+    }
+    connection.closing = true;
+    ::shutdown(connection.fd, SHUT_RDWR);
+    {
+        std::lock_guard<std::mutex> lock(m_mutexClients);
+        m_clients.erase(connection.clientId);
+    }
+    m_onDisconnect(connection.clientId);
+}
+
+void IoUringTransport::releaseIfDone(Connection& connection)
+{
+    if (connection.closing && connection.inFlight == 0)
+    {
+        ::close(connection.fd);
+        m_connections.erase(connection.clientId);
+    }
+}
+#endif
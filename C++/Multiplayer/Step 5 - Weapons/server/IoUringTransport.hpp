@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ConcurrentQueue.hpp"
+#include "SlotTable.hpp"
+#include "messages/MessageTypes.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#if defined(HAVE_LIBURING)
+    #include <liburing.h>
+#endif
+
+// --------------------------------------------------------------
+//
+// Linux io_uring based connection handling for the MessageQueueServer.
+// A single thread owns the ring and all client connections:
+//  * One multishot accept receives all new connections
+//  * One multishot recv per connection reads into a provided buffer ring
+//  * Outbound frames are queued by any thread and submitted together,
+//    one send per connection, when flush is called
+//
+// If the server wasn't built with liburing, or the kernel doesn't
+// support the features used, initialize returns false and the
+// MessageQueueServer falls back to its socket threads.
+//
+// --------------------------------------------------------------
+class IoUringTransport
+{
+  public:
+    using ConnectHandler = std::function<void(std::uint64_t)>;
+    using MessageHandler = std::function<void(std::uint64_t, messages::Type, const std::string&)>;
+    using DisconnectHandler = std::function<void(std::uint64_t)>;
+
+    ~IoUringTransport();
+
+    bool initialize(std::uint16_t listenPort, ConnectHandler onConnect, MessageHandler onMessage, DisconnectHandler onDisconnect);
+    void shutdown();
+
+    void send(std::uint64_t clientId, std::string frame);
+    void flush();
+    void forEachClient(const std::function<void(std::uint64_t)>& callback);
+
+  private:
+#if defined(HAVE_LIBURING)
+    enum class Operation : std::uint8_t
+    {
+        Accept,
+        AcceptBackoff,
+        Receive,
+        Send,
+        Wake
+    };
+
+    struct Connection;
+
+    // --------------------------------------------------------------
+    //
+    // Every submission's user_data points at one of these, so the
+    // completion can be routed back to what it belongs to.
+    //
+    // --------------------------------------------------------------
+    struct Request
+    {
+        Operation operation;
+        Connection* connection{nullptr};
+    };
+
+    struct Connection
+    {
+        int fd{-1};
+        std::uint64_t clientId{0};
+        Request receive{Operation::Receive, this};
+        Request send{Operation::Send, this};
+        std::string inbound;    // bytes received but not yet parsed into a full message
+        std::string outbound;   // bytes waiting for the current send to complete
+        std::string sendBuffer; // bytes of the send currently in flight
+        std::size_t sent{0};    // how much of sendBuffer has been sent
+        std::uint8_t inFlight{0};
+        bool closing{false};
+    };
+
+    io_uring m_ring{};
+    io_uring_buf_ring* m_bufferRing{nullptr};
+    std::vector<char> m_buffers;
+    int m_listenFd{-1};
+    int m_wakeFd{-1};
+    std::uint64_t m_wakeValue{0};
+    Request m_accept{Operation::Accept};
+    Request m_acceptBackoff{Operation::AcceptBackoff};
+    __kernel_timespec m_acceptBackoffTime{};
+    Request m_wake{Operation::Wake};
+
+    SlotTable<std::unique_ptr<Connection>> m_connections;
+
+    void run();
+    void submitAccept();
+    void submitAcceptBackoff();
+    void submitReceive(Connection& connection);
+    void submitSend(Connection& connection);
+    void submitWake();
+    void handleAccept(int result, std::uint32_t flags);
+    void handleReceive(Connection& connection, int result, std::uint32_t flags);
+    void handleSend(Connection& connection, int result);
+    void handleWake();
+    void parseMessages(Connection& connection);
+    void close(Connection& connection);
+    void releaseIfDone(Connection& connection);
+#endif
+
+    bool m_initialized{false};
+    std::atomic<bool> m_keepRunning{true}; // cleared by shutdown on another thread, which then wakes the ring
+    std::thread m_thread;
+
+    ConnectHandler m_onConnect;
+    MessageHandler m_onMessage;
+    DisconnectHandler m_onDisconnect;
+
+    ConcurrentQueue<std::tuple<std::uint64_t, std::string>> m_sendFrames;
+
+    SlotTable<std::uint64_t> m_clients; // the game thread's copy of the connection table's keys
+    std::mutex m_mutexClients;
+};
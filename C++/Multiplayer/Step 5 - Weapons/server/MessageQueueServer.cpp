@@ -3,9 +3,13 @@
 #include "components/Position.hpp"
 #include "messages/Input.hpp"
 #include "messages/Join.hpp"
+#include "messages/Ping.hpp"
 #include "messages/UpdateEntity.hpp"
+#include "misc/Profiler.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <limits>
@@ -15,32 +19,152 @@
     #include <winsock2.h>
 #else
     #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
 #endif
 
+// --------------------------------------------------------------
+//
+// SFML doesn't provide a way to set socket options before binding,
+// which is needed for SO_REUSEPORT.  This listener creates and binds
+// the native socket itself, then hands it to SFML.
+//
+// --------------------------------------------------------------
+class ReusePortListener : public sf::TcpListener
+{
+  public:
+    bool listen(std::uint16_t port)
+    {
+#if defined(SO_REUSEPORT)
+        auto handle = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (handle < 0)
+        {
+            return false;
+        }
+
+        int enable = 1;
+        setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        setsockopt(handle, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (::bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 || ::listen(handle, SOMAXCONN) == -1)
+        {
+            ::close(handle);
+            return false;
+        }
+
+        create(handle);
+        return true;
+#else
+        (void)port; // unused
+        return false;
+#endif
+    }
+};
+
 // -----------------------------------------------------------------
 //
-// Create three threads for the message queue:
-//  1. Listen for incoming client connections
+// Create the shards for the message queue, each shard has three threads:
+//  1. Listen for incoming client connections (only shard 0 when not using SO_REUSEPORT)
 //  2. Listen for incoming messages
 //  3. Sending of messages
 //
 // -----------------------------------------------------------------
-bool MessageQueueServer::initialize(std::uint16_t listenPort)
+bool MessageQueueServer::initialize(std::uint16_t listenPort, std::uint16_t shardCount, bool reusePort, bool useIoUring)
 {
-    // Register the message types with the handler that can create a message object
-    // of the appropriate type.
+    registerMessages();
+
+    //
+    // The io_uring transport does all its socket work on one thread, it only
+    // needs a single shard for the received messages.
+    shardCount = std::max(shardCount, static_cast<std::uint16_t>(1));
+    for (std::uint16_t index = 0; index < (useIoUring ? 1 : shardCount); index++)
+    {
+        m_shards.push_back(std::make_unique<Shard>(index));
+    }
+
+    if (useIoUring)
+    {
+        if (initializeIoUring(listenPort))
+        {
+            return true;
+        }
+        std::cout << "io_uring not available, falling back to socket threads" << std::endl;
+        for (std::uint16_t index = 1; index < shardCount; index++)
+        {
+            m_shards.push_back(std::make_unique<Shard>(index));
+        }
+    }
+
+    //
+    // With SO_REUSEPORT every shard listens on the same port and the kernel
+    // balances connections between them.  Otherwise, a single listener hands
+    // out connections to the shards round-robin.
+    if (reusePort && initializeListener(*m_shards[0], listenPort, true))
+    {
+        for (std::uint16_t index = 1; index < shardCount; index++)
+        {
+            initializeListener(*m_shards[index], listenPort, true);
+        }
+    }
+    else if (!initializeListener(*m_shards[0], listenPort, false))
+    {
+        return false;
+    }
+
+    for (auto& shard : m_shards)
+    {
+        initializeSender(*shard);
+        initializeReceiver(*shard);
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// No sockets or threads, a single shard holds the connections and
+// received messages the replay hands over.
+//
+// --------------------------------------------------------------
+bool MessageQueueServer::initializeReplay()
+{
+    registerMessages();
+    m_replay = true;
+    m_shards.push_back(std::make_unique<Shard>(0));
+    return true;
+}
+
+// --------------------------------------------------------------
+//
+// Register the message types with the handler that can create a
+// message object of the appropriate type.
+//
+// --------------------------------------------------------------
+void MessageQueueServer::registerMessages()
+{
+    for (std::size_t type = 0; type < MESSAGE_TYPE_NAMES.size(); type++)
+    {
+        metrics::Labels labels = {{"type", MESSAGE_TYPE_NAMES[type]}};
+        m_messagesSent[type] = &metrics::Registry::instance().counter("server_messages_sent_total", labels);
+        m_bytesSent[type] = &metrics::Registry::instance().counter("server_bytes_sent_total", labels);
+        m_messagesReceived[type] = &metrics::Registry::instance().counter("server_messages_received_total", labels);
+        m_bytesReceived[type] = &metrics::Registry::instance().counter("server_bytes_received_total", labels);
+    }
+
     m_messageCommand[messages::Type::Join] = []() {
         return std::make_shared<messages::Join>();
     };
     m_messageCommand[messages::Type::Input] = []() {
         return std::make_shared<messages::Input>();
     };
-
-    initializeListener(listenPort);
-    initializeSender();
-    initializeReceiver();
-
-    return true;
+    m_messageCommand[messages::Type::Ping] = []() {
+        return std::make_shared<messages::Ping>();
+    };
 }
 
 // --------------------------------------------------------------
@@ -52,13 +176,23 @@ bool MessageQueueServer::initialize(std::uint16_t listenPort)
 void MessageQueueServer::shutdown()
 {
     m_keepRunning = false;
-    m_listener.close();
+    if (m_ioUring)
+    {
+        m_ioUring->shutdown();
+    }
+    for (auto& shard : m_shards)
+    {
+        if (shard->listener)
+        {
+            shard->listener->close();
+        }
+    }
 }
 
 // -----------------------------------------------------------------
 //
 // Two steps in sending a message:
-//  1. Add the message the the message queue
+//  1. Add the message the the owning shard's message queue
 //  2. Signal the thread that performs the sending that a new message is available
 //
 // -----------------------------------------------------------------
@@ -71,8 +205,36 @@ void MessageQueueServer::sendMessage(std::uint64_t clientId, std::shared_ptr<mes
     // last message sequence number attached to it.  Right before the message
     // is sent in the sender thread, the messageId is set on the message, ensure
     // the correct sequence number is sent to the client.
-    m_sendMessages.enqueue(std::make_tuple(clientId, messageId, message));
-    m_eventSendMessages.notify_one();
+    if (m_ioUring)
+    {
+        m_ioUring->send(clientId, frameMessage(message, messageId));
+        return;
+    }
+    if (m_replay)
+    {
+        m_replayBytesSent += frameMessage(message, messageId).size();
+        return;
+    }
+
+    auto& shard = idToShard(clientId);
+    shard.sendMessages.enqueue(std::make_tuple(clientId, messageId, message));
+    shard.sendQueueDepth.add(1);
+    shard.eventSendMessages.notify_one();
+}
+
+// -----------------------------------------------------------------
+//
+// The socket threads send messages as soon as they are queued, but
+// the io_uring transport holds them until this is called, then submits
+// them all together.  The game model calls this once per update.
+//
+// -----------------------------------------------------------------
+void MessageQueueServer::flush()
+{
+    if (m_ioUring)
+    {
+        m_ioUring->flush();
+    }
 }
 
 // -----------------------------------------------------------------
@@ -84,7 +246,9 @@ void MessageQueueServer::sendMessage(std::uint64_t clientId, std::shared_ptr<mes
 // -----------------------------------------------------------------
 void MessageQueueServer::sendMessageWithLastId(std::uint64_t clientId, std::shared_ptr<messages::Message>& message)
 {
-    sendMessage(clientId, message, m_clientLastMessageId[clientId]);
+    auto& shard = idToShard(clientId);
+    auto connection = shard.connections.get(toConnectionKey(clientId));
+    sendMessage(clientId, message, connection ? connection->lastMessageId : std::nullopt);
 }
 
 // -----------------------------------------------------------------
@@ -94,12 +258,21 @@ void MessageQueueServer::sendMessageWithLastId(std::uint64_t clientId, std::shar
 // -----------------------------------------------------------------
 void MessageQueueServer::broadcastMessage(std::shared_ptr<messages::Message> message)
 {
-    std::lock_guard<std::mutex> lock(m_mutexSockets);
+    if (m_ioUring)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[0]->mutexSockets);
+        m_ioUring->forEachClient([this, &message](std::uint64_t clientId) { sendMessage(clientId, message); });
+        return;
+    }
 
-    for (auto& [clientId, socket] : m_sockets)
+    for (auto& shard : m_shards)
     {
-        (void)socket; // unused
-        sendMessage(clientId, message);
+        std::lock_guard<std::mutex> lock(shard->mutexSockets);
+
+        for (auto& connection : shard->connections.values())
+        {
+            sendMessage(connection.clientId, message);
+        }
     }
 }
 
@@ -111,155 +284,397 @@ void MessageQueueServer::broadcastMessage(std::shared_ptr<messages::Message> mes
 // -----------------------------------------------------------------
 void MessageQueueServer::broadcastMessageWithLastId(std::shared_ptr<messages::Message> message)
 {
-    std::lock_guard<std::mutex> lock(m_mutexSockets);
+    if (m_ioUring)
+    {
+        std::lock_guard<std::mutex> lock(m_shards[0]->mutexSockets);
+        m_ioUring->forEachClient([this, &message](std::uint64_t clientId) { sendMessageWithLastId(clientId, message); });
+        return;
+    }
 
-    for (auto& [clientId, socket] : m_sockets)
+    for (auto& shard : m_shards)
     {
-        (void)socket; // unused
-        sendMessageWithLastId(clientId, message);
+        std::lock_guard<std::mutex> lock(shard->mutexSockets);
+
+        for (auto& connection : shard->connections.values())
+        {
+            sendMessageWithLastId(connection.clientId, message);
+        }
     }
 }
 
 // --------------------------------------------------------------
 //
-// Returns the queue of all messages received since the last time
-// this method was called.
+// Returns the queue of all messages received, across all shards,
+// since the last time this method was called.
 //
 // --------------------------------------------------------------
 std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> MessageQueueServer::getMessages()
 {
     std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> copy;
 
-    std::lock_guard<std::mutex> lock(m_mutexReceivedMessages);
-    std::swap(copy, m_receivedMessages);
+    for (auto& shard : m_shards)
+    {
+        std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> received;
+        std::queue<std::tuple<messages::Type, std::string>> raw;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutexReceivedMessages);
+            std::swap(received, shard->receivedMessages);
+            std::swap(raw, shard->receivedRaw);
+            shard->receivedQueueDepth.set(0);
+        }
+
+        //
+        // The raw messages are in the same order as the parsed ones
+        if (m_recorder)
+        {
+            auto parsed = received;
+            while (!raw.empty())
+            {
+                auto& [clientId, message] = parsed.front();
+                auto& [type, data] = raw.front();
+                m_recorder->message(clientId, message->getReceivedTime(), type, data);
+                parsed.pop();
+                raw.pop();
+            }
+        }
+
+        if (copy.empty())
+        {
+            std::swap(copy, received);
+        }
+        while (!received.empty())
+        {
+            copy.push(std::move(received.front()));
+            received.pop();
+        }
+    }
+    PROFILE_COUNTER("Received messages", copy.size());
 
     return copy;
 }
 
 // --------------------------------------------------------------
 //
-// Utility to combine an IP address value and Port into a single
-// 64 bit number for unique identification of each client.
+// The game model marks the start of each update in the traffic log.
+//
+// --------------------------------------------------------------
+void MessageQueueServer::recordTick(std::chrono::microseconds elapsedTime, std::chrono::steady_clock::time_point now)
+{
+    if (m_recorder)
+    {
+        m_recorder->tick(elapsedTime, now);
+    }
+}
+
+// --------------------------------------------------------------
+//
+// These stand in for the socket threads during a replay.
 //
 // --------------------------------------------------------------
-std::uint64_t MessageQueueServer::socketToId(sf::TcpSocket* socket)
+void MessageQueueServer::replayConnect(std::uint64_t clientId)
 {
-    std::uint64_t id = socket->getRemoteAddress().toInteger() + (static_cast<std::uint64_t>(socket->getRemotePort()) << 32);
-    return id;
+    m_shards[0]->connections.emplace(clientId, {clientId, nullptr, std::nullopt});
+    m_connectHandler(clientId);
+}
+
+void MessageQueueServer::replayDisconnect(std::uint64_t clientId)
+{
+    m_shards[0]->connections.erase(clientId);
+    m_disconnectHandler(clientId);
+}
+
+void MessageQueueServer::replayMessage(std::uint64_t clientId, std::chrono::steady_clock::time_point received, messages::Type type, const std::string& data)
+{
+    //
+    // Messages still queued when their client disconnected are delivered
+    // all the same, just as they are live.
+    auto& shard = *m_shards[0];
+    if (m_messageCommand.find(type) == m_messageCommand.end())
+    {
+        return;
+    }
+    Connection disconnected{clientId, nullptr, std::nullopt};
+    auto connection = shard.connections.get(clientId);
+    receiveMessage(shard, connection ? *connection : disconnected, type, data);
+    std::get<1>(shard.receivedMessages.back())->setReceivedTime(received);
+}
+
+// --------------------------------------------------------------
+//
+// A connection in slot i of shard s has the client id with index
+// i * shardCount + s (and the slot's generation).
+//
+// --------------------------------------------------------------
+std::uint64_t MessageQueueServer::toClientId(const Shard& shard, SlotTable<Connection>::Key key)
+{
+    auto index = SlotTable<Connection>::index(key) * static_cast<std::uint32_t>(m_shards.size()) + shard.index;
+    return SlotTable<Connection>::makeKey(index, SlotTable<Connection>::generation(key));
+}
+
+SlotTable<MessageQueueServer::Connection>::Key MessageQueueServer::toConnectionKey(std::uint64_t clientId)
+{
+    auto index = SlotTable<Connection>::index(clientId) / static_cast<std::uint32_t>(m_shards.size());
+    return SlotTable<Connection>::makeKey(index, SlotTable<Connection>::generation(clientId));
+}
+
+// --------------------------------------------------------------
+//
+// Returns the shard that owns the connection for a client id.
+//
+// --------------------------------------------------------------
+MessageQueueServer::Shard& MessageQueueServer::idToShard(std::uint64_t clientId)
+{
+    return *m_shards[SlotTable<Connection>::index(clientId) % m_shards.size()];
 }
 
 // --------------------------------------------------------------
 //
 // Listen for incoming client connections.  As a connection is made
 // remember it and begin listening for messages over that socket.
+// When this shard has its own SO_REUSEPORT listener, the connection
+// stays with this shard, otherwise connections are spread across
+// all shards.
 //
 // --------------------------------------------------------------
-void MessageQueueServer::initializeListener(std::uint16_t listenPort)
+bool MessageQueueServer::initializeListener(Shard& shard, std::uint16_t listenPort, bool reusePort)
 {
-    m_threadListener = std::thread([listenPort, this]() {
-        if (m_listener.listen(listenPort) != sf::Socket::Done)
+    if (reusePort)
+    {
+        auto listener = std::make_unique<ReusePortListener>();
+        if (!listener->listen(listenPort))
         {
-            std::cout << "error initializing network socket" << std::endl;
+            std::cout << "unable to use SO_REUSEPORT for shard " << shard.index << std::endl;
+            return false;
         }
-        else
+        shard.listener = std::move(listener);
+    }
+    else
+    {
+        shard.listener = std::make_unique<sf::TcpListener>();
+        if (shard.listener->listen(listenPort) != sf::Socket::Done)
         {
-            std::cout << "successfully initialized sockets" << std::endl;
+            std::cout << "error initializing network socket" << std::endl;
+            return false;
         }
+    }
+    std::cout << "successfully initialized sockets" << std::endl;
 
+    shard.threadListener = std::thread([&shard, reusePort, this]() {
+        PROFILE_THREAD("Shard " + std::to_string(shard.index) + " listener");
         while (m_keepRunning)
         {
             auto socket = std::make_unique<sf::TcpSocket>();
-            if (m_listener.accept(*socket) != sf::Socket::Done)
+            if (shard.listener->accept(*socket) != sf::Socket::Done)
             {
                 std::cout << "error in accepting client connection" << std::endl;
             }
             else
             {
+                PROFILE_SCOPE("MessageQueueServer::accept");
                 std::cout << "new client connection accepted" << std::endl;
-                m_selector.add(*socket);
-                auto clientId = socketToId(socket.get());
-                {
-                    std::lock_guard<std::mutex> lock(m_mutexSockets);
-                    m_sockets[clientId] = std::move(socket);
-                }
-                m_connectHandler(clientId);
+                auto& owner = reusePort ? shard : *m_shards[m_nextShard++ % m_shards.size()];
+                addConnection(owner, std::move(socket));
             }
         }
 
         std::cout << "incoming network connection listener shutdown" << std::endl;
     });
+
+    return true;
 }
 
 // --------------------------------------------------------------
 //
-// Prepares the message queue for sending of messages.  As messages
-// are added to the queue of messages to send, the thread created
-// in this method sends them as soon as it can.
+// Starts the io_uring transport, with its connections feeding the
+// single shard's received message queue.
 //
 // --------------------------------------------------------------
-void MessageQueueServer::initializeSender()
+bool MessageQueueServer::initializeIoUring(std::uint16_t listenPort)
 {
-    m_threadSender = std::thread([this]() {
+    auto& shard = *m_shards[0];
+    m_ioUring = std::make_unique<IoUringTransport>();
+    auto success = m_ioUring->initialize(
+        listenPort,
+        [this, &shard](std::uint64_t clientId) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutexSockets);
+                shard.connections.emplace(clientId, {clientId, nullptr, std::nullopt});
+            }
+            m_connectionCount.add(1);
+            if (m_recorder)
+            {
+                m_recorder->connect(clientId, std::chrono::steady_clock::now());
+            }
+            m_connectHandler(clientId);
+        },
+        [this, &shard](std::uint64_t clientId, messages::Type type, const std::string& data) {
+            std::lock_guard<std::mutex> lock(shard.mutexSockets);
+            if (auto connection = shard.connections.get(clientId))
+            {
+                receiveMessage(shard, *connection, type, data);
+            }
+        },
+        [this, &shard](std::uint64_t clientId) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutexSockets);
+                shard.connections.erase(clientId);
+            }
+            m_connectionCount.add(-1);
+            if (m_recorder)
+            {
+                m_recorder->disconnect(clientId, std::chrono::steady_clock::now());
+            }
+            m_disconnectHandler(clientId);
+        });
+
+    if (!success)
+    {
+        m_ioUring.reset();
+    }
+
+    return success;
+}
+
+// --------------------------------------------------------------
+//
+// Makes the new connection part of the shard and lets the game
+// model know about it.
+//
+// --------------------------------------------------------------
+void MessageQueueServer::addConnection(Shard& shard, std::unique_ptr<sf::TcpSocket> socket)
+{
+    std::uint64_t clientId;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutexSockets);
+        shard.selector.add(*socket);
+        auto key = shard.connections.insert({0, std::move(socket), std::nullopt});
+        clientId = toClientId(shard, key);
+        shard.connections.get(key)->clientId = clientId;
+    }
+    m_connectionCount.add(1);
+    if (m_recorder)
+    {
+        m_recorder->connect(clientId, std::chrono::steady_clock::now());
+    }
+    m_connectHandler(clientId);
+}
+
+// --------------------------------------------------------------
+//
+// Serializes the message along with the header that precedes it on
+// the wire: the message type and the size of data to expect.
+//
+// A broadcast message is shared by every client, and framed by each
+// shard's sender thread, so it is never changed here.  The client's
+// sequence number, for the messages that have one, is given to the
+// serialization instead.
+//
+// --------------------------------------------------------------
+std::string MessageQueueServer::frameMessage(const std::shared_ptr<messages::Message>& message, std::optional<std::uint32_t> messageId)
+{
+    std::string serialized = messageId ? message->serializeWithMessageId(messageId.value()) : message->serializeToString();
+    auto type = static_cast<std::size_t>(message->getType());
+    if (type < MESSAGE_TYPE_NAMES.size())
+    {
+        m_messagesSent[type]->add();
+        m_bytesSent[type]->add(5 + serialized.size());
+    }
+
+    std::string frame;
+    frame.reserve(5 + serialized.size());
+    frame.push_back(static_cast<char>(message->getType()));
+    std::uint32_t messageSize = htonl(static_cast<std::uint32_t>(serialized.size()));
+    frame.append(reinterpret_cast<const char*>(&messageSize), sizeof(messageSize));
+    frame.append(serialized);
+
+    return frame;
+}
+
+// --------------------------------------------------------------
+//
+// Parses a received message and adds it to the shard's queue of
+// received messages.  The caller holds the shard's socket mutex.
+//
+// --------------------------------------------------------------
+void MessageQueueServer::receiveMessage(Shard& shard, Connection& connection, messages::Type type, const std::string& data)
+{
+    auto command = m_messageCommand.find(type);
+    if (command == m_messageCommand.end())
+    {
+        return;
+    }
+
+    m_messagesReceived[static_cast<std::size_t>(type)]->add();
+    m_bytesReceived[static_cast<std::size_t>(type)]->add(5 + data.size());
+
+    auto message = command->second();
+    message->setReceivedTime(std::chrono::steady_clock::now());
+    if (data.size() > 0)
+    {
+        message->parseFromString(data);
+        if (message->getMessageId())
+        {
+            connection.lastMessageId = message->getMessageId();
+        }
+    }
+    std::lock_guard<std::mutex> lock(shard.mutexReceivedMessages);
+    shard.receivedMessages.push(std::make_tuple(connection.clientId, message));
+    shard.receivedQueueDepth.add(1);
+    if (m_recorder)
+    {
+        shard.receivedRaw.push(std::make_tuple(type, data));
+    }
+}
+
+// --------------------------------------------------------------
+//
+// Prepares the shard's message queue for sending of messages.  As
+// messages are added to the queue of messages to send, the thread
+// created in this method sends them as soon as it can.
+//
+// --------------------------------------------------------------
+void MessageQueueServer::initializeSender(Shard& shard)
+{
+    shard.threadSender = std::thread([&shard, this]() {
+        PROFILE_THREAD("Shard " + std::to_string(shard.index) + " sender");
         std::unordered_set<std::uint64_t> disconnectedClient;
         while (m_keepRunning)
         {
-            auto item = m_sendMessages.dequeue();
+            auto item = shard.sendMessages.dequeue();
             if (item)
             {
+                PROFILE_SCOPE("MessageQueueServer::send");
+                shard.sendQueueDepth.add(-1);
                 // Destructure and send
                 auto& [clientId, messageId, message] = item.value();
-                // Creating this scope so the m_mutexSockets is released, allowing the removeDisconnected function
+                // Creating this scope so the mutexSockets is released, allowing the removeDisconnected function
                 // to be called, because it also wants to grab that mutex.
                 // Note: Might be able to use a recursive_mutex instead
                 {
-                    std::lock_guard<std::mutex> lock(m_mutexSockets);
-                    if (m_sockets.find(clientId) != m_sockets.end())
+                    std::unique_lock<std::mutex> lock(shard.mutexSockets, std::defer_lock);
                     {
-                        // Some messages have a sequence number associated with them, if they do,
-                        // then set it on the message.
-                        if (messageId)
-                        {
-                            if (message->getType() == messages::Type::UpdateEntity)
-                            {
-                                message->setMessageId(messageId.value());
-                            }
-                        }
-                        std::string serialized = message->serializeToString();
-
-                        //
-                        // Need to send a header before the message data that specifies
-                        // the message type and the size of data to expect.
-                        std::array<std::uint8_t, 5> header;
-                        header[0] = static_cast<std::uint8_t>(message->getType());
-                        std::uint32_t messageSize = htonl(static_cast<std::uint32_t>(serialized.size()));
-                        std::uint8_t* ptrSize = reinterpret_cast<std::uint8_t*>(&messageSize);
-                        header[1] = ptrSize[0];
-                        header[2] = ptrSize[1];
-                        header[3] = ptrSize[2];
-                        header[4] = ptrSize[3];
-
-                        // Send the header
-                        m_sockets[clientId]->send(header.data(), header.size());
-                        // Send the message body
-                        if (serialized.size() > 0)
+                        PROFILE_SCOPE("MessageQueueServer::lockSockets");
+                        lock.lock();
+                    }
+                    if (auto connection = shard.connections.get(toConnectionKey(clientId)))
+                    {
+                        std::string frame = frameMessage(message, messageId);
+                        auto status = connection->socket->send(static_cast<void*>(frame.data()), frame.size());
+                        if (status == sf::Socket::Disconnected)
                         {
-                            auto status = m_sockets[clientId]->send(static_cast<void*>(serialized.data()), serialized.size());
-                            if (status == sf::Socket::Disconnected)
-                            {
-                                disconnectedClient.insert(clientId);
-                            }
+                            disconnectedClient.insert(clientId);
                         }
                     }
                 }
-                removeDisconnected(disconnectedClient);
+                removeDisconnected(shard, disconnectedClient);
             }
             else
             {
                 //
                 // If no messages available to send, then wait until an event
                 // is fired letting us know one is now ready to send.
-                std::unique_lock<std::mutex> lock(m_mutexEventSendMessages);
-                m_eventSendMessages.wait(lock);
+                std::unique_lock<std::mutex> lock(shard.mutexEventSendMessages);
+                shard.eventSendMessages.wait(lock);
             }
         }
     });
@@ -267,25 +682,32 @@ void MessageQueueServer::initializeSender()
 
 // --------------------------------------------------------------
 //
-// Sets up a thread that listens for incoming messages on all
-// known client sockets.  If there is something to receive on a
-// socket, the message is read, parsed, and added to the queue
-// of received messages.
+// Sets up a thread that listens for incoming messages on all of
+// the shard's client sockets.  If there is something to receive
+// on a socket, the message is read, parsed, and added to the shard's
+// queue of received messages.
 //
 // --------------------------------------------------------------
-void MessageQueueServer::initializeReceiver()
+void MessageQueueServer::initializeReceiver(Shard& shard)
 {
-    m_threadReceiver = std::thread([this]() {
+    shard.threadReceiver = std::thread([&shard, this]() {
+        PROFILE_THREAD("Shard " + std::to_string(shard.index) + " receiver");
         std::unordered_set<std::uint64_t> disconnectedClients;
         while (m_keepRunning)
         {
-            if (m_selector.wait(sf::seconds(1.0f)))
+            if (shard.selector.wait(sf::seconds(1.0f)))
             {
+                PROFILE_SCOPE("MessageQueueServer::receive");
                 // Have to iterate through all of them to find out which one(s) are ready
-                std::lock_guard<std::mutex> lockSockets(m_mutexSockets);
-                for (auto& [clientId, socket] : m_sockets)
+                std::unique_lock<std::mutex> lockSockets(shard.mutexSockets, std::defer_lock);
                 {
-                    if (m_selector.isReady(*socket))
+                    PROFILE_SCOPE("MessageQueueServer::lockSockets");
+                    lockSockets.lock();
+                }
+                for (auto& connection : shard.connections.values())
+                {
+                    auto& socket = connection.socket;
+                    if (shard.selector.isReady(*socket))
                     {
                         std::array<messages::Type, 1> type;
                         std::array<uint32_t, 1> size;
@@ -299,33 +721,17 @@ void MessageQueueServer::initializeReceiver()
                                 size[0] = ntohl(size[0]);
                                 //
                                 // The message may not have any payload, don't try to read in that case
-                                if (size[0] > 0)
-                                {
-                                    std::string data;
-                                    data.resize(size[0]);
-                                    if (socket->receive(data.data(), size[0], received) == sf::Socket::Done)
-                                    {
-                                        auto message = m_messageCommand[type[0]]();
-                                        message->parseFromString(data);
-                                        if (message->getMessageId())
-                                        {
-                                            m_clientLastMessageId[clientId] = message->getMessageId().value();
-                                        }
-                                        std::lock_guard<std::mutex> lock(m_mutexReceivedMessages);
-                                        m_receivedMessages.push(std::make_tuple(socketToId(socket.get()), message));
-                                    }
-                                }
-                                else
+                                std::string data;
+                                data.resize(size[0]);
+                                if (size[0] == 0 || socket->receive(data.data(), size[0], received) == sf::Socket::Done)
                                 {
-                                    auto message = m_messageCommand[type[0]]();
-                                    std::lock_guard<std::mutex> lock(m_mutexReceivedMessages);
-                                    m_receivedMessages.push(std::make_tuple(socketToId(socket.get()), message));
+                                    receiveMessage(shard, connection, type[0], data);
                                 }
                             }
                         }
                         else if (status == sf::Socket::Disconnected)
                         {
-                            disconnectedClients.insert(clientId);
+                            disconnectedClients.insert(connection.clientId);
                         }
                     }
                 }
@@ -338,13 +744,13 @@ void MessageQueueServer::initializeReceiver()
                 // to sleep for a bit.  I know a condition_variable could be used to be even more
                 // efficient, but I didn't do that because it adds complexity for a benefit that
                 // isn't necessary.
-                if (m_sockets.size() == 0)
+                if (shard.connections.empty())
                 {
                     std::this_thread::sleep_for(std::chrono::microseconds(500000));
                 }
             }
 
-            removeDisconnected(disconnectedClients);
+            removeDisconnected(shard, disconnectedClients);
         }
     });
 }
@@ -352,22 +758,33 @@ void MessageQueueServer::initializeReceiver()
 // --------------------------------------------------------------
 //
 // For any clients that are no longer connected, they are removed
-// from the socket selector, along with being remove from the
-// list of active sockets maintained by this message queue.
+// from the shard's socket selector, along with being remove from the
+// list of active sockets maintained by the shard.
 //
 // --------------------------------------------------------------
-void MessageQueueServer::removeDisconnected(std::unordered_set<std::uint64_t>& clients)
+void MessageQueueServer::removeDisconnected(Shard& shard, std::unordered_set<std::uint64_t>& clients)
 {
     if (clients.size() > 0)
     {
         {
-            std::lock_guard<std::mutex> lock(m_mutexSockets);
-            for (auto clientId : clients)
+            std::lock_guard<std::mutex> lock(shard.mutexSockets);
+            for (auto clientId = clients.begin(); clientId != clients.end();)
             {
-                auto& socket = m_sockets[clientId];
-                m_selector.remove(*socket);
-                m_sockets.erase(clientId);
-                m_clientLastMessageId.erase(clientId);
+                //
+                // Both the sender and receiver may have noticed the same disconnect,
+                // only the first to remove the connection reports it.
+                auto key = toConnectionKey(*clientId);
+                auto connection = shard.connections.get(key);
+                if (connection != nullptr)
+                {
+                    shard.selector.remove(*connection->socket);
+                    shard.connections.erase(key);
+                    ++clientId;
+                }
+                else
+                {
+                    clientId = clients.erase(clientId);
+                }
             }
         }
         //
@@ -378,6 +795,11 @@ void MessageQueueServer::removeDisconnected(std::unordered_set<std::uint64_t>& c
         // I'll keep thinking about this to find a better overall solution.
         for (auto clientId : clients)
         {
+            m_connectionCount.add(-1);
+            if (m_recorder)
+            {
+                m_recorder->disconnect(clientId, std::chrono::steady_clock::now());
+            }
             m_disconnectHandler(clientId);
         }
         clients.clear();
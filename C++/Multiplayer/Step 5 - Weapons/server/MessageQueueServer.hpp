@@ -1,9 +1,16 @@
 #pragma once
 
 #include "ConcurrentQueue.hpp"
+#include "IoUringTransport.hpp"
+#include "Metrics.hpp"
+#include "SlotTable.hpp"
+#include "TrafficLog.hpp"
 #include "messages/Message.hpp"
 
 #include <SFML/Network.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
@@ -11,16 +18,36 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 // --------------------------------------------------------------
 //
 // This provides the network message communication for the server.
 // All connections and messages to and from clients are served here.
 //
+// Connections are spread across one or more shards.  Each shard has
+// its own sockets, selector, outbound queue, received message queue
+// and threads, so shards never contend with each other for a lock.
+//
+// Each shard keeps its connections in a SlotTable.  A client id is a
+// SlotTable key whose index interleaves the shards' slot indices, so
+// the owning shard and the slot are both found with arithmetic, and
+// client ids stay small and dense across all shards.
+//
+// On Linux, an io_uring transport can be used in place of the shards'
+// socket threads.  It is selected at initialization, if it isn't
+// available the socket threads are used instead.
+//
+// Everything coming in from clients can be recorded to a traffic log.
+// For replaying a log, the queue can also be initialized without any
+// sockets: the connects, disconnects and messages are handed to it
+// directly and the messages sent are serialized, then discarded.
+//
 // Note: This is a Singleton
 //
 // --------------------------------------------------------------
@@ -38,8 +65,10 @@ class MessageQueueServer
         return instance;
     }
 
-    bool initialize(std::uint16_t listenPort);
+    bool initialize(std::uint16_t listenPort, std::uint16_t shardCount = 1, bool reusePort = false, bool useIoUring = false);
+    bool initializeReplay();
     void shutdown();
+    void flush();
     void registerConnectHandler(std::function<void(std::uint64_t)> handler) { m_connectHandler = handler; }
     void registerDisconnectHandler(std::function<void(std::uint64_t)> handler) { m_disconnectHandler = handler; }
 
@@ -49,34 +78,94 @@ class MessageQueueServer
     void broadcastMessageWithLastId(std::shared_ptr<messages::Message> message);
     std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> getMessages();
 
+    //
+    // Recording must be started before initializing
+    void startRecording(std::shared_ptr<traffic::Recorder> recorder) { m_recorder = recorder; }
+    void recordTick(std::chrono::microseconds elapsedTime, std::chrono::steady_clock::time_point now);
+
+    void replayConnect(std::uint64_t clientId);
+    void replayDisconnect(std::uint64_t clientId);
+    void replayMessage(std::uint64_t clientId, std::chrono::steady_clock::time_point received, messages::Type type, const std::string& data);
+    auto getReplayBytesSent() const { return m_replayBytesSent; }
+
   private:
     MessageQueueServer() {}
 
-    bool m_keepRunning{true};
-    std::thread m_threadListener;
-    std::thread m_threadSender;
-    std::thread m_threadReceiver;
-    std::unordered_map<messages::Type, std::function<std::shared_ptr<messages::Message>(void)>> m_messageCommand;
+    struct Connection
+    {
+        std::uint64_t clientId{0};
+        std::unique_ptr<sf::TcpSocket> socket;
+        std::optional<std::uint32_t> lastMessageId;
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Everything needed to serve one subset of the client connections.
+    //
+    // --------------------------------------------------------------
+    struct Shard
+    {
+        Shard(std::uint16_t index) :
+            index(index),
+            sendQueueDepth(metrics::Registry::instance().gauge("server_send_queue_depth", {{"shard", std::to_string(index)}})),
+            receivedQueueDepth(metrics::Registry::instance().gauge("server_received_queue_depth", {{"shard", std::to_string(index)}}))
+        {
+        }
+
+        std::uint16_t index{0};
+        std::thread threadListener;
+        std::thread threadSender;
+        std::thread threadReceiver;
+        std::unique_ptr<sf::TcpListener> listener;
+
+        ConcurrentQueue<std::tuple<std::uint64_t, std::optional<std::uint32_t>, std::shared_ptr<messages::Message>>> sendMessages;
+        std::condition_variable eventSendMessages;
+        std::mutex mutexEventSendMessages;
+
+        std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> receivedMessages;
+        std::queue<std::tuple<messages::Type, std::string>> receivedRaw; // only filled when recording
+        std::mutex mutexReceivedMessages;
+
+        sf::SocketSelector selector;
+        SlotTable<Connection> connections;
+        std::mutex mutexSockets;
 
-    ConcurrentQueue<std::tuple<std::uint64_t, std::optional<std::uint32_t>, std::shared_ptr<messages::Message>>> m_sendMessages;
-    std::condition_variable m_eventSendMessages;
-    std::mutex m_mutexEventSendMessages;
+        metrics::Gauge& sendQueueDepth;
+        metrics::Gauge& receivedQueueDepth;
+    };
 
-    std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> m_receivedMessages;
-    std::mutex m_mutexReceivedMessages;
-    std::unordered_map<std::uint64_t, std::uint32_t> m_clientLastMessageId;
+    //
+    // Indexed by messages::Type, for labeling the per-type metrics
+    static constexpr std::array<const char*, 10> MESSAGE_TYPE_NAMES = {"ConnectAck", "NewEntity", "UpdateEntity", "RemoveEntity", "Join", "Input", "WorldState", "Ping", "Pong", "JoinAck"};
+    std::array<metrics::Counter*, MESSAGE_TYPE_NAMES.size()> m_messagesSent;
+    std::array<metrics::Counter*, MESSAGE_TYPE_NAMES.size()> m_bytesSent;
+    std::array<metrics::Counter*, MESSAGE_TYPE_NAMES.size()> m_messagesReceived;
+    std::array<metrics::Counter*, MESSAGE_TYPE_NAMES.size()> m_bytesReceived;
+    metrics::Gauge& m_connectionCount{metrics::Registry::instance().gauge("server_connections")};
+
+    std::atomic<bool> m_keepRunning{true}; // read by the network threads, cleared by shutdown
+    std::unordered_map<messages::Type, std::function<std::shared_ptr<messages::Message>(void)>> m_messageCommand;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<std::uint16_t> m_nextShard{0};
+    std::unique_ptr<IoUringTransport> m_ioUring;
+    std::shared_ptr<traffic::Recorder> m_recorder;
+    bool m_replay{false};
+    std::uint64_t m_replayBytesSent{0};
 
-    sf::SocketSelector m_selector;
-    sf::TcpListener m_listener;
     std::function<void(std::uint64_t)> m_connectHandler;
     std::function<void(std::uint64_t)> m_disconnectHandler;
-    std::unordered_map<std::uint64_t, std::unique_ptr<sf::TcpSocket>> m_sockets;
-    std::unique_ptr<sf::TcpSocket> m_socketServer;
-    std::mutex m_mutexSockets;
-
-    std::uint64_t socketToId(sf::TcpSocket* socket);
-    void initializeListener(std::uint16_t listenPort);
-    void initializeSender();
-    void initializeReceiver();
-    void removeDisconnected(std::unordered_set<std::uint64_t>& removeThese);
+
+    std::uint64_t toClientId(const Shard& shard, SlotTable<Connection>::Key key);
+    SlotTable<Connection>::Key toConnectionKey(std::uint64_t clientId);
+    Shard& idToShard(std::uint64_t clientId);
+    void registerMessages();
+    bool initializeListener(Shard& shard, std::uint16_t listenPort, bool reusePort);
+    void initializeSender(Shard& shard);
+    void initializeReceiver(Shard& shard);
+    bool initializeIoUring(std::uint16_t listenPort);
+    void addConnection(Shard& shard, std::unique_ptr<sf::TcpSocket> socket);
+    std::string frameMessage(const std::shared_ptr<messages::Message>& message, std::optional<std::uint32_t> messageId);
+    void receiveMessage(Shard& shard, Connection& connection, messages::Type type, const std::string& data);
+    void removeDisconnected(Shard& shard, std::unordered_set<std::uint64_t>& removeThese);
 };
@@ -0,0 +1,235 @@
+#include "Metrics.hpp"
+
+#if defined(METRICS_ENABLED)
+    #include <algorithm>
+    #include <filesystem>
+    #include <fstream>
+    #include <iostream>
+    #include <set>
+
+namespace metrics
+{
+    // --------------------------------------------------------------
+    //
+    // Each thread is given its own shard, round robin, the first time
+    // it touches a counter.
+    //
+    // --------------------------------------------------------------
+    std::size_t Counter::shard()
+    {
+        static std::atomic<std::size_t> nextShard{0};
+        thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+
+    std::uint64_t Counter::value() const
+    {
+        std::uint64_t total = 0;
+        for (auto& shard : m_shards)
+        {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void Histogram::observe(std::chrono::microseconds duration)
+    {
+        auto value = static_cast<std::uint64_t>(std::max(duration.count(), static_cast<std::chrono::microseconds::rep>(0)));
+        std::size_t bucket = 0;
+        while (bucket < BOUNDS.size() && value > BOUNDS[bucket])
+        {
+            bucket++;
+        }
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Prometheus histograms have cumulative buckets, a sum and a count.
+    //
+    // --------------------------------------------------------------
+    void Histogram::write(std::ostream& out, const std::string& name, const std::string& labels) const
+    {
+        auto withLe = [&labels](const std::string& le) {
+            return "{" + labels + (labels.empty() ? "" : ",") + "le=\"" + le + "\"}";
+        };
+
+        std::uint64_t count = 0;
+        for (std::size_t bucket = 0; bucket < m_buckets.size(); bucket++)
+        {
+            count += m_buckets[bucket].load(std::memory_order_relaxed);
+            auto le = bucket < BOUNDS.size() ? std::to_string(BOUNDS[bucket]) : "+Inf";
+            out << name << "_bucket" << withLe(le) << " " << count << "\n";
+        }
+        auto braces = labels.empty() ? "" : "{" + labels + "}";
+        out << name << "_sum" << braces << " " << m_sum.load(std::memory_order_relaxed) << "\n";
+        out << name << "_count" << braces << " " << count << "\n";
+    }
+
+    Registry::Key Registry::makeKey(const std::string& name, const Labels& labels)
+    {
+        std::string formatted;
+        for (auto& [label, value] : labels)
+        {
+            formatted += (formatted.empty() ? "" : ",") + label + "=\"" + value + "\"";
+        }
+        return {name, formatted};
+    }
+
+    Counter& Registry::counter(const std::string& name, const Labels& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& counter = m_counters[makeKey(name, labels)];
+        if (!counter)
+        {
+            counter = std::make_unique<Counter>();
+        }
+        return *counter;
+    }
+
+    Gauge& Registry::gauge(const std::string& name, const Labels& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& gauge = m_gauges[makeKey(name, labels)];
+        if (!gauge)
+        {
+            gauge = std::make_unique<Gauge>();
+        }
+        return *gauge;
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const Labels& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& histogram = m_histograms[makeKey(name, labels)];
+        if (!histogram)
+        {
+            histogram = std::make_unique<Histogram>();
+        }
+        return *histogram;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // For metrics that belong to something that goes away, like a
+    // client connection.  Any reference to the metric is invalid after
+    // this.
+    //
+    // --------------------------------------------------------------
+    void Registry::remove(const std::string& name, const Labels& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto key = makeKey(name, labels);
+        m_counters.erase(key);
+        m_gauges.erase(key);
+        m_histograms.erase(key);
+    }
+
+    void GaugeFamily::add(std::uint64_t id)
+    {
+        m_gauges[id] = &Registry::instance().gauge(m_name, {{m_label, std::to_string(id)}});
+    }
+
+    void GaugeFamily::remove(std::uint64_t id)
+    {
+        if (m_gauges.erase(id) > 0)
+        {
+            Registry::instance().remove(m_name, {{m_label, std::to_string(id)}});
+        }
+    }
+
+    void GaugeFamily::set(std::uint64_t id, std::int64_t value)
+    {
+        auto gauge = m_gauges.find(id);
+        if (gauge != m_gauges.end())
+        {
+            gauge->second->set(value);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Writes all the metrics in the Prometheus text format.  The maps
+    // are ordered by name, so all the labels of a metric are together.
+    //
+    // --------------------------------------------------------------
+    void Registry::write(std::ostream& out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::set<std::string> typed;
+        auto type = [&out, &typed](const std::string& name, const char* kind) {
+            if (typed.insert(name).second)
+            {
+                out << "# TYPE " << name << " " << kind << "\n";
+            }
+        };
+        auto braces = [](const std::string& labels) { return labels.empty() ? "" : "{" + labels + "}"; };
+
+        for (auto& [key, counter] : m_counters)
+        {
+            auto& [name, labels] = key;
+            type(name, "counter");
+            out << name << braces(labels) << " " << counter->value() << "\n";
+        }
+        for (auto& [key, gauge] : m_gauges)
+        {
+            auto& [name, labels] = key;
+            type(name, "gauge");
+            out << name << braces(labels) << " " << gauge->value() << "\n";
+        }
+        for (auto& [key, histogram] : m_histograms)
+        {
+            auto& [name, labels] = key;
+            type(name, "histogram");
+            histogram->write(out, name, labels);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Starts a thread that writes the metrics to the file every interval.
+    // The file is written beside and renamed over the old one, so a
+    // scraper never sees a partial file.
+    //
+    // --------------------------------------------------------------
+    bool Registry::startDump(std::string path, std::chrono::milliseconds interval)
+    {
+        m_keepDumping = true;
+        m_threadDump = std::thread([this, path, interval]() {
+            std::unique_lock<std::mutex> lock(m_mutexDump);
+            while (m_keepDumping)
+            {
+                m_eventStop.wait_for(lock, interval);
+
+                auto temporary = path + ".tmp";
+                {
+                    std::ofstream file(temporary, std::ios::trunc);
+                    if (!file)
+                    {
+                        std::cout << "Unable to write the metrics file: " << temporary << std::endl;
+                        continue;
+                    }
+                    write(file);
+                }
+                std::error_code error;
+                std::filesystem::rename(temporary, path, error);
+            }
+        });
+        return true;
+    }
+
+    void Registry::stopDump()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutexDump);
+            m_keepDumping = false;
+        }
+        m_eventStop.notify_one();
+        if (m_threadDump.joinable())
+        {
+            m_threadDump.join();
+        }
+    }
+} // namespace metrics
+#endif
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Counters, gauges and latency histograms for watching the server.
+//
+// Metrics are looked up by name (and labels) in the Registry once,
+// then updated through the returned reference, which is no more than
+// a relaxed atomic add.  Counters are sharded across cache lines so
+// threads bumping the same counter don't contend.
+//
+// The registry periodically writes every metric to a file in the
+// Prometheus text format, ready for a node_exporter style textfile
+// collector to scrape.
+//
+// Everything here compiles down to nothing unless METRICS_ENABLED is
+// defined (the METRICS CMake option).
+//
+// --------------------------------------------------------------
+namespace metrics
+{
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+#if defined(METRICS_ENABLED)
+    class Counter
+    {
+      public:
+        void add(std::uint64_t value = 1) { m_shards[shard()].value.fetch_add(value, std::memory_order_relaxed); }
+        std::uint64_t value() const;
+
+      private:
+        static constexpr std::size_t SHARDS = 8;
+        struct alignas(64) Shard
+        {
+            std::atomic<std::uint64_t> value{0};
+        };
+        std::array<Shard, SHARDS> m_shards;
+
+        static std::size_t shard();
+    };
+
+    class Gauge
+    {
+      public:
+        void set(std::int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(std::int64_t value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+        std::int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+      private:
+        std::atomic<std::int64_t> m_value{0};
+    };
+
+    class Histogram
+    {
+      public:
+        //
+        // Bucket upper bounds, in microseconds
+        static constexpr std::array<std::uint64_t, 16> BOUNDS = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+
+        void observe(std::chrono::microseconds duration);
+        void write(std::ostream& out, const std::string& name, const std::string& labels) const;
+
+      private:
+        std::array<std::atomic<std::uint64_t>, BOUNDS.size() + 1> m_buckets{}; // last one is +Inf
+        std::atomic<std::uint64_t> m_sum{0};
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Records the time from construction to destruction in a histogram.
+    //
+    // --------------------------------------------------------------
+    class Timer
+    {
+      public:
+        Timer(Histogram& histogram) :
+            m_histogram(histogram),
+            m_start(std::chrono::steady_clock::now())
+        {
+        }
+        ~Timer() { m_histogram.observe(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start)); }
+
+      private:
+        Histogram& m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Owns all the metrics and writes them out.
+    //
+    // Note: This is a Singleton
+    //
+    // --------------------------------------------------------------
+    class Registry
+    {
+      public:
+        Registry(const Registry&) = delete;
+        Registry(Registry&&) = delete;
+        Registry& operator=(const Registry&) = delete;
+        Registry& operator=(Registry&&) = delete;
+
+        static auto& instance()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        Counter& counter(const std::string& name, const Labels& labels = {});
+        Gauge& gauge(const std::string& name, const Labels& labels = {});
+        Histogram& histogram(const std::string& name, const Labels& labels = {});
+        void remove(const std::string& name, const Labels& labels = {});
+
+        bool startDump(std::string path, std::chrono::milliseconds interval);
+        void stopDump();
+        void write(std::ostream& out);
+
+      private:
+        Registry() {}
+
+        using Key = std::tuple<std::string, std::string>; // name, formatted labels
+
+        std::map<Key, std::unique_ptr<Counter>> m_counters;
+        std::map<Key, std::unique_ptr<Gauge>> m_gauges;
+        std::map<Key, std::unique_ptr<Histogram>> m_histograms;
+        std::mutex m_mutex;
+
+        bool m_keepDumping{false};
+        std::thread m_threadDump;
+        std::condition_variable m_eventStop;
+        std::mutex m_mutexDump;
+
+        static Key makeKey(const std::string& name, const Labels& labels);
+    };
+
+    // --------------------------------------------------------------
+    //
+    // One gauge for each of a changing set of things, like connected
+    // clients, labeled with the thing's id.  The gauge is looked up in
+    // the registry when its id is added and removed from the registry
+    // with it, setting it in between doesn't touch the registry.  Ids
+    // not added (or already removed) are ignored.  Only to be used from
+    // one thread.
+    //
+    // --------------------------------------------------------------
+    class GaugeFamily
+    {
+      public:
+        GaugeFamily(const char* name, const char* label) :
+            m_name(name),
+            m_label(label)
+        {
+        }
+
+        void add(std::uint64_t id);
+        void remove(std::uint64_t id);
+        void set(std::uint64_t id, std::int64_t value);
+
+      private:
+        std::string m_name;
+        std::string m_label;
+        std::unordered_map<std::uint64_t, Gauge*> m_gauges;
+    };
+#else
+    class Counter
+    {
+      public:
+        void add([[maybe_unused]] std::uint64_t value = 1) {}
+        std::uint64_t value() const { return 0; }
+    };
+
+    class Gauge
+    {
+      public:
+        void set([[maybe_unused]] std::int64_t value) {}
+        void add([[maybe_unused]] std::int64_t value) {}
+        std::int64_t value() const { return 0; }
+    };
+
+    class Histogram
+    {
+      public:
+        void observe([[maybe_unused]] std::chrono::microseconds duration) {}
+    };
+
+    class Timer
+    {
+      public:
+        Timer([[maybe_unused]] Histogram& histogram) {}
+    };
+
+    class Registry
+    {
+      public:
+        static auto& instance()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        Counter& counter([[maybe_unused]] const std::string& name, [[maybe_unused]] const Labels& labels = {}) { return m_counter; }
+        Gauge& gauge([[maybe_unused]] const std::string& name, [[maybe_unused]] const Labels& labels = {}) { return m_gauge; }
+        Histogram& histogram([[maybe_unused]] const std::string& name, [[maybe_unused]] const Labels& labels = {}) { return m_histogram; }
+        void remove([[maybe_unused]] const std::string& name, [[maybe_unused]] const Labels& labels = {}) {}
+
+        bool startDump([[maybe_unused]] std::string path, [[maybe_unused]] std::chrono::milliseconds interval) { return false; }
+        void stopDump() {}
+        void write([[maybe_unused]] std::ostream& out) {}
+
+      private:
+        Counter m_counter;
+        Gauge m_gauge;
+        Histogram m_histogram;
+    };
+
+    class GaugeFamily
+    {
+      public:
+        GaugeFamily([[maybe_unused]] const char* name, [[maybe_unused]] const char* label) {}
+
+        void add([[maybe_unused]] std::uint64_t id) {}
+        void remove([[maybe_unused]] std::uint64_t id) {}
+        void set([[maybe_unused]] std::uint64_t id, [[maybe_unused]] std::int64_t value) {}
+    };
+#endif
+} // namespace metrics
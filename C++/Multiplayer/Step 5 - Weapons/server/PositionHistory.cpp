@@ -0,0 +1,72 @@
+#include "PositionHistory.hpp"
+
+// --------------------------------------------------------------
+//
+// Adds the newest sample, dropping the oldest once the ring is full
+// or it has fallen outside of the history duration.
+//
+// --------------------------------------------------------------
+void PositionHistory::record(std::chrono::steady_clock::time_point time, math::Vector2f position, float radius)
+{
+    while (m_count > 0 && time - sample(0).time > DURATION)
+    {
+        m_first = (m_first + 1) % CAPACITY;
+        m_count--;
+    }
+
+    if (m_count == CAPACITY)
+    {
+        m_first = (m_first + 1) % CAPACITY;
+        m_count--;
+    }
+    m_samples[(m_first + m_count) % CAPACITY] = {time, position, radius};
+    m_count++;
+}
+
+// --------------------------------------------------------------
+//
+// Returns where the entity was at the given time.  Times before the
+// oldest sample or after the newest are clamped to those samples.
+//
+// --------------------------------------------------------------
+PositionHistory::Sample PositionHistory::at(std::chrono::steady_clock::time_point time) const
+{
+    if (m_count == 0)
+    {
+        return {time, math::Vector2f(), 0};
+    }
+    if (time <= sample(0).time)
+    {
+        return sample(0);
+    }
+    if (time >= sample(m_count - 1).time)
+    {
+        return sample(m_count - 1);
+    }
+
+    //
+    // Find the first sample after the time, the one before it is at or before the time
+    std::size_t low = 1;
+    std::size_t high = m_count - 1;
+    while (low < high)
+    {
+        auto middle = (low + high) / 2;
+        if (sample(middle).time <= time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    auto& before = sample(low - 1);
+    auto& after = sample(low);
+    auto fraction = std::chrono::duration<float>(time - before.time).count() / std::chrono::duration<float>(after.time - before.time).count();
+
+    return {
+        time,
+        before.position + (after.position - before.position) * fraction,
+        before.radius + (after.radius - before.radius) * fraction};
+}
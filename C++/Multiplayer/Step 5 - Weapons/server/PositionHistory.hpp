@@ -0,0 +1,43 @@
+#pragma once
+
+#include "misc/math.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+// --------------------------------------------------------------
+//
+// A short history of where an entity has been, used to rewind it to
+// the moment a client saw it.
+//
+// Samples are recorded once per update into a fixed ring of samples,
+// oldest to newest, so finding the two samples either side of a time
+// is a binary search over a flat array.  Positions between samples
+// are linearly interpolated.
+//
+// --------------------------------------------------------------
+class PositionHistory
+{
+  public:
+    static constexpr std::size_t CAPACITY = 32;
+    static constexpr auto DURATION = std::chrono::milliseconds(1000);
+
+    struct Sample
+    {
+        std::chrono::steady_clock::time_point time;
+        math::Vector2f position;
+        float radius{0};
+    };
+
+    void record(std::chrono::steady_clock::time_point time, math::Vector2f position, float radius);
+    Sample at(std::chrono::steady_clock::time_point time) const;
+    bool empty() const { return m_count == 0; }
+
+  private:
+    std::array<Sample, CAPACITY> m_samples;
+    std::size_t m_first{0}; // oldest sample
+    std::size_t m_count{0};
+
+    const Sample& sample(std::size_t index) const { return m_samples[(m_first + index) % CAPACITY]; }
+};
@@ -0,0 +1,205 @@
+#include "TrafficLog.hpp"
+
+#include <iostream>
+#include <iterator>
+
+namespace traffic
+{
+    static const std::string HEADER = "TRAFFIC1";
+
+    // --------------------------------------------------------------
+    //
+    // Starts a new log, replacing any that is already at the path.
+    //
+    // --------------------------------------------------------------
+    bool Recorder::open(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_file)
+        {
+            std::cout << "Unable to open the traffic log: " << path << std::endl;
+            return false;
+        }
+        m_file.write(HEADER.data(), HEADER.size());
+        m_start = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void Recorder::close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+        m_file.close();
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Marks the start of an update.  Everything recorded up to now is
+    // written out, so a crashed server loses at most one update.
+    //
+    // --------------------------------------------------------------
+    void Recorder::tick(std::chrono::microseconds elapsedTime, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file.write(m_buffer.data(), m_buffer.size());
+        m_file.flush();
+        m_buffer.clear();
+
+        m_buffer.push_back(static_cast<char>(Kind::Tick));
+        append(elapsedTime.count());
+        append(since(now));
+    }
+
+    void Recorder::connect(std::uint64_t clientId, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.push_back(static_cast<char>(Kind::Connect));
+        append(clientId);
+        append(since(now));
+    }
+
+    void Recorder::disconnect(std::uint64_t clientId, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.push_back(static_cast<char>(Kind::Disconnect));
+        append(clientId);
+        append(since(now));
+    }
+
+    void Recorder::message(std::uint64_t clientId, std::chrono::steady_clock::time_point received, messages::Type type, const std::string& data)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.push_back(static_cast<char>(Kind::Message));
+        append(clientId);
+        append(since(received));
+        m_buffer.push_back(static_cast<char>(type));
+        append(data.size());
+        m_buffer.append(data);
+    }
+
+    void Recorder::append(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    std::uint64_t Recorder::since(std::chrono::steady_clock::time_point time)
+    {
+        return time > m_start ? std::chrono::duration_cast<std::chrono::microseconds>(time - m_start).count() : 0;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The whole log is read into memory up front, so reading it back
+    // during a replay doesn't add file I/O to the time being measured.
+    //
+    // --------------------------------------------------------------
+    bool Reader::open(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "Unable to open the traffic log: " << path << std::endl;
+            return false;
+        }
+        m_log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (m_log.compare(0, HEADER.size(), HEADER) != 0)
+        {
+            std::cout << "Not a traffic log: " << path << std::endl;
+            return false;
+        }
+        m_position = HEADER.size();
+        return true;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Returns the next record, or nothing at the end of the log (or at
+    // a record cut short by the server stopping mid-write).
+    //
+    // --------------------------------------------------------------
+    std::optional<Record> Reader::next()
+    {
+        if (m_position >= m_log.size())
+        {
+            return std::nullopt;
+        }
+
+        Record record;
+        record.kind = static_cast<Kind>(m_log[m_position++]);
+        switch (record.kind)
+        {
+            case Kind::Tick:
+            {
+                auto elapsedTime = read();
+                auto time = read();
+                if (!elapsedTime || !time)
+                {
+                    return std::nullopt;
+                }
+                record.elapsedTime = std::chrono::microseconds(elapsedTime.value());
+                record.time = std::chrono::microseconds(time.value());
+            }
+            break;
+            case Kind::Connect:
+            case Kind::Disconnect:
+            {
+                auto clientId = read();
+                auto time = read();
+                if (!clientId || !time)
+                {
+                    return std::nullopt;
+                }
+                record.clientId = clientId.value();
+                record.time = std::chrono::microseconds(time.value());
+            }
+            break;
+            case Kind::Message:
+            {
+                auto clientId = read();
+                auto time = read();
+                if (!clientId || !time || m_position >= m_log.size())
+                {
+                    return std::nullopt;
+                }
+                record.type = static_cast<messages::Type>(m_log[m_position++]);
+                auto size = read();
+                if (!size || m_log.size() - m_position < size.value())
+                {
+                    return std::nullopt;
+                }
+                record.clientId = clientId.value();
+                record.time = std::chrono::microseconds(time.value());
+                record.data = m_log.substr(m_position, size.value());
+                m_position += size.value();
+            }
+            break;
+            default:
+                std::cout << "Unknown traffic log record: " << static_cast<int>(record.kind) << std::endl;
+                return std::nullopt;
+        }
+
+        return record;
+    }
+
+    std::optional<std::uint64_t> Reader::read()
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && m_position < m_log.size(); shift += 7)
+        {
+            auto byte = static_cast<std::uint8_t>(m_log[m_position++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+} // namespace traffic
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "messages/MessageTypes.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// --------------------------------------------------------------
+//
+// A log of everything that reaches the game model from the network:
+// the start of each update, client connects and disconnects, and every
+// message received, with its raw bytes.  The Replay target feeds a log
+// back through the GameModel without any sockets.
+//
+// The log is an 8 byte header followed by records, each a kind byte
+// and its fields, integers are LEB128 varints:
+//
+//      Tick:       elapsed time, time
+//      Connect:    client id, time
+//      Disconnect: client id, time
+//      Message:    client id, time, type (1 byte), size, bytes
+//
+// Times are microseconds since the recording started.  The messages
+// recorded after a Tick are the ones handed to that update.
+//
+// --------------------------------------------------------------
+namespace traffic
+{
+    enum class Kind : std::uint8_t
+    {
+        Tick,
+        Connect,
+        Disconnect,
+        Message
+    };
+
+    struct Record
+    {
+        Kind kind{Kind::Tick};
+        std::uint64_t clientId{0};
+        std::chrono::microseconds elapsedTime{0};
+        std::chrono::microseconds time{0};
+        messages::Type type{messages::Type::ConnectAck};
+        std::string data;
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Appends records to the log, can be used from any thread.  The
+    // records are buffered and written out at the start of each tick.
+    //
+    // --------------------------------------------------------------
+    class Recorder
+    {
+      public:
+        bool open(const std::string& path);
+        void close();
+
+        void tick(std::chrono::microseconds elapsedTime, std::chrono::steady_clock::time_point now);
+        void connect(std::uint64_t clientId, std::chrono::steady_clock::time_point now);
+        void disconnect(std::uint64_t clientId, std::chrono::steady_clock::time_point now);
+        void message(std::uint64_t clientId, std::chrono::steady_clock::time_point received, messages::Type type, const std::string& data);
+
+      private:
+        std::ofstream m_file;
+        std::string m_buffer;
+        std::chrono::steady_clock::time_point m_start;
+        std::mutex m_mutex;
+
+        void append(std::uint64_t value);
+        std::uint64_t since(std::chrono::steady_clock::time_point time);
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Reads the records of a log back, in order.
+    //
+    // --------------------------------------------------------------
+    class Reader
+    {
+      public:
+        bool open(const std::string& path);
+        std::optional<Record> next();
+
+      private:
+        std::string m_log;
+        std::size_t m_position{0};
+
+        std::optional<std::uint64_t> read();
+    };
+} // namespace traffic
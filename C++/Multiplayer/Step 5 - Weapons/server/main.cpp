@@ -1,9 +1,16 @@
 #include "GameModel.hpp"
 #include "MessageQueueServer.hpp"
+#include "Metrics.hpp"
+#include "TrafficLog.hpp"
+#include "misc/Profiler.hpp"
 
 #include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <google/protobuf/stubs/common.h>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <thread>
 
 //
@@ -11,18 +18,55 @@
 // needed in microseconds.
 const auto SIMULATION_UPDATE_RATE_US = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(100));
 
-int main()
+//
+// Client connections are spread across this many network I/O shards.  With
+// SO_REUSEPORT enabled, each shard has its own listener and the operating
+// system balances new connections between them.
+const std::uint16_t NETWORK_SHARDS = 2;
+const bool NETWORK_REUSE_PORT = false;
+const bool NETWORK_USE_IO_URING = true;
+
+//
+// With metrics compiled in (the METRICS CMake option), they are written to this
+// file in the Prometheus text format, for monitoring to pick up.
+const std::string METRICS_FILE = "server.metrics";
+const auto METRICS_INTERVAL = std::chrono::milliseconds(5000);
+
+//
+// With the profiler compiled in (the PROFILER CMake option), the timings recorded
+// so far are written to this file when the server receives SIGUSR1 (on systems
+// that have it), and when it shuts down.
+const std::string TRACE_FILE = "server.trace.json";
+volatile std::sig_atomic_t writeTrace = 0;
+
+//
+// Usage: Server [--record <traffic log>]
+// Recording logs everything received from clients, for use with the Replay target.
+int main(int argc, char* argv[])
 {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
 
+    std::shared_ptr<traffic::Recorder> recorder;
+    if (argc == 3 && std::string(argv[1]) == "--record")
+    {
+        recorder = std::make_shared<traffic::Recorder>();
+        if (!recorder->open(argv[2]))
+        {
+            exit(0);
+        }
+        MessageQueueServer::instance().startRecording(recorder);
+    }
+
     //
     // Get the network messaging service initialized and ready to run
-    if (!MessageQueueServer::instance().initialize(3000))
+    if (!MessageQueueServer::instance().initialize(3000, NETWORK_SHARDS, NETWORK_REUSE_PORT, NETWORK_USE_IO_URING))
     {
         std::cout << "Failed to initialize the networking messaging server, terminating..." << std::endl;
         exit(0);
     }
 
+    metrics::Registry::instance().startDump(METRICS_FILE, METRICS_INTERVAL);
+
     //
     // Get the game model up and running
     GameModel model;
@@ -34,7 +78,11 @@ int main()
 
     //
     // Grab an initial time-stamp to get the elapsed time working
-    auto previousTime = std::chrono::system_clock::now();
+    auto previousTime = std::chrono::steady_clock::now();
+    PROFILE_THREAD("Game loop");
+#if defined(SIGUSR1)
+    std::signal(SIGUSR1, [](int) { writeTrace = 1; });
+#endif
 
     //
     // Get the server loop running.  The game loop runs inside of this loop
@@ -44,7 +92,7 @@ int main()
         //
         // Figure out the elapsed time in microseconds.  Need this to pass on to
         // the game model.
-        auto currentTime = std::chrono::system_clock::now();
+        auto currentTime = std::chrono::steady_clock::now();
         auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - previousTime);
         //
         // If we are running faster than the simulate update rate, then go
@@ -56,19 +104,31 @@ int main()
         }
 
         // Recompute elapsed time after doing the sleep, to get an accurate time duration
-        currentTime = std::chrono::system_clock::now();
+        currentTime = std::chrono::steady_clock::now();
         elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - previousTime);
         previousTime = currentTime;
 
         //
         // Execute the game loop steps.  Because this is an ECS model, there is only an update.
         model.update(elapsedTime, currentTime);
+
+        if (writeTrace)
+        {
+            writeTrace = 0;
+            profiler::Profiler::instance().writeTrace(TRACE_FILE);
+        }
     }
 
     //
     // Gracefully shutdown the network message service and game model
     model.shutdown();
     MessageQueueServer::instance().shutdown();
+    metrics::Registry::instance().stopDump();
+    profiler::Profiler::instance().writeTrace(TRACE_FILE);
+    if (recorder)
+    {
+        recorder->close();
+    }
 
     //
     // Do the same for the Google Protocol Buffers library
@@ -1,14 +1,17 @@
 #include "Damage.hpp"
 
-#include "MessageQueueServer.hpp"
 #include "components/Health.hpp"
 #include "components/Weapon.hpp"
-#include "entities/Create.hpp"
+#include "entities/Prefab.hpp"
+#include "MessageQueueServer.hpp"
 #include "messages/NewEntity.hpp"
 #include "messages/RemoveEntity.hpp"
 #include "messages/Utility.hpp"
+#include "misc/Profiler.hpp"
+#include "misc/math.hpp"
 
-#include <cmath>
+#include <algorithm>
+#include <memory>
 
 namespace systems
 {
@@ -23,6 +26,8 @@ namespace systems
         System::removeEntity(entityId);
         m_entitiesDamage.erase(entityId);
         m_entitiesHealth.erase(entityId);
+        m_history.erase(entityId);
+        m_previous.erase(entityId);
     }
 
     // --------------------------------------------------------------
@@ -31,55 +36,74 @@ namespace systems
     // that have health.
     //
     // --------------------------------------------------------------
-    void Damage::update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+    void Damage::update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now)
     {
+        PROFILE_SCOPE("Damage::update");
+
+        recordHistory(now);
+
         for (auto&& weaponId : m_entitiesDamage)
         {
             auto weapon = m_entities[weaponId];
+            //
+            // The weapon hits only the first entity it reaches during the update
+            std::shared_ptr<entities::Entity> hit;
+            float hitWhen = 0;
             for (auto&& entityId : m_entitiesHealth)
             {
                 auto entity = m_entities[entityId];
                 if (weapon->getComponent<components::Weapon>()->getOwnerId() != entity->getId())
                 {
-                    if (collides(weapon.get(), entity.get()))
+                    auto when = contact(weapon.get(), entity.get(), elapsedTime, now);
+                    if (when && (hit == nullptr || when.value() < hitWhen))
                     {
-                        //
-                        // Note: Not really removing other players when their health goes to 0, but
-                        // just writing some code that shows how to use the health and weapon components
-                        // to accomplish that.
-                        auto health = entity->getComponent<components::Health>();
-                        auto damage = weapon->getComponent<components::Weapon>();
-                        health->update(-damage->getDamage());
-                        if (health->get() <= 0)
-                        {
-                            // The 'entity' would be remove in this case, but not actually doing that
-                            // in this demonstration.
-                        }
-                        //
-                        // 1.  The weapon entity needs to be removed from all connected clients
-                        //     and the local server simulation
-                        auto message = std::make_shared<messages::RemoveEntity>(weaponId);
-                        MessageQueueServer::instance().broadcastMessage(message);
-                        m_handlerRemoveEntity(weaponId);
-                        //
-                        // 2.  An explosion entity needs to be sent to the connected clients
-                        notifyExplosion(entity->getComponent<components::Position>()->get());
+                        hit = entity;
+                        hitWhen = when.value();
                     }
                 }
             }
+
+            if (hit != nullptr)
+            {
+                //
+                // Note: Not really removing other players when their health goes to 0, but
+                // just writing some code that shows how to use the health and weapon components
+                // to accomplish that.
+                auto health = hit->getComponent<components::Health>();
+                auto damage = weapon->getComponent<components::Weapon>();
+                health->update(-damage->getDamage());
+                if (health->get() <= 0)
+                {
+                    // The 'entity' would be remove in this case, but not actually doing that
+                    // in this demonstration.
+                }
+                //
+                // 1.  The weapon entity needs to be removed from all connected clients
+                //     and the local server simulation
+                auto message = std::make_shared<messages::RemoveEntity>(weaponId);
+                MessageQueueServer::instance().broadcastMessage(message);
+                m_commands.destroy(weaponId);
+                //
+                // 2.  An explosion entity needs to be sent to the connected clients
+                notifyExplosion(hit->getComponent<components::Position>()->get());
+            }
         }
+
+        recordPrevious();
     }
 
     // --------------------------------------------------------------
     //
     // This system can is interested in entities with either health
-    // or weapon.
+    // or weapon.  Where an entity is when it is added is where its
+    // first update's motion starts from.
     //
     // --------------------------------------------------------------
     bool Damage::isInterested(entities::Entity* entity)
     {
         if (System::isInterested(entity))
         {
+            m_previous.try_emplace(entity->getId(), entity->getComponent<components::Position>()->get());
             if (entity->hasComponent<components::Health>())
             {
                 m_entitiesHealth.insert(entity->getId());
@@ -97,21 +121,69 @@ namespace systems
 
     // --------------------------------------------------------------
     //
-    // Checks for a collision between two entities.
+    // Adds the current position and size of each entity with health to
+    // its history.
     //
     // --------------------------------------------------------------
-    bool Damage::collides(entities::Entity* e1, entities::Entity* e2)
+    void Damage::recordHistory(const std::chrono::steady_clock::time_point now)
     {
-        auto position1 = e1->getComponent<components::Position>();
-        auto position2 = e2->getComponent<components::Position>();
-        auto size1 = e1->getComponent<components::Size>();
-        auto size2 = e2->getComponent<components::Size>();
+        for (auto&& entityId : m_entitiesHealth)
+        {
+            auto entity = m_entities[entityId];
+            m_history[entityId].record(now, entity->getComponent<components::Position>()->get(), entity->getComponent<components::Size>()->get().x);
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Remembers where each entity ended this update, the start of its
+    // motion for the next one.
+    //
+    // --------------------------------------------------------------
+    void Damage::recordPrevious()
+    {
+        for (auto&& [entityId, entity] : m_entities)
+        {
+            m_previous[entityId] = entity->getComponent<components::Position>()->get();
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Checks for a collision between a weapon and an entity, with the
+    // entity rewound to the time the weapon's owner was seeing.
+    //
+    // Both moved in a straight line over the update, so relative to the
+    // entity the weapon moved along a segment.  They touched if that
+    // segment comes within the sum of their radii of the entity.  Gives
+    // how far into the update (0 to 1) they first touched.
+    //
+    // --------------------------------------------------------------
+    std::optional<float> Damage::contact(entities::Entity* weapon, entities::Entity* entity, std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now)
+    {
+        auto end1 = weapon->getComponent<components::Position>()->get();
+        auto previous1 = m_previous.find(weapon->getId());
+        auto start1 = previous1 != m_previous.end() ? previous1->second : end1;
+        auto size1 = weapon->getComponent<components::Size>()->get().x;
+
+        auto end2 = entity->getComponent<components::Position>()->get();
+        auto previous2 = m_previous.find(entity->getId());
+        auto start2 = previous2 != m_previous.end() ? previous2->second : end2;
+        auto size2 = entity->getComponent<components::Size>()->get().x;
+        auto lag = std::min(weapon->getComponent<components::Weapon>()->getLagCompensation(), std::chrono::duration_cast<std::chrono::microseconds>(PositionHistory::DURATION));
+        auto history = m_history.find(entity->getId());
+        if (lag.count() > 0 && history != m_history.end() && !history->second.empty())
+        {
+            auto sample = history->second.at(now - lag);
+            start2 = history->second.at(now - lag - elapsedTime).position;
+            end2 = sample.position;
+            size2 = sample.radius;
+        }
 
-        auto distance = std::sqrt(std::pow(position1->get().x - position2->get().x, 2) + std::pow(position1->get().y - position2->get().y, 2));
         // MOTHER OF ASSUPTIONS: x/y are the same and we are using circle collision detection
-        auto radii = size1->get().x + size2->get().x;
+        auto radii = size1 + size2;
 
-        return distance <= radii;
+        return math::segmentEntry({0, 0}, radii, start1 - start2, end1 - end2);
     }
 
     // --------------------------------------------------------------
@@ -121,12 +193,10 @@ namespace systems
     // --------------------------------------------------------------
     void Damage::notifyExplosion(math::Vector2f location)
     {
-        //
-        // This was just temporary while I worked on the animated sprite component
-        // for explosions.
-        auto fiftyMS = std::chrono::milliseconds(50);
-        auto frameTimes = {fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS, fiftyMS};
-        auto explosion = entities::explosion::create("explosion.png", location, 0.07f, frameTimes);
+        static const auto& prefab = entities::PrefabRegistry::instance().get("explosion");
+
+        auto explosion = prefab.instantiate();
+        explosion->getComponent<components::Position>()->set(location);
         auto pbExplosion = messages::createPBEntity(explosion);
         MessageQueueServer::instance().broadcastMessage(std::make_shared<messages::NewEntity>(pbExplosion));
     }
@@ -1,12 +1,15 @@
 #pragma once
 
+#include "PositionHistory.hpp"
 #include "components/Position.hpp"
 #include "components/Size.hpp"
 #include "entities/Entity.hpp"
 #include "systems/System.hpp"
 
-#include <functional>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 namespace systems
 {
@@ -15,6 +18,16 @@ namespace systems
     // This system is used to detect when entities cause damage to
     // each other and report if one of them should be removed.
     //
+    // Collisions are swept: the motion of both entities over the update
+    // is tested, not only where they end up, so a fast weapon can't pass
+    // through a target between two updates, whatever the tick rate.  A
+    // weapon hits only the first target it reaches.
+    //
+    // Entities with health keep a short position history.  A weapon
+    // fired by a lagged client is tested against the targets as they
+    // were when that client saw them, rather than where they are now
+    // at the server.
+    //
     // --------------------------------------------------------------
     class Damage : public System
     {
@@ -25,9 +38,8 @@ namespace systems
         {
         }
 
-        void registerRemoveEntityHandler(std::function<void(entities::Entity::IdType)> handler) { m_handlerRemoveEntity = handler; }
         virtual void removeEntity(entities::Entity::IdType entityId) override;
-        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
 
       protected:
         virtual bool isInterested(entities::Entity* entity) override;
@@ -35,9 +47,12 @@ namespace systems
       private:
         entities::EntitySet m_entitiesDamage;
         entities::EntitySet m_entitiesHealth;
-        std::function<void(entities::Entity::IdType)> m_handlerRemoveEntity;
+        std::unordered_map<entities::Entity::IdType, PositionHistory> m_history;
+        std::unordered_map<entities::Entity::IdType, math::Vector2f> m_previous; // where each entity was at the last update
 
-        bool collides(entities::Entity* e1, entities::Entity* e2);
+        void recordHistory(const std::chrono::steady_clock::time_point now);
+        void recordPrevious();
+        std::optional<float> contact(entities::Entity* weapon, entities::Entity* entity, std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now);
         void notifyExplosion(math::Vector2f location);
     };
 } // namespace systems
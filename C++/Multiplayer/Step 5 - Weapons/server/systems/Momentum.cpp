@@ -1,26 +1,70 @@
 #include "Momentum.hpp"
 
-#include "entities/Update.hpp"
+#include "misc/Profiler.hpp"
 
 namespace systems
 {
+    // --------------------------------------------------------------
+    //
+    // The components are owned by the entity, which this system also
+    // holds on to, so the pointers are good until the entity is removed.
+    // An entity whose components change is removed and added again.
+    //
+    // --------------------------------------------------------------
+    bool Momentum::addEntity(std::shared_ptr<entities::Entity> entity)
+    {
+        if (System::addEntity(entity))
+        {
+            m_movingIndex[entity->getId()] = m_moving.size();
+            m_moving.push_back({entity->getId(), entity->getComponent<components::Position>(), entity->getComponent<components::Momentum>()});
+            return true;
+        }
+
+        return false;
+    }
+
+    void Momentum::removeEntity(entities::Entity::IdType entityId)
+    {
+        System::removeEntity(entityId);
+
+        auto index = m_movingIndex.find(entityId);
+        if (index != m_movingIndex.end())
+        {
+            m_moving[index->second] = m_moving.back();
+            m_movingIndex[m_moving.back().id] = index->second;
+            m_moving.pop_back();
+            m_movingIndex.erase(entityId);
+        }
+    }
+
     // --------------------------------------------------------------
     //
     // Move all entities.
     //
     // --------------------------------------------------------------
-    void Momentum::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+    void Momentum::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now)
     {
-        for (auto&& [id, entity] : m_entities)
+        PROFILE_SCOPE("Momentum::update");
+
+        m_batch.resize(m_moving.size());
+        for (std::size_t i = 0; i < m_moving.size(); i++)
         {
-            (void)id; // unused
+            auto& moving = m_moving[i];
+            m_batch.position.set(i, moving.position->get());
+            m_batch.velocity.set(i, moving.momentum->get());
             //
             // If the entity already has some drift computed due to network
             // thrust, that amount of time must be subtracted from the server's
             // update window.
-            auto momentum = entity->getComponent<components::Momentum>();
-            entities::drift(entity.get(), elapsedTime - momentum->getIntraMovementTime());
-            momentum->resetIntraMovementTime();
+            m_batch.dt[i] = static_cast<float>((elapsedTime - moving.momentum->getIntraMovementTime()).count());
+            moving.momentum->resetIntraMovementTime();
+        }
+
+        kinematics::drift(m_batch);
+
+        for (std::size_t i = 0; i < m_moving.size(); i++)
+        {
+            m_moving[i].position->set(m_batch.position.get(i));
         }
     }
 
@@ -3,9 +3,14 @@
 #include "components/Momentum.hpp"
 #include "components/Position.hpp"
 #include "entities/Entity.hpp"
+#include "misc/Kinematics.hpp"
 #include "systems/System.hpp"
 
 #include <chrono>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace systems
 {
@@ -13,6 +18,10 @@ namespace systems
     //
     // This system is used move entities based on their momentum.
     //
+    // The components of each entity are looked up once, when it is
+    // added, and kept packed together.  Each update gathers them into a
+    // kinematics::Batch, moves them all at once, and writes them back.
+    //
     // --------------------------------------------------------------
     class Momentum : public System
     {
@@ -23,8 +32,20 @@ namespace systems
         {
         }
 
-        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
+        virtual void removeEntity(entities::Entity::IdType entityId) override;
+        virtual void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
 
       private:
+        struct Moving
+        {
+            entities::Entity::IdType id;
+            components::Position* position;
+            components::Momentum* momentum;
+        };
+
+        std::vector<Moving> m_moving;
+        std::unordered_map<entities::Entity::IdType, std::size_t> m_movingIndex;
+        kinematics::Batch m_batch;
     };
 } // namespace systems
@@ -1,12 +1,16 @@
 #include "Network.hpp"
 
-#include "MessageQueueServer.hpp"
 #include "components/Momentum.hpp"
 #include "components/Movement.hpp"
+#include "components/Weapon.hpp"
 #include "entities/Update.hpp"
+#include "MessageQueueServer.hpp"
 #include "messages/NewEntity.hpp"
+#include "messages/Pong.hpp"
 #include "messages/UpdateEntity.hpp"
 #include "messages/Utility.hpp"
+#include "Metrics.hpp"
+#include "misc/Profiler.hpp"
 
 namespace systems
 {
@@ -24,8 +28,9 @@ namespace systems
         //
         // Register our own join handler
         registerHandler(messages::Type::Join,
-                        [this](std::uint64_t clientId, [[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] std::shared_ptr<messages::Message> message) {
-                            m_joinHandler(clientId);
+                        [this](std::uint64_t clientId, [[maybe_unused]] std::chrono::microseconds elapsedTime, std::shared_ptr<messages::Message> message) {
+                            auto join = std::static_pointer_cast<messages::Join>(message);
+                            m_joinHandler(clientId, join->getPlayerId(), join->getResumeToken());
                         });
 
         //
@@ -34,6 +39,13 @@ namespace systems
                         [this]([[maybe_unused]] std::uint64_t clientId, std::chrono::microseconds elapsedTime, std::shared_ptr<messages::Message> message) {
                             handleInput(std::static_pointer_cast<messages::Input>(message), elapsedTime);
                         });
+
+        //
+        // Clock synchronization requests from clients
+        registerHandler(messages::Type::Ping,
+                        [this](std::uint64_t clientId, [[maybe_unused]] std::chrono::microseconds elapsedTime, std::shared_ptr<messages::Message> message) {
+                            handlePing(clientId, std::static_pointer_cast<messages::Ping>(message));
+                        });
     }
 
     // --------------------------------------------------------------
@@ -41,8 +53,11 @@ namespace systems
     // Process all outstanding messages since the last update.
     //
     // --------------------------------------------------------------
-    void Network::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now, std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> messages)
+    void Network::update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> messages)
     {
+        PROFILE_SCOPE("Network::update");
+
+        m_tick++;
         while (!messages.empty())
         {
             auto [clientId, message] = messages.front();
@@ -57,21 +72,24 @@ namespace systems
         }
 
         //
-        // The rate limits for inputs are updated here.
-        // Could/should create an Input system at the server that has responsibility
-        // to do this, but have decided to not do that for now.
-        for (auto& [id, entity] : m_entities)
-        {
-            (void)id; // unused
-            if (entity->hasComponent<components::Input>())
-            {
-                entity->getComponent<components::Input>()->updateLimits(elapsedTime);
-            }
-        }
+        // Send updated game state updates back out to connected clients.  The
+        // state being sent is the world as the previous update left it, so that
+        // is the time it is stamped with.
+        updateClients(elapsedTime, m_lastUpdateTime.value_or(now));
+        m_lastUpdateTime = now;
+        m_updateWindow = elapsedTime;
+    }
 
-        //
-        // Send updated game state updates back out to connected clients
-        updateClients(elapsedTime);
+    // --------------------------------------------------------------
+    //
+    // Sends the entity's current state to just the one client, stamped
+    // with the time of the last update.
+    //
+    // --------------------------------------------------------------
+    void Network::updateClient(std::uint64_t clientId, std::shared_ptr<entities::Entity> entity)
+    {
+        std::shared_ptr<messages::Message> message = std::make_shared<messages::UpdateEntity>(entity, m_updateWindow, m_tick, m_lastUpdateTime.value_or(std::chrono::steady_clock::now()));
+        MessageQueueServer::instance().sendMessageWithLastId(clientId, message);
     }
 
     // --------------------------------------------------------------
@@ -86,13 +104,13 @@ namespace systems
 
     // --------------------------------------------------------------
     //
-    // Tell all connected clients about this entity and also the local
-    // server model.
+    // Tell all connected clients about this entity and spawn it in the
+    // local server model.
     //
     // --------------------------------------------------------------
     void Network::handleNewEntity(std::shared_ptr<entities::Entity> entity)
     {
-        m_newEntityHandler(entity);
+        m_commands.spawn(entity);
         //
         // Build the protobuf representation and get it sent off to the client
         shared::Entity pbEntity = messages::createPBEntity(entity);
@@ -108,7 +126,14 @@ namespace systems
     void Network::handleInput(std::shared_ptr<messages::Input> message, std::chrono::microseconds elapsedTime)
     {
         auto entityId = message->getPBInput().entityid();
-        auto entity = m_entities[entityId].get();
+        //
+        // The player is gone if its client disconnected after sending the input
+        auto found = m_entities.find(entityId);
+        if (found == m_entities.end())
+        {
+            return;
+        }
+        auto entity = found->second.get();
 
         for (auto&& input : message->getPBInput().input())
         {
@@ -140,12 +165,24 @@ namespace systems
                 case shared::InputType::FireWeapon:
                 {
                     auto entityInput = entity->getComponent<components::Input>();
-                    if (entityInput->getLimitTime()[components::Input::Type::FireWeapon].count() <= 0)
+                    if (entityInput->isReady(components::Input::Type::FireWeapon))
                     {
                         auto missile = entities::fireWeapon(entity, elapsedTime);
+                        //
+                        // Remember how far behind the client was seeing the world, hits are
+                        // judged against where the targets were at that point
+                        auto viewTime = message->getViewTime();
+                        if (viewTime.has_value() && message->getReceivedTime() > viewTime.value())
+                        {
+                            auto lag = std::chrono::duration_cast<std::chrono::microseconds>(message->getReceivedTime() - viewTime.value());
+                            missile->getComponent<components::Weapon>()->setLagCompensation(lag);
+                        }
                         handleNewEntity(missile);
                         entityInput->resetLimit(components::Input::Type::FireWeapon);
                     }
+                    //
+                    // Nothing about the player changed, but the client still needs the input acknowledged
+                    m_reportThese.insert(entityId);
                 }
                 break;
                 default: // Just here to prevent a warning
@@ -156,29 +193,49 @@ namespace systems
 
     // --------------------------------------------------------------
     //
-    // For the entities that have updates, send those updates to all
-    // connected clients.
+    // Handler for the Ping message.  The Pong goes back right away,
+    // with the time the Ping came off the network, rather than the time
+    // of this update, so the client doesn't count the time spent waiting
+    // for the update as network latency.
     //
     // --------------------------------------------------------------
-    void Network::updateClients(const std::chrono::microseconds elapsedTime)
+    void Network::handlePing(std::uint64_t clientId, std::shared_ptr<messages::Ping> message)
     {
-        /*for (auto entityId : m_reportThese)
+        auto pong = std::make_shared<messages::Pong>(message->getClientTime(), message->getReceivedTime(), m_tick);
+        MessageQueueServer::instance().sendMessage(clientId, pong);
+
+        if (message->getRoundTripTime().count() > 0)
         {
-            auto entity = m_entities[entityId];
-            auto message = std::make_shared<messages::UpdateEntity>(entity, elapsedTime);
-            MessageQueueServer::instance().broadcastMessageWithLastId(message);
-        }*/
-        m_reportThese.clear();
+            m_metricRoundTrip.set(clientId, message->getRoundTripTime().count());
+        }
+    }
 
-        //
-        // Alternative approach to reduce discrepences between server and client
-        // is to update the client with everything everytime.
+    // --------------------------------------------------------------
+    //
+    // For the entities that have updates, send those updates to all
+    // connected clients.  Each update is stamped with the tick and the
+    // server time of the state it carries.
+    //
+    // An entity has an update if its position or momentum changed since
+    // the last time clients were updated, or if it had input this update
+    // that the client is waiting to have acknowledged.  Entities sitting
+    // still aren't sent at all; the clients already have their state.
+    //
+    // --------------------------------------------------------------
+    void Network::updateClients(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point stateTime)
+    {
         for (auto& [entityId, entity] : m_entities)
         {
-            (void)entityId; // unused
-            auto message = std::make_shared<messages::UpdateEntity>(entity, elapsedTime);
-            MessageQueueServer::instance().broadcastMessageWithLastId(message);
+            if (entity->changedSince<components::Position>(m_reportedVersion) ||
+                entity->changedSince<components::Momentum>(m_reportedVersion) ||
+                m_reportThese.find(entityId) != m_reportThese.end())
+            {
+                auto message = std::make_shared<messages::UpdateEntity>(entity, elapsedTime, m_tick, stateTime);
+                MessageQueueServer::instance().broadcastMessageWithLastId(message);
+            }
         }
+        m_reportThese.clear();
+        m_reportedVersion = components::Component::closeVersion();
         //
         // Better approach (not coded yet)
         // Send a single message with a snapshot of the game state to each client
@@ -1,16 +1,19 @@
 #pragma once
 
+#include "Metrics.hpp"
 #include "components/Position.hpp"
 #include "entities/Entity.hpp"
 #include "messages/Input.hpp"
 #include "messages/Join.hpp"
 #include "messages/Message.hpp"
+#include "messages/Ping.hpp"
 #include "systems/System.hpp"
 
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -28,19 +31,26 @@ namespace systems
       public:
         Network();
 
-        void registerNewEntityHandler(std::function<void(std::shared_ptr<entities::Entity>)> handler) { m_newEntityHandler = handler; }
-        void registerJoinHandler(std::function<void(std::uint64_t clientId)> handler) { m_joinHandler = handler; }
-        void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now, std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> messages);
+        void registerJoinHandler(std::function<void(std::uint64_t clientId, std::optional<entities::Entity::IdType> playerId, std::uint64_t resumeToken)> handler) { m_joinHandler = handler; }
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now, std::queue<std::tuple<std::uint64_t, std::shared_ptr<messages::Message>>> messages);
+        void addClient(std::uint64_t clientId) { m_metricRoundTrip.add(clientId); }
+        void removeClient(std::uint64_t clientId) { m_metricRoundTrip.remove(clientId); }
+        void updateClient(std::uint64_t clientId, std::shared_ptr<entities::Entity> entity);
 
       private:
         std::unordered_map<messages::Type, std::function<void(std::uint64_t, std::chrono::microseconds elapsedTime, std::shared_ptr<messages::Message>)>> m_commandMap;
-        std::function<void(std::shared_ptr<entities::Entity>)> m_newEntityHandler{nullptr};
-        std::function<void(std::uint64_t)> m_joinHandler{nullptr};
+        std::function<void(std::uint64_t, std::optional<entities::Entity::IdType>, std::uint64_t)> m_joinHandler{nullptr};
         entities::EntitySet m_reportThese;
+        components::Component::Version m_reportedVersion{0}; // changes after this haven't been sent to clients
+        std::uint64_t m_tick{0}; // one tick per update, stamped on the state sent to clients
+        std::optional<std::chrono::steady_clock::time_point> m_lastUpdateTime;
+        std::chrono::microseconds m_updateWindow{0};
+        metrics::GaugeFamily m_metricRoundTrip{"server_client_rtt_microseconds", "client"};
 
         void registerHandler(messages::Type type, std::function<void(std::uint64_t, std::chrono::microseconds, std::shared_ptr<messages::Message>)> handler);
         void handleNewEntity(std::shared_ptr<entities::Entity> entity);
         void handleInput(std::shared_ptr<messages::Input> message, std::chrono::microseconds);
-        void updateClients(const std::chrono::microseconds elapsedTime);
+        void handlePing(std::uint64_t clientId, std::shared_ptr<messages::Ping> message);
+        void updateClients(const std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point stateTime);
     };
 } // namespace systems
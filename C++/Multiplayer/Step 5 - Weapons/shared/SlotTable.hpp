@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------------
+//
+// @details A table of values addressed by a 64 bit key: the low 32 bits
+// are an index into a flat array of slots, the high 32 bits are the
+// generation of the slot.  Each time a slot is freed its generation
+// changes, so a key kept around after its value was erased no longer
+// finds anything, even once the slot is reused.
+//
+// The values themselves are packed together in insertion order (erasing
+// moves the last value into the hole), so iterating over them is a walk
+// through contiguous memory.
+//
+// Keys are either allocated by the table (insert) or given to it by
+// another table the values are tracking (emplace).  A table should only
+// be used one of those two ways.
+//
+// ------------------------------------------------------------------
+template <typename T>
+class SlotTable
+{
+  public:
+    using Key = std::uint64_t;
+
+    static std::uint32_t index(Key key) { return static_cast<std::uint32_t>(key); }
+    static std::uint32_t generation(Key key) { return static_cast<std::uint32_t>(key >> 32); }
+    static Key makeKey(std::uint32_t index, std::uint32_t generation) { return (static_cast<Key>(generation) << 32) | index; }
+
+    // ------------------------------------------------------------------
+    //
+    // Adds the value in a free slot, reusing previously freed slots
+    // before growing the table.
+    //
+    // ------------------------------------------------------------------
+    Key insert(T value)
+    {
+        m_allocates = true;
+
+        std::uint32_t slot;
+        if (!m_free.empty())
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back({1, EMPTY});
+        }
+
+        auto key = makeKey(slot, m_slots[slot].generation);
+        place(key, std::move(value));
+        return key;
+    }
+
+    // ------------------------------------------------------------------
+    //
+    // Adds (or replaces) the value at the slot and generation of a key
+    // allocated elsewhere.
+    //
+    // ------------------------------------------------------------------
+    void emplace(Key key, T value)
+    {
+        if (index(key) >= m_slots.size())
+        {
+            m_slots.resize(index(key) + 1, {0, EMPTY});
+        }
+
+        auto& slot = m_slots[index(key)];
+        slot.generation = generation(key);
+        if (slot.dense != EMPTY)
+        {
+            m_values[slot.dense] = std::move(value);
+            m_keys[slot.dense] = key;
+            return;
+        }
+        place(key, std::move(value));
+    }
+
+    // ------------------------------------------------------------------
+    //
+    // Returns true if the key was found (and its value removed).
+    //
+    // ------------------------------------------------------------------
+    bool erase(Key key)
+    {
+        if (get(key) == nullptr)
+        {
+            return false;
+        }
+
+        auto& slot = m_slots[index(key)];
+        auto last = static_cast<std::uint32_t>(m_values.size() - 1);
+        if (slot.dense != last)
+        {
+            m_values[slot.dense] = std::move(m_values[last]);
+            m_keys[slot.dense] = m_keys[last];
+            m_slots[index(m_keys[last])].dense = slot.dense;
+        }
+        m_values.pop_back();
+        m_keys.pop_back();
+
+        slot.dense = EMPTY;
+        slot.generation++;
+        if (m_allocates)
+        {
+            m_free.push_back(index(key));
+        }
+
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    //
+    // Returns nullptr if the key isn't (or is no longer) in the table.
+    //
+    // ------------------------------------------------------------------
+    T* get(Key key)
+    {
+        if (index(key) < m_slots.size())
+        {
+            auto& slot = m_slots[index(key)];
+            if (slot.dense != EMPTY && slot.generation == generation(key))
+            {
+                return &m_values[slot.dense];
+            }
+        }
+        return nullptr;
+    }
+
+    bool contains(Key key) { return get(key) != nullptr; }
+    std::size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+
+    //
+    // Packed values and their keys, in the same order
+    std::vector<T>& values() { return m_values; }
+    const std::vector<Key>& keys() const { return m_keys; }
+
+  private:
+    static constexpr std::uint32_t EMPTY = std::numeric_limits<std::uint32_t>::max();
+
+    struct Slot
+    {
+        std::uint32_t generation;
+        std::uint32_t dense; // position in m_values, or EMPTY
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_free;
+    std::vector<T> m_values;
+    std::vector<Key> m_keys;
+    bool m_allocates{false}; // only tables that insert reuse freed slots
+
+    void place(Key key, T value)
+    {
+        m_slots[index(key)].dense = static_cast<std::uint32_t>(m_values.size());
+        m_values.push_back(std::move(value));
+        m_keys.push_back(key);
+    }
+};
@@ -3,12 +3,14 @@
 #include "components/Component.hpp"
 
 #include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
 // --------------------------------------------------------------
 //
-// Specifies the an animated visual appearance.
+// Specifies the an animated visual appearance.  The sprite times never
+// change once created, so copies of the component share them.
 //
 // --------------------------------------------------------------
 namespace components
@@ -18,15 +20,15 @@ namespace components
       public:
         AnimatedAppearance(std::string texture, std::vector<std::chrono::milliseconds> spriteTime) :
             m_texture(texture),
-            m_spriteTime(spriteTime)
+            m_spriteTime(std::make_shared<const std::vector<std::chrono::milliseconds>>(std::move(spriteTime)))
         {
         }
 
         auto getTexture() { return m_texture; }
-        const auto& getSpriteTime() { return m_spriteTime; }
+        const auto& getSpriteTime() { return *m_spriteTime; }
 
       private:
         std::string m_texture;
-        std::vector<std::chrono::milliseconds> m_spriteTime;
+        std::shared_ptr<const std::vector<std::chrono::milliseconds>> m_spriteTime;
     };
 } // namespace components
@@ -0,0 +1,6 @@
+#include "Component.hpp"
+
+namespace components
+{
+    std::atomic<Component::Version> Component::currentVersion = 1;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 // --------------------------------------------------------------
 //
 // Not sure this is even necessary, given that a compile-time hash
@@ -7,12 +10,45 @@
 // not going to remove this, keeping it here to show there is a relationship
 // between all components.
 //
+// Each component also records the version of the world in which it
+// last changed.  Setters that actually change the state stamp the
+// current version, a newly created component is stamped when it is
+// created.  Code that wants to know what changed between two points
+// (replication, rendering) calls closeVersion at the first point and
+// later asks changedSince with the version it was given.  A copy of a
+// component (e.g. from a prefab) is a new component, so it is stamped
+// with the current version rather than the version of the original.
+//
 // --------------------------------------------------------------
 namespace components
 {
     class Component
     {
       public:
+        using Version = std::uint64_t;
+
+        Component() {}
+        Component(const Component&) {}
+        Component& operator=(const Component&)
+        {
+            markChanged();
+            return *this;
+        }
+        virtual ~Component() {} // components are destroyed through this type
+
+        auto getVersion() const { return m_version; }
+        bool changedSince(Version version) const { return m_version > version; }
+
+        //
+        // Returns the version just closed; every change made up to now is at or below it
+        static Version closeVersion() { return currentVersion++; }
+
+      protected:
+        void markChanged() { m_version = currentVersion.load(); }
+
+      private:
+        static std::atomic<Version> currentVersion;
+        Version m_version{currentVersion.load()};
     };
 
 } // namespace components
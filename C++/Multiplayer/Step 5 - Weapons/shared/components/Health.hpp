@@ -18,7 +18,11 @@ namespace components
         }
 
         auto get() { return m_health; }
-        void update(float howMuch) { m_health += howMuch; }
+        void update(float howMuch)
+        {
+            m_health += howMuch;
+            markChanged();
+        }
 
       private:
         float m_health;
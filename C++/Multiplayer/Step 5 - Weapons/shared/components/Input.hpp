@@ -1,6 +1,7 @@
 #pragma once
 
 #include "components/Component.hpp"
+#include "misc/GameClock.hpp"
 
 #include <algorithm>
 #include <chrono>
@@ -11,7 +12,9 @@
 
 // --------------------------------------------------------------
 //
-// Identifies which inputs are active.
+// Identifies which inputs are active.  Each input has a limit on how
+// often it can be used, after it is used it is ready again at a later
+// GameClock time.
 //
 // --------------------------------------------------------------
 namespace components
@@ -32,7 +35,6 @@ namespace components
             for (auto& [type, time] : inputs)
             {
                 m_inputs[type] = time;
-                m_limitTime[type] = std::chrono::microseconds(0);
             }
         }
 
@@ -41,24 +43,32 @@ namespace components
             for (auto& [type, time] : inputs)
             {
                 m_inputs[type] = time;
-                m_limitTime[type] = std::chrono::microseconds(0);
             }
         }
 
         const auto& getInputs() { return m_inputs; }
-        auto& getLimitTime() { return m_limitTime; }
-        void resetLimit(Type type) { m_limitTime[type] = m_inputs[type]; }
-        void updateLimits(std::chrono::microseconds howLong)
+        bool isReady(Type type) { return getLimit(type).count() <= 0; }
+        void resetLimit(Type type) { setLimit(type, m_inputs[type]); }
+
+        //
+        // How long until the input can be used again
+        std::chrono::microseconds getLimit(Type type)
         {
-            for (auto& [type, time] : m_limitTime)
+            auto readyAt = m_readyAt.find(type);
+            if (readyAt == m_readyAt.end())
             {
-                (void)type;
-                time = std::max(time - howLong, std::chrono::microseconds(0));
+                return std::chrono::microseconds(0);
             }
+            return std::max(readyAt->second - GameClock::instance().now(), std::chrono::microseconds(0));
+        }
+        void setLimit(Type type, std::chrono::microseconds howLong)
+        {
+            m_readyAt[type] = GameClock::instance().now() + howLong;
+            markChanged();
         }
 
       private:
         std::unordered_map<Type, std::chrono::microseconds> m_inputs;
-        std::unordered_map<Type, std::chrono::microseconds> m_limitTime;
+        std::unordered_map<Type, std::chrono::microseconds> m_readyAt;
     };
 } // namespace components
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "components/Component.hpp"
+#include "misc/GameClock.hpp"
 
 #include <chrono>
+#include <optional>
 
 // --------------------------------------------------------------
 //
-// Specifies the how long the entity should live.
+// Specifies the how long the entity should live.  The countdown starts
+// when the entity is added to the world (see systems::Lifetime), from
+// then on the component holds the GameClock time it expires at, so
+// nothing has to be updated while it waits.
 //
 // --------------------------------------------------------------
 namespace components
@@ -19,10 +24,24 @@ namespace components
         {
         }
 
-        auto get() { return m_howLong; }
-        void update(std::chrono::microseconds howMuch) { m_howLong -= howMuch; }
+        //
+        // How much longer the entity has to live
+        std::chrono::microseconds get() { return m_expiresAt.has_value() ? m_expiresAt.value() - GameClock::instance().now() : m_howLong; }
+
+        //
+        // Returns the time it expires at, starting the countdown if it wasn't already
+        std::chrono::microseconds start()
+        {
+            if (!m_expiresAt.has_value())
+            {
+                m_expiresAt = GameClock::instance().now() + m_howLong;
+                markChanged();
+            }
+            return m_expiresAt.value();
+        }
 
       private:
         std::chrono::microseconds m_howLong;
+        std::optional<std::chrono::microseconds> m_expiresAt;
     };
 } // namespace components
@@ -21,7 +21,14 @@ namespace components
         }
 
         const math::Vector2f get() const { return m_momentum; }
-        void set(math::Vector2f momentum) { m_momentum = momentum; }
+        void set(math::Vector2f momentum)
+        {
+            if (momentum.x != m_momentum.x || momentum.y != m_momentum.y)
+            {
+                m_momentum = momentum;
+                markChanged();
+            }
+        }
 
         void resetIntraMovementTime() { m_intraMovementTime = std::chrono::microseconds(0); }
         auto getIntraMovementTime() { return m_intraMovementTime; }
@@ -22,26 +22,40 @@ namespace components
         }
 
         auto get() { return m_position; }
-        auto set(math::Vector2f position) { m_position = position; }
+        void set(math::Vector2f position)
+        {
+            if (position.x != m_position.x || position.y != m_position.y)
+            {
+                m_position = position;
+                markChanged();
+            }
+        }
         auto getOrientation() { return m_orientation; }
-        void setOrientation(float orientation) { m_orientation = orientation; }
+        void setOrientation(float orientation)
+        {
+            if (orientation != m_orientation)
+            {
+                m_orientation = orientation;
+                markChanged();
+            }
+        }
 
         void resetEntityPrediction() { m_needsEntityPrediction = false; }
         auto getNeedsEntityPrediction() { return m_needsEntityPrediction; }
-        void setLastServerUpdate(const std::chrono::system_clock::time_point now)
+        void setLastServerUpdate(const std::chrono::steady_clock::time_point now)
         {
             m_lastServerUpdate = now;
             m_needsEntityPrediction = true;
         }
         auto getLastServerUpdate() { return m_lastServerUpdate; }
-        void setLastClientUpdate(const std::chrono::system_clock::time_point now) { m_lastClientUpdate = now; }
+        void setLastClientUpdate(const std::chrono::steady_clock::time_point now) { m_lastClientUpdate = now; }
         auto getLastClientUpdate() { return m_lastClientUpdate; }
 
       private:
         math::Vector2f m_position;
         float m_orientation;
-        std::chrono::system_clock::time_point m_lastServerUpdate{std::chrono::system_clock::now()};
-        std::chrono::system_clock::time_point m_lastClientUpdate{std::chrono::system_clock::now()};
+        std::chrono::steady_clock::time_point m_lastServerUpdate{std::chrono::steady_clock::now()};
+        std::chrono::steady_clock::time_point m_lastClientUpdate{std::chrono::steady_clock::now()};
         bool m_needsEntityPrediction = false;
     };
 } // namespace components
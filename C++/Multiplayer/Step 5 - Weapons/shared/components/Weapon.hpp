@@ -3,9 +3,13 @@
 #include "components/Component.hpp"
 #include "entities/Entity.hpp"
 
+#include <chrono>
+
 // --------------------------------------------------------------
 //
-// Specifies the amount of damage the weapon causes.
+// Specifies the amount of damage the weapon causes.  The lag
+// compensation is how far behind the server the owner was seeing
+// the world when the weapon was fired.
 //
 // --------------------------------------------------------------
 namespace components
@@ -21,9 +25,21 @@ namespace components
 
         auto getDamage() { return m_damage; }
         auto getOwnerId() { return m_ownerId; }
+        void setOwnerId(entities::Entity::IdType ownerId)
+        {
+            m_ownerId = ownerId;
+            markChanged();
+        }
+        auto getLagCompensation() { return m_lagCompensation; }
+        void setLagCompensation(std::chrono::microseconds lag)
+        {
+            m_lagCompensation = lag;
+            markChanged();
+        }
 
       private:
         float m_damage;
         entities::Entity::IdType m_ownerId;
+        std::chrono::microseconds m_lagCompensation{0};
     };
 } // namespace components
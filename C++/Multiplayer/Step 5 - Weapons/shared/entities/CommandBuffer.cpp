@@ -0,0 +1,108 @@
+#include "CommandBuffer.hpp"
+
+#include "systems/System.hpp"
+
+#include <iterator>
+
+namespace entities
+{
+    // --------------------------------------------------------------
+    //
+    // Makes the recorded changes to the world and to every system.
+    // Each pass collects everything recorded so far into one batch,
+    // a system's addEntity may record more, which the next pass picks
+    // up.
+    //
+    // --------------------------------------------------------------
+    void CommandBuffer::playback(EntityMap& entities, const std::vector<systems::System*>& systems)
+    {
+        while (true)
+        {
+            CommandBuffer batch;
+            batch.take(*this);
+            for (auto system : systems)
+            {
+                batch.take(system->getCommands());
+            }
+            if (batch.empty())
+            {
+                break;
+            }
+
+            //
+            // Destroys win over everything else in the batch
+            std::vector<Entity::IdType> removed;
+            EntitySet removedIds;
+            for (auto entityId : batch.m_destroyed)
+            {
+                if (removedIds.insert(entityId).second)
+                {
+                    removed.push_back(entityId);
+                }
+            }
+
+            EntityVector added;
+            EntitySet addedIds;
+            for (auto& entity : batch.m_spawned)
+            {
+                if (entity != nullptr && removedIds.find(entity->getId()) == removedIds.end())
+                {
+                    entities[entity->getId()] = entity;
+                    added.push_back(entity);
+                    addedIds.insert(entity->getId());
+                }
+            }
+
+            //
+            // Entities spawned in this batch get their components before any system
+            // sees them, the others are re-offered to the systems once changed.
+            EntityVector changed;
+            EntitySet changedIds;
+            for (auto& change : batch.m_componentChanges)
+            {
+                auto entity = entities.find(change.entityId);
+                if (entity == entities.end() || removedIds.find(change.entityId) != removedIds.end())
+                {
+                    continue;
+                }
+                if (change.component)
+                {
+                    entity->second->addComponent(change.type, std::move(change.component));
+                }
+                else
+                {
+                    entity->second->removeComponent(change.type);
+                }
+                if (addedIds.find(change.entityId) == addedIds.end() && changedIds.insert(change.entityId).second)
+                {
+                    changed.push_back(entity->second);
+                }
+            }
+
+            for (auto entityId : removed)
+            {
+                entities.erase(entityId);
+            }
+
+            for (auto system : systems)
+            {
+                system->applyChanges(added, changed, removed);
+            }
+        }
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Moves the other buffer's commands onto the end of this one.
+    //
+    // --------------------------------------------------------------
+    void CommandBuffer::take(CommandBuffer& other)
+    {
+        m_spawned.insert(m_spawned.end(), other.m_spawned.begin(), other.m_spawned.end());
+        m_destroyed.insert(m_destroyed.end(), other.m_destroyed.begin(), other.m_destroyed.end());
+        m_componentChanges.insert(m_componentChanges.end(), std::make_move_iterator(other.m_componentChanges.begin()), std::make_move_iterator(other.m_componentChanges.end()));
+        other.m_spawned.clear();
+        other.m_destroyed.clear();
+        other.m_componentChanges.clear();
+    }
+} // namespace entities
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "components/Component.hpp"
+#include "entities/Entity.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace systems
+{
+    class System;
+}
+
+namespace entities
+{
+    // --------------------------------------------------------------
+    //
+    // Records structural changes to the world (entities spawned or
+    // destroyed, components added or removed) so they can be made all
+    // at once, between system updates, instead of while the systems are
+    // iterating over their entities.
+    //
+    // Each system records into its own buffer, so systems never share
+    // one while they update.  The game model's playback drains its own
+    // buffer and then every system's, in the order the systems are
+    // given, and hands each system the whole batch in one call.
+    //
+    // Within a playback, spawns are made first, then component changes,
+    // then destroys; an entity both spawned and destroyed never reaches
+    // the systems.  Anything recorded during playback (e.g. by a system's
+    // addEntity) is played back before playback returns.
+    //
+    // --------------------------------------------------------------
+    class CommandBuffer
+    {
+      public:
+        void spawn(std::shared_ptr<Entity> entity) { m_spawned.push_back(entity); }
+        void destroy(Entity::IdType entityId) { m_destroyed.push_back(entityId); }
+
+        template <typename T>
+        void addComponent(Entity::IdType entityId, std::unique_ptr<T> component)
+        {
+            m_componentChanges.push_back({entityId, ctti::unnamed_type_id<T>(), std::move(component)});
+        }
+
+        template <typename T>
+        void removeComponent(Entity::IdType entityId)
+        {
+            m_componentChanges.push_back({entityId, ctti::unnamed_type_id<T>(), nullptr});
+        }
+
+        bool empty() const { return m_spawned.empty() && m_destroyed.empty() && m_componentChanges.empty(); }
+
+        void playback(EntityMap& entities, const std::vector<systems::System*>& systems);
+
+      private:
+        struct ComponentChange
+        {
+            Entity::IdType entityId;
+            ctti::unnamed_type_id_t type;
+            std::unique_ptr<components::Component> component; // nullptr to remove the component
+        };
+
+        EntityVector m_spawned;
+        std::vector<Entity::IdType> m_destroyed;
+        std::vector<ComponentChange> m_componentChanges;
+
+        void take(CommandBuffer& other);
+    };
+} // namespace entities
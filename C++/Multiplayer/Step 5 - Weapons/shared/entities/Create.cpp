@@ -77,4 +77,45 @@ namespace entities::explosion
 
         return entity;
     }
+
+    // --------------------------------------------------------------
+    //
+    // The same explosion, as a prefab.  Instances are at the origin
+    // until given a position.
+    //
+    // --------------------------------------------------------------
+    Prefab prefab(std::string texture, float size, std::vector<std::chrono::milliseconds> spriteTime)
+    {
+        auto totalFrametime = std::accumulate(spriteTime.begin(), spriteTime.end(), std::chrono::milliseconds(0));
+        totalFrametime -= spriteTime.back();
+
+        Prefab prefab;
+        prefab.add(components::Position({0.0f, 0.0f}))
+            .add(components::Size(math::Vector2f(size, size)))
+            .add(components::AnimatedAppearance(texture, spriteTime))
+            .add(components::Lifetime(totalFrametime));
+
+        return prefab;
+    }
 } // namespace entities::explosion
+
+namespace entities::missile
+{
+    // --------------------------------------------------------------
+    //
+    // A missile's position, momentum and owner are set when it is fired.
+    //
+    // --------------------------------------------------------------
+    Prefab prefab()
+    {
+        Prefab prefab;
+        prefab.add(components::Appearance(TEXTURE))
+            .add(components::Position({0.0f, 0.0f}))
+            .add(components::Size(math::Vector2f(0.005f, 0.005f)))
+            .add(components::Lifetime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(2000))))
+            .add(components::Momentum({0.0f, 0.0f}))
+            .add(components::Weapon(50.0f, 0));
+
+        return prefab;
+    }
+} // namespace entities::missile
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "entities/Entity.hpp"
+#include "entities/Prefab.hpp"
 #include "misc/math.hpp"
 
 #include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 // --------------------------------------------------------------
 //
@@ -14,14 +16,33 @@
 // --------------------------------------------------------------
 namespace entities::player
 {
+    //
+    // Players see their own ship in one color and everyone else's in another
+    constexpr const char* TEXTURE_OWN = "playerShip1_blue.png";
+    constexpr const char* TEXTURE_OTHER = "playerShip1_red.png";
+
     std::shared_ptr<Entity> create(std::string texture, math::Vector2f position, float size, float thrustRate, float rotateRate, math::Vector2f momentum, float health);
 }
 // --------------------------------------------------------------
 //
-// Function to create an explosion entity
+// Functions to create an explosion entity, or the prefab for one
 //
 // --------------------------------------------------------------
 namespace entities::explosion
 {
+    constexpr const char* TEXTURE = "explosion.png";
+
     std::shared_ptr<Entity> create(std::string texture, math::Vector2f position, float size, std::vector<std::chrono::milliseconds> spriteTime);
+    Prefab prefab(std::string texture, float size, std::vector<std::chrono::milliseconds> spriteTime);
+}
+// --------------------------------------------------------------
+//
+// Function to create the prefab for a missile
+//
+// --------------------------------------------------------------
+namespace entities::missile
+{
+    constexpr const char* TEXTURE = "missile.png";
+
+    Prefab prefab();
 }
\ No newline at end of file
@@ -63,6 +63,11 @@ namespace entities
         template <typename T>
         void removeComponent();
 
+        //
+        // For code that only knows the component by its type id (e.g. the CommandBuffer)
+        void addComponent(ctti::unnamed_type_id_t type, std::unique_ptr<components::Component> component) { m_components[type] = std::move(component); }
+        void removeComponent(ctti::unnamed_type_id_t type) { m_components.erase(type); }
+
         template <typename T>
         bool hasComponent();
 
@@ -71,6 +76,9 @@ namespace entities
         template <typename T>
         T* getComponent();
 
+        template <typename T>
+        bool changedSince(components::Component::Version version);
+
       private:
         IdType m_id;
         std::unordered_map<ctti::unnamed_type_id_t, std::unique_ptr<components::Component>> m_components;
@@ -127,4 +135,17 @@ namespace entities
     {
         return static_cast<T*>(m_components[ctti::unnamed_type_id<T>()].get());
     }
+
+    // --------------------------------------------------------------
+    //
+    // Returns true if the entity has the component and it changed after
+    // the given version (see components::Component::closeVersion).
+    //
+    // --------------------------------------------------------------
+    template <typename T>
+    bool Entity::changedSince(components::Component::Version version)
+    {
+        auto entry = m_components.find(ctti::unnamed_type_id<T>());
+        return entry != m_components.end() && entry->second->changedSince(version);
+    }
 } // namespace entities
@@ -0,0 +1,35 @@
+#include "Prefab.hpp"
+
+#include "entities/Create.hpp"
+
+namespace entities
+{
+    // --------------------------------------------------------------
+    //
+    // Every instance is a new entity (with its own id) holding copies
+    // of the blueprint components.
+    //
+    // --------------------------------------------------------------
+    std::shared_ptr<Entity> Prefab::instantiate() const
+    {
+        auto entity = std::make_shared<Entity>();
+        entity->getComponents().reserve(m_blueprints.size());
+        for (auto& blueprint : m_blueprints)
+        {
+            entity->addComponent(blueprint.type, blueprint.clone(*blueprint.component));
+        }
+
+        return entity;
+    }
+
+    PrefabRegistry::PrefabRegistry()
+    {
+        add("missile", missile::prefab());
+
+        //
+        // This was just temporary while I worked on the animated sprite component
+        // for explosions.
+        auto fiftyMS = std::chrono::milliseconds(50);
+        add("explosion", explosion::prefab(explosion::TEXTURE, 0.07f, std::vector<std::chrono::milliseconds>(16, fiftyMS)));
+    }
+} // namespace entities
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "components/Component.hpp"
+#include "entities/Entity.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace entities
+{
+    // --------------------------------------------------------------
+    //
+    // A blueprint for an entity: a set of fully constructed components
+    // that every instance starts out with.  Instantiating a prefab
+    // copy-constructs each component from the blueprint, so nothing
+    // about it (textures, sprite times, lifetimes) is built again.
+    //
+    // Prefabs are immutable once registered, only the instances are
+    // changed afterwards.
+    //
+    // --------------------------------------------------------------
+    class Prefab
+    {
+      public:
+        template <typename T>
+        Prefab& add(T component);
+
+        std::shared_ptr<Entity> instantiate() const;
+
+      private:
+        struct Blueprint
+        {
+            ctti::unnamed_type_id_t type;
+            std::unique_ptr<components::Component> component;
+            std::unique_ptr<components::Component> (*clone)(const components::Component&);
+        };
+
+        std::vector<Blueprint> m_blueprints;
+    };
+
+    // --------------------------------------------------------------
+    //
+    // The prefabs known to the game, by name.  The built in prefabs
+    // (missile, explosion) are registered when it is created.
+    //
+    // Note: This is a Singleton
+    //
+    // --------------------------------------------------------------
+    class PrefabRegistry
+    {
+      public:
+        PrefabRegistry(const PrefabRegistry&) = delete;
+        PrefabRegistry(PrefabRegistry&&) = delete;
+        PrefabRegistry& operator=(const PrefabRegistry&) = delete;
+        PrefabRegistry& operator=(PrefabRegistry&&) = delete;
+
+        static auto& instance()
+        {
+            static PrefabRegistry instance;
+            return instance;
+        }
+
+        void add(std::string name, Prefab prefab) { m_prefabs[name] = std::move(prefab); }
+        bool has(const std::string& name) const { return m_prefabs.find(name) != m_prefabs.end(); }
+        const Prefab& get(const std::string& name) const { return m_prefabs.at(name); }
+
+      private:
+        PrefabRegistry();
+
+        std::unordered_map<std::string, Prefab> m_prefabs;
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Adds a copy of the component to the blueprint, replacing one of
+    // the same type if it was already added.
+    //
+    // --------------------------------------------------------------
+    template <typename T>
+    Prefab& Prefab::add(T component)
+    {
+        auto type = ctti::unnamed_type_id<T>();
+        auto clone = [](const components::Component& original) -> std::unique_ptr<components::Component> {
+            return std::make_unique<T>(static_cast<const T&>(original));
+        };
+
+        for (auto& blueprint : m_blueprints)
+        {
+            if (blueprint.type == type)
+            {
+                blueprint.component = std::make_unique<T>(std::move(component));
+                return *this;
+            }
+        }
+        m_blueprints.push_back({type, std::make_unique<T>(std::move(component)), clone});
+
+        return *this;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Creates count instances of the prefab, calling the initializer with
+    // each one (and its index in the batch) to set whatever is specific
+    // to that instance, e.g. its position.  The entities are returned in
+    // the order created, ready to be spawned.
+    //
+    // --------------------------------------------------------------
+    template <typename Initializer>
+    EntityVector spawnBatch(const Prefab& prefab, std::size_t count, Initializer&& initializer)
+    {
+        EntityVector entities;
+        entities.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto entity = prefab.instantiate();
+            initializer(*entity, i);
+            entities.push_back(std::move(entity));
+        }
+
+        return entities;
+    }
+} // namespace entities
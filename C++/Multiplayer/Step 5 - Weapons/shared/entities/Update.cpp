@@ -9,8 +9,10 @@
 #include "components/Position.hpp"
 #include "components/Size.hpp"
 #include "components/Weapon.hpp"
+#include "entities/Prefab.hpp"
+#include "misc/Kinematics.hpp"
+#include "misc/math.hpp"
 
-#include <cmath>
 #include <memory>
 
 // --------------------------------------------------------------
@@ -28,13 +30,10 @@ namespace entities
         auto movement = entity->getComponent<components::Movement>();
         auto momentum = entity->getComponent<components::Momentum>();
 
-        auto vectorX = std::cos(position->getOrientation() * DEGREES_TO_RADIANS);
-        auto vectorY = std::sin(position->getOrientation() * DEGREES_TO_RADIANS);
+        math::Vector2f direction;
+        math::sincosDegrees(position->getOrientation(), direction.y, direction.x);
 
-        auto current = momentum->get();
-        momentum->set(math::Vector2f(
-            current.x + static_cast<float>(vectorX * movement->getThrustRate() * howLong.count()),
-            current.y + static_cast<float>(vectorY * movement->getThrustRate() * howLong.count())));
+        momentum->set(momentum->get() + direction * (movement->getThrustRate() * howLong.count()));
     }
 
     void rotateLeft(entities::Entity* entity, std::chrono::microseconds howLong)
@@ -55,20 +54,18 @@ namespace entities
 
     std::shared_ptr<Entity> fireWeapon(entities::Entity* entity, std::chrono::microseconds elapsedTime)
     {
+        static const auto& prefab = PrefabRegistry::instance().get("missile");
+
         auto position = entity->getComponent<components::Position>();
         auto momentum = entity->getComponent<components::Momentum>();
 
-        auto missile = std::make_shared<entities::Entity>();
-        missile->addComponent(std::make_unique<components::Appearance>("missile.png"));
-        missile->addComponent(std::make_unique<components::Position>(position->get()));
-        missile->addComponent(std::make_unique<components::Size>(math::Vector2f(0.005f, 0.005f)));
-        missile->addComponent(std::make_unique<components::Lifetime>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::milliseconds(2000))));
+        auto missile = prefab.instantiate();
+        missile->getComponent<components::Position>()->set(position->get());
 
-        auto vectorX = std::cos(position->getOrientation() * DEGREES_TO_RADIANS);
-        auto vectorY = std::sin(position->getOrientation() * DEGREES_TO_RADIANS);
-        auto missileMomentum = math::Vector2f(momentum->get().x + vectorX * 0.0000003f, momentum->get().y + vectorY * 0.0000003f);
-        missile->addComponent(std::make_unique<components::Momentum>(missileMomentum));
-        missile->addComponent(std::make_unique<components::Weapon>(50.0f, entity->getId()));
+        math::Vector2f direction;
+        math::sincosDegrees(position->getOrientation(), direction.y, direction.x);
+        missile->getComponent<components::Momentum>()->set(momentum->get() + direction * 0.0000003f);
+        missile->getComponent<components::Weapon>()->setOwnerId(entity->getId());
 
         //
         // simulate the missle movement for the time already spent at the server so that it shows up
@@ -83,9 +80,12 @@ namespace entities
         auto position = entity->getComponent<components::Position>();
         auto momentum = entity->getComponent<components::Momentum>();
 
+        //
+        // Same arithmetic as the batched drift, see misc/Kinematics.hpp
         auto current = position->get();
+        auto time = static_cast<float>(howLong.count());
         position->set(math::Vector2f(
-            current.x + momentum->get().x * howLong.count(),
-            current.y + momentum->get().y * howLong.count()));
+            kinematics::advance(current.x, momentum->get().x, time),
+            kinematics::advance(current.y, momentum->get().y, time)));
     }
 } // namespace entities
@@ -0,0 +1,35 @@
+#include "ConnectAck.hpp"
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // Use protobuffers to serialize to an std::string
+    //
+    // -----------------------------------------------------------------
+    std::string ConnectAck::serializeToString() const
+    {
+        shared::ConnectAck pbConnectAck;
+
+        for (auto&& asset : m_assets)
+        {
+            pbConnectAck.add_assets(asset);
+        }
+
+        return pbConnectAck.SerializeAsString();
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool ConnectAck::parseFromString(const std::string& source)
+    {
+        shared::ConnectAck pbConnectAck;
+        auto success = pbConnectAck.ParseFromString(source);
+        m_assets.assign(pbConnectAck.assets().begin(), pbConnectAck.assets().end());
+        return success;
+    }
+
+} // namespace messages
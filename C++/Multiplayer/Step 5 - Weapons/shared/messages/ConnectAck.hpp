@@ -6,7 +6,7 @@
     #pragma warning(push)
     #pragma warning(disable : 4127)
 #endif
-#include "ClientId.pb.h"
+#include "ConnectAck.pb.h"
 #if defined(_MSC_VER)
     #pragma warning(pop)
 #endif
@@ -14,23 +14,39 @@
 #include "Message.hpp"
 #include "MessageTypes.hpp"
 
+#include <string>
+#include <vector>
+
 namespace messages
 {
     // -----------------------------------------------------------------
     //
     // This message is send from the server to a client acknowledging
-    // a connection has been made.
+    // a connection has been made.  It carries the manifest of assets
+    // the client is going to need, so it can start loading them before
+    // any entity using them arrives.
     //
     // -----------------------------------------------------------------
     class ConnectAck : public Message
     {
       public:
+        ConnectAck(std::vector<std::string> assets) :
+            Message(Type::ConnectAck),
+            m_assets(assets)
+        {
+        }
+
         ConnectAck() :
             Message(Type::ConnectAck)
         {
         }
 
-        virtual std::string serializeToString() const override { return ""; }
-        virtual bool parseFromString(const std::string&) override { return true; }
+        virtual std::string serializeToString() const override;
+        virtual bool parseFromString(const std::string& source) override;
+
+        const auto& getAssets() const { return m_assets; }
+
+      private:
+        std::vector<std::string> m_assets;
     };
 } // namespace messages
@@ -49,6 +49,11 @@ namespace messages
             }
         }
 
+        if (m_viewTime.has_value())
+        {
+            pbInput.set_viewtime(std::chrono::duration_cast<std::chrono::microseconds>(m_viewTime.value().time_since_epoch()).count());
+        }
+
         return pbInput.SerializeAsString();
     }
 
@@ -64,4 +69,18 @@ namespace messages
         return success;
     }
 
+    // -----------------------------------------------------------------
+    //
+    // The server time of the world the client was seeing, if it sent one
+    //
+    // -----------------------------------------------------------------
+    std::optional<std::chrono::steady_clock::time_point> Input::getViewTime() const
+    {
+        if (m_pbInput.viewtime() == 0)
+        {
+            return std::nullopt;
+        }
+        return std::chrono::steady_clock::time_point(std::chrono::microseconds(m_pbInput.viewtime()));
+    }
+
 } // namespace messages
\ No newline at end of file
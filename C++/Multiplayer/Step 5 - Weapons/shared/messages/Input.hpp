@@ -19,6 +19,7 @@
 #include <SFML/Network.hpp>
 #include <chrono>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 namespace messages
@@ -26,17 +27,20 @@ namespace messages
     // -----------------------------------------------------------------
     //
     // This message is send from a client to the server informing it of
-    // a user input event.
+    // a user input event.  When the client knows it, the (server) time
+    // of the world it was seeing is included, so the server can judge
+    // hits from the client's point of view.
     //
     // -----------------------------------------------------------------
     class Input : public Message
     {
       public:
-        Input(entities::Entity::IdType id, std::vector<components::Input::Type> inputs, std::chrono::microseconds elapsedTime) :
+        Input(entities::Entity::IdType id, std::vector<components::Input::Type> inputs, std::chrono::microseconds elapsedTime, std::optional<std::chrono::steady_clock::time_point> viewTime = std::nullopt) :
             Message(Type::Input),
             m_entityId(id),
             m_inputs(inputs),
-            m_elapsedTime(elapsedTime)
+            m_elapsedTime(elapsedTime),
+            m_viewTime(viewTime)
         {
         }
 
@@ -56,11 +60,13 @@ namespace messages
 
         // Intended for server-side use
         const shared::Input& getPBInput() const { return m_pbInput; }
+        std::optional<std::chrono::steady_clock::time_point> getViewTime() const;
 
       private:
         entities::Entity::IdType m_entityId{0};
         std::vector<components::Input::Type> m_inputs;
         std::chrono::microseconds m_elapsedTime;
+        std::optional<std::chrono::steady_clock::time_point> m_viewTime;
 
         shared::Input m_pbInput;
     };
@@ -0,0 +1,44 @@
+#include "Join.hpp"
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // Use protobuffers to serialize to an std::string.  When there is
+    // no player to resume the message has no content.
+    //
+    // -----------------------------------------------------------------
+    std::string Join::serializeToString() const
+    {
+        if (!m_playerId)
+        {
+            return "";
+        }
+
+        shared::Join pbJoin;
+
+        pbJoin.set_playerid(m_playerId.value());
+        pbJoin.set_resumetoken(m_resumeToken);
+
+        return pbJoin.SerializeAsString();
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool Join::parseFromString(const std::string& source)
+    {
+        shared::Join pbJoin;
+        if (!pbJoin.ParseFromString(source))
+        {
+            return false;
+        }
+        m_playerId = pbJoin.playerid();
+        m_resumeToken = pbJoin.resumetoken();
+
+        return true;
+    }
+
+} // namespace messages
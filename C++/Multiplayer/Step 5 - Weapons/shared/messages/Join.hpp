@@ -1,25 +1,52 @@
 #pragma once
 
+//
+// Disable some compiler warnings that come from google protocol buffers
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4127)
+#endif
+#include "Join.pb.h"
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
 #include "Message.hpp"
 #include "MessageTypes.hpp"
+#include "entities/Entity.hpp"
+
+#include <cstdint>
+#include <optional>
 
 namespace messages
 {
     // -----------------------------------------------------------------
     //
-    // This message is sent from the server to join the game.  There is
-    // no content in the messsage, because the message itself is the information.
+    // This message is sent from the client to join the game.  A client
+    // that was already playing before it lost its connection (or the
+    // server restarted) includes the id of its player entity and the
+    // resume token from its JoinAck, so the server can give that player
+    // back to it.
     //
     // -----------------------------------------------------------------
     class Join : public Message
     {
       public:
-        Join() :
-            Message(Type::Join)
+        Join(std::optional<entities::Entity::IdType> playerId = std::nullopt, std::uint64_t resumeToken = 0) :
+            Message(Type::Join),
+            m_playerId(playerId),
+            m_resumeToken(resumeToken)
         {
         }
 
-        virtual std::string serializeToString() const override { return ""; }
-        virtual bool parseFromString(const std::string&) override { return true; }
+        virtual std::string serializeToString() const override;
+        virtual bool parseFromString(const std::string& source) override;
+
+        auto getPlayerId() const { return m_playerId; }
+        auto getResumeToken() const { return m_resumeToken; }
+
+      private:
+        std::optional<entities::Entity::IdType> m_playerId;
+        std::uint64_t m_resumeToken{0};
     };
 } // namespace messages
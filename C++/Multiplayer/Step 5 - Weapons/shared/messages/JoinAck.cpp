@@ -0,0 +1,38 @@
+#include "JoinAck.hpp"
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // Use protobuffers to serialize to an std::string
+    //
+    // -----------------------------------------------------------------
+    std::string JoinAck::serializeToString() const
+    {
+        shared::JoinAck pbJoinAck;
+
+        pbJoinAck.set_playerid(m_playerId);
+        pbJoinAck.set_resumetoken(m_resumeToken);
+
+        return pbJoinAck.SerializeAsString();
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool JoinAck::parseFromString(const std::string& source)
+    {
+        shared::JoinAck pbJoinAck;
+        if (!pbJoinAck.ParseFromString(source))
+        {
+            return false;
+        }
+        m_playerId = pbJoinAck.playerid();
+        m_resumeToken = pbJoinAck.resumetoken();
+
+        return true;
+    }
+
+} // namespace messages
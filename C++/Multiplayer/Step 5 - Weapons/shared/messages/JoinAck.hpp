@@ -0,0 +1,55 @@
+#pragma once
+
+//
+// Disable some compiler warnings that come from google protocol buffers
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4127)
+#endif
+#include "JoinAck.pb.h"
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
+#include "Message.hpp"
+#include "MessageTypes.hpp"
+#include "entities/Entity.hpp"
+
+#include <cstdint>
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // This message is sent from the server to a client once it has a
+    // player.  The resume token is known only to the server and that
+    // client, the client has to present it to get the player back
+    // after reconnecting.
+    //
+    // -----------------------------------------------------------------
+    class JoinAck : public Message
+    {
+      public:
+        JoinAck(entities::Entity::IdType playerId, std::uint64_t resumeToken) :
+            Message(Type::JoinAck),
+            m_playerId(playerId),
+            m_resumeToken(resumeToken)
+        {
+        }
+
+        JoinAck() :
+            Message(Type::JoinAck)
+        {
+        }
+
+        virtual std::string serializeToString() const override;
+        virtual bool parseFromString(const std::string& source) override;
+
+        auto getPlayerId() const { return m_playerId; }
+        auto getResumeToken() const { return m_resumeToken; }
+
+      private:
+        entities::Entity::IdType m_playerId{0};
+        std::uint64_t m_resumeToken{0};
+    };
+} // namespace messages
@@ -3,6 +3,7 @@
 #include "MessageTypes.hpp"
 
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -27,7 +28,21 @@ namespace messages
         auto getMessageId() { return m_messageId; }
         Type getType() { return m_type; }
 
+        //
+        // Set by the message queue as soon as a message is read off the network
+        void setReceivedTime(std::chrono::steady_clock::time_point time) { m_receivedTime = time; }
+        auto getReceivedTime() const { return m_receivedTime; }
+
         virtual std::string serializeToString() const = 0;
+        //
+        // The same, but carrying the given message id rather than the message's own, so a
+        // message shared by several clients is serialized with each one's id without being
+        // changed.  Messages that don't carry an id just serialize themselves.
+        virtual std::string serializeWithMessageId(std::uint32_t messageId) const
+        {
+            (void)messageId; // unused
+            return serializeToString();
+        }
         virtual bool parseFromString(const std::string& source) = 0;
 
       protected:
@@ -35,5 +50,6 @@ namespace messages
 
       private:
         Type m_type;
+        std::chrono::steady_clock::time_point m_receivedTime;
     };
 } // namespace messages
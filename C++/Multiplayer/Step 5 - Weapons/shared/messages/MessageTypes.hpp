@@ -17,6 +17,10 @@ namespace messages
         UpdateEntity, // Server to client
         RemoveEntity, // Server to client
         Join,         // Client to server
-        Input         // Client to server
+        Input,        // Client to server
+        WorldState,   // Server to client
+        Ping,         // Client to server
+        Pong,         // Server to client
+        JoinAck       // Server to client
     };
 } // namespace messages
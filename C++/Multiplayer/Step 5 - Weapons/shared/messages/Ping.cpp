@@ -0,0 +1,34 @@
+#include "Ping.hpp"
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // Use protobuffers to serialize to an std::string
+    //
+    // -----------------------------------------------------------------
+    std::string Ping::serializeToString() const
+    {
+        shared::Ping pbPing;
+
+        pbPing.set_clienttime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        pbPing.set_roundtriptime(m_roundTripTime.count());
+
+        return pbPing.SerializeAsString();
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool Ping::parseFromString(const std::string& source)
+    {
+        shared::Ping pbPing;
+        auto success = pbPing.ParseFromString(source);
+        m_clientTime = std::chrono::steady_clock::time_point(std::chrono::microseconds(pbPing.clienttime()));
+        m_roundTripTime = std::chrono::microseconds(pbPing.roundtriptime());
+        return success;
+    }
+
+} // namespace messages
@@ -0,0 +1,55 @@
+#pragma once
+
+//
+// Disable some compiler warnings that come from google protocol buffers
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4127)
+#endif
+#include "Ping.pb.h"
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
+#include "Message.hpp"
+#include "MessageTypes.hpp"
+
+#include <chrono>
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // This message is sent from a client to the server to measure the
+    // round trip time and the offset between their clocks.  The server
+    // answers with a Pong.  The client's time is taken as the message is
+    // serialized, just before it goes out on the wire.  The client's
+    // current round trip time estimate goes along, for the server to
+    // report.
+    //
+    // -----------------------------------------------------------------
+    class Ping : public Message
+    {
+      public:
+        Ping(std::chrono::microseconds roundTripTime) :
+            Message(Type::Ping),
+            m_roundTripTime(roundTripTime)
+        {
+        }
+
+        Ping() :
+            Message(Type::Ping)
+        {
+        }
+
+        virtual std::string serializeToString() const override;
+        virtual bool parseFromString(const std::string& source) override;
+
+        auto getClientTime() const { return m_clientTime; }
+        auto getRoundTripTime() const { return m_roundTripTime; }
+
+      private:
+        std::chrono::steady_clock::time_point m_clientTime;
+        std::chrono::microseconds m_roundTripTime{0};
+    };
+} // namespace messages
@@ -0,0 +1,53 @@
+#include "Pong.hpp"
+
+namespace messages
+{
+    namespace
+    {
+        std::int64_t toMicroseconds(std::chrono::steady_clock::time_point time)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        }
+
+        std::chrono::steady_clock::time_point fromMicroseconds(std::int64_t time)
+        {
+            return std::chrono::steady_clock::time_point(std::chrono::microseconds(time));
+        }
+    } // namespace
+
+    // -----------------------------------------------------------------
+    //
+    // Use protobuffers to serialize to an std::string
+    //
+    // -----------------------------------------------------------------
+    std::string Pong::serializeToString() const
+    {
+        shared::Pong pbPong;
+
+        pbPong.set_clienttime(toMicroseconds(m_clientTime));
+        pbPong.set_serverreceivetime(toMicroseconds(m_serverReceiveTime));
+        pbPong.set_servertransmittime(toMicroseconds(std::chrono::steady_clock::now()));
+        pbPong.set_tick(m_tick);
+
+        return pbPong.SerializeAsString();
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool Pong::parseFromString(const std::string& source)
+    {
+        shared::Pong pbPong;
+        auto success = pbPong.ParseFromString(source);
+
+        m_clientTime = fromMicroseconds(pbPong.clienttime());
+        m_serverReceiveTime = fromMicroseconds(pbPong.serverreceivetime());
+        m_serverTransmitTime = fromMicroseconds(pbPong.servertransmittime());
+        m_tick = pbPong.tick();
+
+        return success;
+    }
+
+} // namespace messages
@@ -0,0 +1,64 @@
+#pragma once
+
+//
+// Disable some compiler warnings that come from google protocol buffers
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4127)
+#endif
+#include "Pong.pb.h"
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
+#include "Message.hpp"
+#include "MessageTypes.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // This message is sent from the server to a client in answer to a
+    // Ping.  It has the three timestamps the client needs, along with
+    // its own receive time, to compute the round trip time and clock
+    // offset.  The transmit time is taken as the message is serialized,
+    // which is as close to it going out on the wire as we can get.
+    //
+    // Times are on each side's steady_clock, they only mean something
+    // relative to other times from the same side.
+    //
+    // -----------------------------------------------------------------
+    class Pong : public Message
+    {
+      public:
+        Pong(std::chrono::steady_clock::time_point clientTime, std::chrono::steady_clock::time_point serverReceiveTime, std::uint64_t tick) :
+            Message(Type::Pong),
+            m_clientTime(clientTime),
+            m_serverReceiveTime(serverReceiveTime),
+            m_tick(tick)
+        {
+        }
+
+        Pong() :
+            Message(Type::Pong)
+        {
+        }
+
+        virtual std::string serializeToString() const override;
+        virtual bool parseFromString(const std::string& source) override;
+
+        auto getClientTime() const { return m_clientTime; }
+        auto getServerReceiveTime() const { return m_serverReceiveTime; }
+        auto getServerTransmitTime() const { return m_serverTransmitTime; }
+        auto getTick() const { return m_tick; }
+
+      private:
+        std::chrono::steady_clock::time_point m_clientTime;
+        std::chrono::steady_clock::time_point m_serverReceiveTime;
+        std::chrono::steady_clock::time_point m_serverTransmitTime;
+        std::uint64_t m_tick{0};
+    };
+} // namespace messages
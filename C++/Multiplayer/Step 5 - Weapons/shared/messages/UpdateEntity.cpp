@@ -12,10 +12,20 @@ namespace messages
     //
     // -----------------------------------------------------------------
     std::string UpdateEntity::serializeToString() const
+    {
+        return serialize(m_messageId.value());
+    }
+
+    std::string UpdateEntity::serializeWithMessageId(std::uint32_t messageId) const
+    {
+        return serialize(messageId);
+    }
+
+    std::string UpdateEntity::serialize(std::uint32_t messageId) const
     {
         shared::Entity pbEntity;
 
-        pbEntity.mutable_messageid()->set_id(m_messageId.value());
+        pbEntity.mutable_messageid()->set_id(messageId);
 
         pbEntity.set_id(m_entity->getId());
 
@@ -35,6 +45,8 @@ namespace messages
         }
 
         pbEntity.set_updatewindow(static_cast<std::uint32_t>(m_updateWindow.count()));
+        pbEntity.set_tick(m_tick);
+        pbEntity.set_servertime(std::chrono::duration_cast<std::chrono::microseconds>(m_serverTime.time_since_epoch()).count());
 
         return pbEntity.SerializeAsString();
     }
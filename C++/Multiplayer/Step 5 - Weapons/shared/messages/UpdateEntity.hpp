@@ -16,6 +16,7 @@
 #include "entities/Entity.hpp"
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 
 namespace messages
@@ -29,10 +30,12 @@ namespace messages
     class UpdateEntity : public Message
     {
       public:
-        UpdateEntity(std::shared_ptr<entities::Entity> entity, const std::chrono::microseconds updateWindow) :
+        UpdateEntity(std::shared_ptr<entities::Entity> entity, const std::chrono::microseconds updateWindow, std::uint64_t tick, const std::chrono::steady_clock::time_point serverTime) :
             Message(Type::UpdateEntity),
             m_entity(entity),
-            m_updateWindow(updateWindow)
+            m_updateWindow(updateWindow),
+            m_tick(tick),
+            m_serverTime(serverTime)
         {
         }
 
@@ -42,14 +45,20 @@ namespace messages
         }
 
         virtual std::string serializeToString() const override;
+        virtual std::string serializeWithMessageId(std::uint32_t messageId) const override;
         virtual bool parseFromString(const std::string& source) override;
 
         auto getEntity() { return m_entity; }
         const shared::Entity& getPBEntity() const { return m_pbEntity; }
+        auto getServerTime() const { return std::chrono::steady_clock::time_point(std::chrono::microseconds(m_pbEntity.servertime())); }
 
       private:
         std::shared_ptr<entities::Entity> m_entity;
         std::chrono::microseconds m_updateWindow{0};
+        std::uint64_t m_tick{0};
+        std::chrono::steady_clock::time_point m_serverTime;
         shared::Entity m_pbEntity;
+
+        std::string serialize(std::uint32_t messageId) const;
     };
 } // namespace messages
\ No newline at end of file
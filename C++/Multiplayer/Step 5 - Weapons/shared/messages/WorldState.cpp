@@ -0,0 +1,158 @@
+#include "WorldState.hpp"
+
+#include "components/Appearance.hpp"
+#include "components/Lifetime.hpp"
+#include "components/Momentum.hpp"
+#include "components/Movement.hpp"
+#include "components/Position.hpp"
+#include "components/Size.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // Packs all entities that have a Position and Size into chunks whose
+    // serialized size does not exceed maxChunkSize (a single entity is
+    // always allowed in a chunk, no matter its size).  Each chunk carries
+    // its own table of texture names, entities refer to their texture by
+    // index into that table rather than repeating the string.
+    //
+    // -----------------------------------------------------------------
+    std::vector<std::shared_ptr<WorldState>> WorldState::createChunks(const entities::EntityMap& entities, std::size_t maxChunkSize)
+    {
+        std::vector<shared::WorldState> pbChunks(1);
+        std::unordered_map<std::string, std::uint32_t> textureIndex;
+        std::size_t chunkSize = 0;
+
+        for (auto& [entityId, entity] : entities)
+        {
+            if (!entity->hasComponent<components::Position>() || !entity->hasComponent<components::Size>())
+            {
+                continue;
+            }
+
+            shared::WorldStateEntity pbEntity;
+            pbEntity.set_id(entityId);
+
+            auto position = entity->getComponent<components::Position>();
+            pbEntity.set_centerx(position->get().x);
+            pbEntity.set_centery(position->get().y);
+            pbEntity.set_orientation(position->getOrientation());
+            pbEntity.set_size(entity->getComponent<components::Size>()->get().x);
+
+            if (entity->hasComponent<components::Momentum>())
+            {
+                auto momentum = entity->getComponent<components::Momentum>();
+                pbEntity.mutable_momentum()->mutable_momentum()->set_x(momentum->get().x);
+                pbEntity.mutable_momentum()->mutable_momentum()->set_y(momentum->get().y);
+            }
+
+            if (entity->hasComponent<components::Movement>())
+            {
+                auto movement = entity->getComponent<components::Movement>();
+                pbEntity.mutable_movement()->set_thrustrate(movement->getThrustRate());
+                pbEntity.mutable_movement()->set_rotaterate(movement->getRotateRate());
+            }
+
+            if (entity->hasComponent<components::Lifetime>())
+            {
+                auto lifetime = entity->getComponent<components::Lifetime>();
+                pbEntity.mutable_lifetime()->set_howlong(static_cast<std::uint32_t>(lifetime->get().count()));
+            }
+
+            //
+            // Start a new chunk if this entity would push the current one over the limit.
+            // The running size is an estimate, a few bytes per entry are allowed for the
+            // field tag and length prefix.
+            auto* chunk = &pbChunks.back();
+            auto entitySize = pbEntity.ByteSizeLong() + 8;
+            if (chunk->entities_size() > 0 && chunkSize + entitySize > maxChunkSize)
+            {
+                pbChunks.emplace_back();
+                textureIndex.clear();
+                chunkSize = 0;
+                chunk = &pbChunks.back();
+            }
+            chunkSize += entitySize;
+
+            if (entity->hasComponent<components::Appearance>())
+            {
+                auto texture = entity->getComponent<components::Appearance>()->getTexture();
+                auto [entry, inserted] = textureIndex.try_emplace(texture, static_cast<std::uint32_t>(chunk->textures_size()));
+                if (inserted)
+                {
+                    chunk->add_textures(texture);
+                    chunkSize += texture.size() + 2;
+                }
+                pbEntity.set_texture(entry->second);
+            }
+
+            *chunk->add_entities() = std::move(pbEntity);
+        }
+
+        std::vector<std::shared_ptr<WorldState>> chunks;
+        for (std::size_t chunk = 0; chunk < pbChunks.size(); chunk++)
+        {
+            pbChunks[chunk].set_chunk(static_cast<std::uint32_t>(chunk));
+            pbChunks[chunk].set_chunkcount(static_cast<std::uint32_t>(pbChunks.size()));
+            chunks.push_back(std::make_shared<WorldState>(pbChunks[chunk].SerializeAsString()));
+        }
+
+        return chunks;
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Parse the protobuffer object from an std::string
+    //
+    // -----------------------------------------------------------------
+    bool WorldState::parseFromString(const std::string& source)
+    {
+        return m_pbWorldState.ParseFromString(source);
+    }
+
+    // -----------------------------------------------------------------
+    //
+    // Expands one of the compact world state entities back into the same
+    // protobuf Entity representation a NewEntity message carries.
+    //
+    // -----------------------------------------------------------------
+    shared::Entity WorldState::getPBEntity(int index) const
+    {
+        auto& pbState = m_pbWorldState.entities(index);
+        shared::Entity pbEntity;
+
+        pbEntity.set_id(pbState.id());
+
+        if (pbState.has_texture() && static_cast<int>(pbState.texture()) < m_pbWorldState.textures_size())
+        {
+            pbEntity.mutable_appearance()->set_texture(m_pbWorldState.textures(pbState.texture()));
+        }
+
+        pbEntity.mutable_position()->mutable_center()->set_x(pbState.centerx());
+        pbEntity.mutable_position()->mutable_center()->set_y(pbState.centery());
+        pbEntity.mutable_position()->set_orientation(pbState.orientation());
+        pbEntity.mutable_size()->mutable_size()->set_x(pbState.size());
+        pbEntity.mutable_size()->mutable_size()->set_y(pbState.size());
+
+        if (pbState.has_momentum())
+        {
+            *pbEntity.mutable_momentum() = pbState.momentum();
+        }
+        if (pbState.has_movement())
+        {
+            *pbEntity.mutable_movement() = pbState.movement();
+        }
+        if (pbState.has_lifetime())
+        {
+            *pbEntity.mutable_lifetime() = pbState.lifetime();
+        }
+        pbEntity.set_updatewindow(0);
+
+        return pbEntity;
+    }
+
+} // namespace messages
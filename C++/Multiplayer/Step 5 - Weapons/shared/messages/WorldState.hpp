@@ -0,0 +1,61 @@
+#pragma once
+
+//
+// Disable some compiler warnings that come from google protocol buffers
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4127)
+#endif
+#include "Entity.pb.h"
+#include "WorldState.pb.h"
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
+#include "Message.hpp"
+#include "MessageTypes.hpp"
+#include "entities/Entity.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace messages
+{
+    // -----------------------------------------------------------------
+    //
+    // This message is sent from the server to a newly joined client to
+    // tell it about all entities already in the game.  The world is split
+    // into bounded-size chunks that are streamed over several updates.
+    //
+    // Each chunk is serialized once, when the chunks are created, and that
+    // encoding is shared by every client it is sent to.
+    //
+    // -----------------------------------------------------------------
+    class WorldState : public Message
+    {
+      public:
+        WorldState(std::string serialized) :
+            Message(Type::WorldState),
+            m_serialized(std::move(serialized))
+        {
+        }
+        WorldState() :
+            Message(Type::WorldState)
+        {
+        }
+
+        static std::vector<std::shared_ptr<WorldState>> createChunks(const entities::EntityMap& entities, std::size_t maxChunkSize);
+
+        virtual std::string serializeToString() const override { return m_serialized; }
+        virtual bool parseFromString(const std::string& source) override;
+
+        const shared::WorldState& getPBWorldState() const { return m_pbWorldState; }
+        shared::Entity getPBEntity(int index) const;
+
+      private:
+        std::string m_serialized;
+        shared::WorldState m_pbWorldState;
+    };
+} // namespace messages
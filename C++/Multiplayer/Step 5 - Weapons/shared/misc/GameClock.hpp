@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// --------------------------------------------------------------
+//
+// The simulated time of the world, how far the game model has been
+// advanced since it started.  Anything that happens "some time from
+// now" (lifetimes, input cooldowns) is recorded as a time on this
+// clock, rather than a countdown that has to be updated every tick.
+//
+// The game model advances it once per update, it can be read from any
+// thread (e.g. while messages are serialized).
+//
+// Note: This is a Singleton
+//
+// --------------------------------------------------------------
+class GameClock
+{
+  public:
+    GameClock(const GameClock&) = delete;
+    GameClock(GameClock&&) = delete;
+    GameClock& operator=(const GameClock&) = delete;
+    GameClock& operator=(GameClock&&) = delete;
+
+    static auto& instance()
+    {
+        static GameClock instance;
+        return instance;
+    }
+
+    void advance(std::chrono::microseconds elapsedTime) { m_now += elapsedTime.count(); }
+    std::chrono::microseconds now() const { return std::chrono::microseconds(m_now.load()); }
+
+  private:
+    GameClock() {}
+
+    std::atomic<std::int64_t> m_now{0};
+};
@@ -0,0 +1,85 @@
+#include "Kinematics.hpp"
+
+#if defined(SIMD_X64)
+    #include <immintrin.h>
+#endif
+
+namespace kinematics
+{
+    namespace
+    {
+        void driftScalar(float* x, float* y, const float* vx, const float* vy, const float* dt, std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                x[i] = advance(x[i], vx[i], dt[i]);
+                y[i] = advance(y[i], vy[i], dt[i]);
+            }
+        }
+
+#if defined(SIMD_X64)
+        std::size_t driftSse(float* x, float* y, const float* vx, const float* vy, const float* dt, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                auto time = _mm_loadu_ps(dt + i);
+                _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), time)));
+                _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(vy + i), time)));
+            }
+            return i;
+        }
+
+        SIMD_TARGET_AVX2 std::size_t driftAvx2(float* x, float* y, const float* vx, const float* vy, const float* dt, std::size_t count)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto time = _mm256_loadu_ps(dt + i);
+                _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), time)));
+                _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), time)));
+            }
+            return i;
+        }
+#endif
+    } // namespace
+
+    // --------------------------------------------------------------
+    //
+    // Moves every entity in the batch by its momentum for its time.
+    //
+    // --------------------------------------------------------------
+    void drift(Batch& batch)
+    {
+        drift(batch, simd::getIsa());
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Same as above, using the given instruction set, which must be
+    // supported.  Whatever doesn't fill a whole SIMD register is done
+    // one at a time.
+    //
+    // --------------------------------------------------------------
+    void drift(Batch& batch, simd::Isa isa)
+    {
+        auto count = batch.size();
+        std::size_t done = 0;
+#if defined(SIMD_X64)
+        switch (isa)
+        {
+            case simd::Isa::Avx2:
+                done = driftAvx2(batch.position.x.data(), batch.position.y.data(), batch.velocity.x.data(), batch.velocity.y.data(), batch.dt.data(), count);
+                break;
+            case simd::Isa::Sse:
+                done = driftSse(batch.position.x.data(), batch.position.y.data(), batch.velocity.x.data(), batch.velocity.y.data(), batch.dt.data(), count);
+                break;
+            case simd::Isa::Scalar:
+                break;
+        }
+#else
+        (void)isa; // unused
+#endif
+        driftScalar(batch.position.x.data(), batch.position.y.data(), batch.velocity.x.data(), batch.velocity.y.data(), batch.dt.data(), done, count);
+    }
+} // namespace kinematics
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "misc/Simd.hpp"
+#include "misc/math.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Batched movement of entities.  The positions, momentums and times of
+// the entities being moved are packed into parallel arrays (a Batch),
+// which are integrated in one pass using the widest SIMD instructions
+// the CPU supports (see misc/Simd.hpp).
+//
+// Every implementation does exactly the same arithmetic, a single
+// precision multiply followed by a single precision add, with no fused
+// multiply-add.  The results are bit-for-bit the same whichever one
+// runs, and the same as entities::drift, so the client and server
+// always agree on where an entity drifted to.
+//
+// --------------------------------------------------------------
+namespace kinematics
+{
+    struct Batch
+    {
+        math::Vector2fBlock position;
+        math::Vector2fBlock velocity; // units per microsecond
+        std::vector<float> dt;        // microseconds
+
+        std::size_t size() const { return position.size(); }
+        void resize(std::size_t count)
+        {
+            position.resize(count);
+            velocity.resize(count);
+            dt.resize(count);
+        }
+        void clear()
+        {
+            position.clear();
+            velocity.clear();
+            dt.clear();
+        }
+        void push_back(math::Vector2f position, math::Vector2f velocity, float dt)
+        {
+            this->position.push_back(position);
+            this->velocity.push_back(velocity);
+            this->dt.push_back(dt);
+        }
+    };
+
+    //
+    // The one step all of the implementations perform
+    inline float advance(float position, float velocity, float dt) { return position + velocity * dt; }
+
+    void drift(Batch& batch);
+    void drift(Batch& batch, simd::Isa isa);
+} // namespace kinematics
@@ -0,0 +1,160 @@
+#include "Profiler.hpp"
+
+#if defined(PROFILER_ENABLED)
+    #include <fstream>
+    #include <iostream>
+
+namespace profiler
+{
+    void Profiler::recordScope(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        record({name,
+                std::chrono::duration_cast<std::chrono::microseconds>(start - m_start).count(),
+                std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                false});
+    }
+
+    void Profiler::recordCounter(const char* name, std::int64_t value)
+    {
+        record({name,
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count(),
+                value,
+                true});
+    }
+
+    void Profiler::setThreadName(std::string name)
+    {
+        auto& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(m_mutexThreads);
+        buffer.threadName = name;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The first time a thread records anything it gets a buffer, after
+    // that the thread_local pointer is all it needs.
+    //
+    // --------------------------------------------------------------
+    Profiler::ThreadBuffer& Profiler::threadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(m_mutexThreads);
+            m_threads.push_back(std::make_unique<ThreadBuffer>());
+            buffer = m_threads.back().get();
+            buffer->threadId = static_cast<std::uint32_t>(m_threads.size());
+            buffer->head = new Block();
+            buffer->tail = buffer->head;
+            buffer->blocks = 1;
+        }
+        return *buffer;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // The event is written before the count is published, so the trace
+    // writer never sees a partially written event.  If the trace hasn't
+    // been written in a long while, events are dropped rather than let
+    // the buffer grow without limit.
+    //
+    // --------------------------------------------------------------
+    void Profiler::record(const Event& event)
+    {
+        auto& buffer = threadBuffer();
+        auto* block = buffer.tail;
+        auto count = block->count.load(std::memory_order_relaxed);
+        if (count == Block::CAPACITY)
+        {
+            if (buffer.blocks.load(std::memory_order_relaxed) >= MAX_BLOCKS_PER_THREAD)
+            {
+                buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            auto* next = new Block();
+            buffer.blocks.fetch_add(1, std::memory_order_relaxed);
+            block->next.store(next, std::memory_order_release);
+            buffer.tail = next;
+            block = next;
+            count = 0;
+        }
+        block->events[count] = event;
+        block->count.store(count + 1, std::memory_order_release);
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Writes all events recorded since the last trace was written.  Full
+    // blocks that have been written are freed, the last block of each
+    // thread is kept because its thread may still be adding to it.
+    //
+    // --------------------------------------------------------------
+    bool Profiler::writeTrace(const std::string& path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "Unable to write the trace file: " << path << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutexThreads);
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        auto separator = [&file, &first]() {
+            file << (first ? "" : ",\n");
+            first = false;
+        };
+
+        for (auto& thread : m_threads)
+        {
+            separator();
+            auto name = thread->threadName.empty() ? "Thread " + std::to_string(thread->threadId) : thread->threadName;
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId << ",\"args\":{\"name\":\"" << name << "\"}}";
+
+            while (true)
+            {
+                //
+                // The next block is loaded before the count: a thread only starts a new
+                // block once this one is full, so when there is a next block the count
+                // loaded after it is the final one, and none of the events are lost
+                // when the block is freed
+                auto* block = thread->head;
+                auto* next = block->next.load(std::memory_order_acquire);
+                auto count = block->count.load(std::memory_order_acquire);
+                for (; thread->headRead < count; thread->headRead++)
+                {
+                    auto& event = block->events[thread->headRead];
+                    separator();
+                    if (event.counter)
+                    {
+                        file << "{\"name\":\"" << event.name << "\",\"ph\":\"C\",\"ts\":" << event.start << ",\"pid\":1,\"tid\":" << thread->threadId << ",\"args\":{\"value\":" << event.value << "}}";
+                    }
+                    else
+                    {
+                        file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.value << ",\"pid\":1,\"tid\":" << thread->threadId << "}";
+                    }
+                }
+
+                if (next == nullptr)
+                {
+                    break;
+                }
+                thread->head = next;
+                thread->headRead = 0;
+                thread->blocks.fetch_sub(1, std::memory_order_relaxed);
+                delete block;
+            }
+
+            auto dropped = thread->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+            {
+                std::cout << name << " dropped " << dropped << " profile events" << std::endl;
+            }
+        }
+        file << "\n]}\n";
+
+        return true;
+    }
+} // namespace profiler
+#endif
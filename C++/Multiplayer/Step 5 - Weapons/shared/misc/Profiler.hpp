@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// Scoped timing for viewing the game loop and network threads on one
+// timeline, in chrome://tracing or the Perfetto UI.
+//
+//      PROFILE_SCOPE("Damage::update");             // times until the end of the scope
+//      PROFILE_COUNTER("Received messages", count); // plots a value over time
+//      PROFILE_THREAD("Shard 0 sender");            // names the current thread
+//
+// Each thread records into its own buffer, a chain of fixed size
+// blocks it only ever appends to, so recording takes no locks.
+// Profiler::writeTrace drains every thread's buffer, writing the events
+// as trace event JSON, and frees the blocks it has finished with.
+//
+// Scope and counter names must be string literals (or otherwise live
+// for the life of the program), only the pointer is recorded.
+//
+// All of this compiles away unless PROFILER_ENABLED is defined (the
+// PROFILER CMake option).
+//
+// --------------------------------------------------------------
+namespace profiler
+{
+#if defined(PROFILER_ENABLED)
+    class Profiler
+    {
+      public:
+        Profiler(const Profiler&) = delete;
+        Profiler(Profiler&&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+        Profiler& operator=(Profiler&&) = delete;
+
+        static auto& instance()
+        {
+            static Profiler instance;
+            return instance;
+        }
+
+        void recordScope(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+        void recordCounter(const char* name, std::int64_t value);
+        void setThreadName(std::string name);
+        bool writeTrace(const std::string& path);
+
+      private:
+        Profiler() {}
+
+        struct Event
+        {
+            const char* name;
+            std::int64_t start; // microseconds since the profiler started
+            std::int64_t value; // duration (microseconds) for scopes, the value for counters
+            bool counter;
+        };
+
+        struct Block
+        {
+            static constexpr std::size_t CAPACITY = 4096;
+            Event events[CAPACITY];
+            std::atomic<std::size_t> count{0};
+            std::atomic<Block*> next{nullptr};
+        };
+
+        // --------------------------------------------------------------
+        //
+        // One thread's events.  The owning thread appends to the tail,
+        // the writer reads from the head and frees the blocks behind it.
+        //
+        // --------------------------------------------------------------
+        struct ThreadBuffer
+        {
+            std::uint32_t threadId{0};
+            std::string threadName;
+            Block* head{nullptr};
+            Block* tail{nullptr};
+            std::size_t headRead{0}; // events of the head block already written
+            std::atomic<std::size_t> blocks{0};
+            std::atomic<std::uint64_t> dropped{0};
+        };
+
+        static constexpr std::size_t MAX_BLOCKS_PER_THREAD = 256;
+
+        std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+        std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+        std::mutex m_mutexThreads; // only for registering threads and writing traces
+
+        ThreadBuffer& threadBuffer();
+        void record(const Event& event);
+    };
+
+    // --------------------------------------------------------------
+    //
+    // Records the time from construction to destruction.
+    //
+    // --------------------------------------------------------------
+    class Scope
+    {
+      public:
+        Scope(const char* name) :
+            m_name(name),
+            m_start(std::chrono::steady_clock::now())
+        {
+        }
+        ~Scope() { Profiler::instance().recordScope(m_name, m_start, std::chrono::steady_clock::now()); }
+
+      private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    #define PROFILE_CONCATENATE_INNER(a, b) a##b
+    #define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+    #define PROFILE_SCOPE(name) profiler::Scope PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+    #define PROFILE_COUNTER(name, value) profiler::Profiler::instance().recordCounter(name, static_cast<std::int64_t>(value))
+    #define PROFILE_THREAD(name) profiler::Profiler::instance().setThreadName(name)
+#else
+    class Profiler
+    {
+      public:
+        static auto& instance()
+        {
+            static Profiler instance;
+            return instance;
+        }
+
+        bool writeTrace([[maybe_unused]] const std::string& path) { return false; }
+    };
+
+    #define PROFILE_SCOPE(name)
+    #define PROFILE_COUNTER(name, value)
+    #define PROFILE_THREAD(name)
+#endif
+} // namespace profiler
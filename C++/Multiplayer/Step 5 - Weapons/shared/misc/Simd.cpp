@@ -0,0 +1,73 @@
+#include "Simd.hpp"
+
+#if defined(SIMD_X64) && defined(_MSC_VER)
+    #include <immintrin.h>
+    #include <intrin.h>
+#endif
+
+namespace simd
+{
+    namespace
+    {
+        Isa detectIsa()
+        {
+#if defined(SIMD_X64)
+    #if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return Isa::Sse;
+            }
+            __cpuid(info, 1);
+            bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            return osSavesAvx && (info[1] & (1 << 5)) != 0 ? Isa::Avx2 : Isa::Sse;
+    #else
+            return __builtin_cpu_supports("avx2") ? Isa::Avx2 : Isa::Sse;
+    #endif
+#else
+            return Isa::Scalar;
+#endif
+        }
+    } // namespace
+
+    // --------------------------------------------------------------
+    //
+    // SSE2 is part of every x64 CPU, AVX2 has to be asked about.
+    //
+    // --------------------------------------------------------------
+    bool isSupported(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::Scalar:
+                return true;
+            case Isa::Sse:
+                return getIsa() != Isa::Scalar;
+            case Isa::Avx2:
+                return getIsa() == Isa::Avx2;
+        }
+        return false;
+    }
+
+    Isa getIsa()
+    {
+        static const Isa isa = detectIsa();
+        return isa;
+    }
+
+    const char* toString(Isa isa)
+    {
+        switch (isa)
+        {
+            case Isa::Scalar:
+                return "scalar";
+            case Isa::Sse:
+                return "sse";
+            case Isa::Avx2:
+                return "avx2";
+        }
+        return "unknown";
+    }
+} // namespace simd
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// --------------------------------------------------------------
+//
+// Which SIMD instructions the batched kernels (misc/math.hpp,
+// misc/Kinematics.hpp) may use.  The best one the CPU supports is
+// found once, at runtime; the kernels can also be asked to use a
+// particular one (e.g. to compare them in the benchmarks).
+//
+// --------------------------------------------------------------
+namespace simd
+{
+    enum class Isa : std::uint8_t
+    {
+        Scalar,
+        Sse,
+        Avx2
+    };
+
+    bool isSupported(Isa isa);
+    Isa getIsa();
+    const char* toString(Isa isa);
+} // namespace simd
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SIMD_X64
+#endif
+
+//
+// GCC and Clang only allow AVX2 intrinsics in functions compiled for it,
+// MSVC allows them anywhere.
+#if defined(SIMD_X64) && !defined(_MSC_VER)
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define SIMD_TARGET_AVX2
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "SlotTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------------
+//
+// A hierarchical timing wheel: values scheduled to come due at an
+// absolute time, handed back as the wheel is advanced past that time.
+//
+// Time is counted in ticks of the wheel's resolution.  The first level
+// has a slot per tick for the next 256 ticks, each level above it a slot
+// per 256 ticks of the level below.  A timer is placed in the lowest
+// level that reaches its due tick, and is moved down a level (cascaded)
+// when the wheel gets to its slot.  Scheduling and cancelling are O(1),
+// advancing costs a step per tick plus the timers that come due or are
+// cascaded, no matter how many timers are waiting.
+//
+// Timers are kept in a SlotTable, the wheel slots only hold their keys.
+// Cancelling erases the timer from the table, the stale key is skipped
+// when its slot comes up.
+//
+// --------------------------------------------------------------
+template <typename T>
+class TimerWheel
+{
+  private:
+    struct Timer
+    {
+        std::uint64_t due; // tick
+        T value;
+    };
+
+  public:
+    using Handle = typename SlotTable<Timer>::Key;
+
+    TimerWheel(std::chrono::microseconds resolution = std::chrono::milliseconds(1)) :
+        m_resolution(resolution)
+    {
+    }
+
+    // ------------------------------------------------------------------
+    //
+    // The value comes due the first time the wheel is advanced to (or
+    // past) the time, a time already passed comes due on the next advance.
+    //
+    // ------------------------------------------------------------------
+    Handle schedule(std::chrono::microseconds due, T value)
+    {
+        auto dueTick = static_cast<std::uint64_t>(std::max(std::int64_t(0), (due.count() + m_resolution.count() - 1) / m_resolution.count()));
+        dueTick = std::max(dueTick, m_tick + 1);
+
+        auto handle = m_timers.insert({dueTick, std::move(value)});
+        place(handle, dueTick);
+        return handle;
+    }
+
+    bool cancel(Handle handle) { return m_timers.erase(handle); }
+
+    // ------------------------------------------------------------------
+    //
+    // Moves the wheel forward to the time, calling expired with each
+    // value that comes due, in order of due tick.
+    //
+    // ------------------------------------------------------------------
+    template <typename Expired>
+    void advance(std::chrono::microseconds to, Expired&& expired)
+    {
+        auto toTick = static_cast<std::uint64_t>(std::max(std::int64_t(0), to.count() / m_resolution.count()));
+        while (m_tick < toTick)
+        {
+            if (m_timers.empty())
+            {
+                m_tick = toTick;
+                break;
+            }
+            m_tick++;
+            //
+            // Bring down any levels whose slot turned over, highest first,
+            // so their timers land in the levels below before those are cascaded.
+            for (auto level = LEVELS - 1; level > 0; level--)
+            {
+                if ((m_tick & ((std::uint64_t(1) << (BITS * level)) - 1)) == 0)
+                {
+                    cascade(level);
+                }
+            }
+
+            auto& slot = m_levels[0][m_tick & (SLOTS - 1)];
+            auto due = std::move(slot);
+            slot.clear();
+            for (auto handle : due)
+            {
+                if (auto timer = m_timers.get(handle); timer != nullptr)
+                {
+                    auto value = std::move(timer->value);
+                    m_timers.erase(handle);
+                    expired(value);
+                }
+            }
+        }
+    }
+
+    std::size_t size() const { return m_timers.size(); }
+    bool empty() const { return m_timers.empty(); }
+
+  private:
+    static constexpr std::uint32_t BITS = 8;
+    static constexpr std::uint32_t SLOTS = 1 << BITS;
+    static constexpr std::uint32_t LEVELS = 4;
+
+    std::chrono::microseconds m_resolution;
+    std::uint64_t m_tick{0};
+    std::array<std::array<std::vector<Handle>, SLOTS>, LEVELS> m_levels;
+    SlotTable<Timer> m_timers;
+
+    void place(Handle handle, std::uint64_t dueTick)
+    {
+        auto delta = dueTick - m_tick;
+        for (std::uint32_t level = 0; level < LEVELS; level++)
+        {
+            if (delta < (std::uint64_t(1) << (BITS * (level + 1))) || level == LEVELS - 1)
+            {
+                //
+                // Beyond the reach of the top level, park it in the top level's
+                // furthest slot, it is placed again when that slot comes up
+                auto tick = level == LEVELS - 1 ? std::min(dueTick, m_tick + (std::uint64_t(1) << (BITS * LEVELS)) - 1) : dueTick;
+                m_levels[level][(tick >> (BITS * level)) & (SLOTS - 1)].push_back(handle);
+                return;
+            }
+        }
+    }
+
+    void cascade(std::uint32_t level)
+    {
+        auto& slot = m_levels[level][(m_tick >> (BITS * level)) & (SLOTS - 1)];
+        auto timers = std::move(slot);
+        slot.clear();
+        for (auto handle : timers)
+        {
+            if (auto timer = m_timers.get(handle); timer != nullptr)
+            {
+                place(handle, timer->due);
+            }
+        }
+    }
+};
@@ -0,0 +1,207 @@
+#include "math.hpp"
+
+#if defined(SIMD_X64)
+    #include <immintrin.h>
+#endif
+
+namespace math
+{
+    namespace
+    {
+        void sincosScalar(const float* radians, float* sines, float* cosines, std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                sincos(radians[i], sines[i], cosines[i]);
+            }
+        }
+
+        void distanceSquaredScalar(const float* x, const float* y, Vector2f to, float* distances, std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                distances[i] = distanceSquared({x[i], y[i]}, to);
+            }
+        }
+
+#if defined(SIMD_X64)
+        //
+        // The SSE and AVX2 versions are the same steps as math::sincos, done four or eight
+        // at a time: the polynomial choice and the signs are applied with masks.
+        std::size_t sincosSse(const float* radians, float* sines, float* cosines, std::size_t count)
+        {
+            using namespace sincosdetail;
+
+            const auto signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<std::int32_t>(0x80000000)));
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                auto angle = _mm_loadu_ps(radians + i);
+                auto signSin = _mm_and_ps(angle, signMask);
+                auto x = _mm_andnot_ps(signMask, angle);
+
+                auto octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+                octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+                auto y = _mm_cvtepi32_ps(octant);
+
+                auto swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+                auto signCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+                auto swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+                signSin = _mm_xor_ps(signSin, swapSignSin);
+
+                x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+                x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+                x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+                auto z = _mm_mul_ps(x, x);
+
+                auto polyCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+                polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(COS_P2));
+                polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+                polyCos = _mm_sub_ps(polyCos, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+                polyCos = _mm_add_ps(polyCos, _mm_set1_ps(1.0f));
+
+                auto polySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+                polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(SIN_P2));
+                polySin = _mm_mul_ps(_mm_mul_ps(polySin, z), x);
+                polySin = _mm_add_ps(polySin, x);
+
+                auto sine = _mm_or_ps(_mm_and_ps(swap, polyCos), _mm_andnot_ps(swap, polySin));
+                auto cosine = _mm_or_ps(_mm_and_ps(swap, polySin), _mm_andnot_ps(swap, polyCos));
+                _mm_storeu_ps(sines + i, _mm_xor_ps(sine, signSin));
+                _mm_storeu_ps(cosines + i, _mm_xor_ps(cosine, signCos));
+            }
+            return i;
+        }
+
+        SIMD_TARGET_AVX2 std::size_t sincosAvx2(const float* radians, float* sines, float* cosines, std::size_t count)
+        {
+            using namespace sincosdetail;
+
+            const auto signMask = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<std::int32_t>(0x80000000)));
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto angle = _mm256_loadu_ps(radians + i);
+                auto signSin = _mm256_and_ps(angle, signMask);
+                auto x = _mm256_andnot_ps(signMask, angle);
+
+                auto octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+                octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+                auto y = _mm256_cvtepi32_ps(octant);
+
+                auto swapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+                auto signCos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+                auto swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+                signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+                x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP1)));
+                x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP2)));
+                x = _mm256_sub_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP3)));
+                auto z = _mm256_mul_ps(x, x);
+
+                auto polyCos = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_P0), z), _mm256_set1_ps(COS_P1));
+                polyCos = _mm256_add_ps(_mm256_mul_ps(polyCos, z), _mm256_set1_ps(COS_P2));
+                polyCos = _mm256_mul_ps(_mm256_mul_ps(polyCos, z), z);
+                polyCos = _mm256_sub_ps(polyCos, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+                polyCos = _mm256_add_ps(polyCos, _mm256_set1_ps(1.0f));
+
+                auto polySin = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_P0), z), _mm256_set1_ps(SIN_P1));
+                polySin = _mm256_add_ps(_mm256_mul_ps(polySin, z), _mm256_set1_ps(SIN_P2));
+                polySin = _mm256_mul_ps(_mm256_mul_ps(polySin, z), x);
+                polySin = _mm256_add_ps(polySin, x);
+
+                auto sine = _mm256_blendv_ps(polySin, polyCos, swap);
+                auto cosine = _mm256_blendv_ps(polyCos, polySin, swap);
+                _mm256_storeu_ps(sines + i, _mm256_xor_ps(sine, signSin));
+                _mm256_storeu_ps(cosines + i, _mm256_xor_ps(cosine, signCos));
+            }
+            return i;
+        }
+
+        std::size_t distanceSquaredSse(const float* x, const float* y, Vector2f to, float* distances, std::size_t count)
+        {
+            auto toX = _mm_set1_ps(to.x);
+            auto toY = _mm_set1_ps(to.y);
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                auto dx = _mm_sub_ps(_mm_loadu_ps(x + i), toX);
+                auto dy = _mm_sub_ps(_mm_loadu_ps(y + i), toY);
+                _mm_storeu_ps(distances + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+            }
+            return i;
+        }
+
+        SIMD_TARGET_AVX2 std::size_t distanceSquaredAvx2(const float* x, const float* y, Vector2f to, float* distances, std::size_t count)
+        {
+            auto toX = _mm256_set1_ps(to.x);
+            auto toY = _mm256_set1_ps(to.y);
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), toX);
+                auto dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), toY);
+                _mm256_storeu_ps(distances + i, _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+            }
+            return i;
+        }
+#endif
+    } // namespace
+
+    void sincos(const float* radians, float* sines, float* cosines, std::size_t count)
+    {
+        sincos(radians, sines, cosines, count, simd::getIsa());
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Whatever doesn't fill a whole SIMD register is done one at a time.
+    //
+    // --------------------------------------------------------------
+    void sincos(const float* radians, float* sines, float* cosines, std::size_t count, simd::Isa isa)
+    {
+        std::size_t done = 0;
+#if defined(SIMD_X64)
+        switch (isa)
+        {
+            case simd::Isa::Avx2:
+                done = sincosAvx2(radians, sines, cosines, count);
+                break;
+            case simd::Isa::Sse:
+                done = sincosSse(radians, sines, cosines, count);
+                break;
+            case simd::Isa::Scalar:
+                break;
+        }
+#else
+        (void)isa; // unused
+#endif
+        sincosScalar(radians, sines, cosines, done, count);
+    }
+
+    void distanceSquared(const Vector2fBlock& points, Vector2f to, float* distances)
+    {
+        distanceSquared(points, to, distances, simd::getIsa());
+    }
+
+    void distanceSquared(const Vector2fBlock& points, Vector2f to, float* distances, simd::Isa isa)
+    {
+        std::size_t done = 0;
+#if defined(SIMD_X64)
+        switch (isa)
+        {
+            case simd::Isa::Avx2:
+                done = distanceSquaredAvx2(points.x.data(), points.y.data(), to, distances, points.size());
+                break;
+            case simd::Isa::Sse:
+                done = distanceSquaredSse(points.x.data(), points.y.data(), to, distances, points.size());
+                break;
+            case simd::Isa::Scalar:
+                break;
+        }
+#else
+        (void)isa; // unused
+#endif
+        distanceSquaredScalar(points.x.data(), points.y.data(), to, distances, done, points.size());
+    }
+} // namespace math
@@ -1,27 +1,207 @@
 #pragma once
 
+#include "misc/Simd.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 // --------------------------------------------------------------
 //
-// Right now just a grab bag of misc code that doesn't belong
-// anywhere else.  In fact, just one thing at this time.
+// The math used by the game: a 2D vector with the usual operators,
+// angle conversions, and a sine/cosine that gives the same answer on
+// every platform (unlike std::sin/std::cos, whose results depend on
+// the standard library), so the client and server agree.
+//
+// For working on many values at once, Vector2fBlock holds vectors as
+// separate x and y arrays and the batched functions process them with
+// SIMD instructions (see misc/Simd.hpp).  Each batched function gives
+// exactly the same results as its one-at-a-time version.
 //
 // --------------------------------------------------------------
-
 namespace math
 {
+    constexpr float PI = 3.14159265358979f;
+    constexpr float DEGREES_TO_RADIANS = PI / 180.0f;
+
+    constexpr float toRadians(float degrees) { return degrees * DEGREES_TO_RADIANS; }
+
     struct Vector2f
     {
-        Vector2f() :
+        constexpr Vector2f() :
             x(0), y(0)
         {
         }
 
-        Vector2f(float x, float y) :
+        constexpr Vector2f(float x, float y) :
             x(x), y(y)
         {
         }
 
+        constexpr Vector2f& operator+=(Vector2f rhs)
+        {
+            x += rhs.x;
+            y += rhs.y;
+            return *this;
+        }
+        constexpr Vector2f& operator-=(Vector2f rhs)
+        {
+            x -= rhs.x;
+            y -= rhs.y;
+            return *this;
+        }
+        constexpr Vector2f& operator*=(float scale)
+        {
+            x *= scale;
+            y *= scale;
+            return *this;
+        }
+
         float x;
         float y;
     };
+
+    constexpr Vector2f operator+(Vector2f lhs, Vector2f rhs) { return {lhs.x + rhs.x, lhs.y + rhs.y}; }
+    constexpr Vector2f operator-(Vector2f lhs, Vector2f rhs) { return {lhs.x - rhs.x, lhs.y - rhs.y}; }
+    constexpr Vector2f operator-(Vector2f v) { return {-v.x, -v.y}; }
+    constexpr Vector2f operator*(Vector2f v, float scale) { return {v.x * scale, v.y * scale}; }
+    constexpr Vector2f operator*(float scale, Vector2f v) { return {v.x * scale, v.y * scale}; }
+    constexpr Vector2f operator/(Vector2f v, float scale) { return {v.x / scale, v.y / scale}; }
+    constexpr bool operator==(Vector2f lhs, Vector2f rhs) { return lhs.x == rhs.x && lhs.y == rhs.y; }
+    constexpr bool operator!=(Vector2f lhs, Vector2f rhs) { return !(lhs == rhs); }
+
+    constexpr float dot(Vector2f lhs, Vector2f rhs) { return lhs.x * rhs.x + lhs.y * rhs.y; }
+    constexpr float lengthSquared(Vector2f v) { return dot(v, v); }
+    constexpr float distanceSquared(Vector2f a, Vector2f b) { return lengthSquared(a - b); }
+    inline float length(Vector2f v) { return std::sqrt(lengthSquared(v)); }
+    inline float distance(Vector2f a, Vector2f b) { return std::sqrt(distanceSquared(a, b)); }
+
+    //
+    // How far along the segment from 'from' to 'to' (0 at 'from', 1 at 'to') it first comes
+    // within 'radius' of the point, nothing if it never does
+    inline std::optional<float> segmentEntry(Vector2f point, float radius, Vector2f from, Vector2f to)
+    {
+        auto start = from - point;
+        auto startDistance2 = lengthSquared(start) - radius * radius;
+        if (startDistance2 <= 0)
+        {
+            return 0.0f;
+        }
+        auto segment = to - from;
+        auto length2 = lengthSquared(segment);
+        auto along = dot(start, segment);
+        auto discriminant = along * along - length2 * startDistance2;
+        if (length2 == 0 || along >= 0 || discriminant < 0)
+        {
+            return std::nullopt;
+        }
+        auto t = (-along - std::sqrt(discriminant)) / length2;
+        if (t > 1)
+        {
+            return std::nullopt;
+        }
+        return t;
+    }
+
+    // --------------------------------------------------------------
+    //
+    // Sine and cosine of an angle in radians, from a range reduction
+    // and minimax polynomials (the single precision Cephes ones).  For
+    // |radians| < 8192 the error is within 2e-7 of the true value.
+    //
+    // Every step is a single float operation, in the same order as the
+    // batched kernels in math.cpp, so the two agree bit for bit.
+    //
+    // --------------------------------------------------------------
+    namespace sincosdetail
+    {
+        constexpr float FOUR_OVER_PI = 1.27323954473516f;
+        constexpr float DP1 = 0.78515625f; // pi/4 split in three, so the reduction is exact
+        constexpr float DP2 = 2.4187564849853515625e-4f;
+        constexpr float DP3 = 3.77489497744594108e-8f;
+        constexpr float SIN_P0 = -1.9515295891e-4f;
+        constexpr float SIN_P1 = 8.3321608736e-3f;
+        constexpr float SIN_P2 = -1.6666654611e-1f;
+        constexpr float COS_P0 = 2.443315711809948e-5f;
+        constexpr float COS_P1 = -1.388731625493765e-3f;
+        constexpr float COS_P2 = 4.166664568298827e-2f;
+    } // namespace sincosdetail
+
+    inline void sincos(float radians, float& sine, float& cosine)
+    {
+        using namespace sincosdetail;
+
+        auto x = std::fabs(radians);
+        //
+        // The octant, rounded up to even, tells which polynomial and signs to use
+        auto octant = static_cast<std::int32_t>(x * FOUR_OVER_PI);
+        octant = (octant + 1) & ~1;
+        auto y = static_cast<float>(octant);
+        x = ((x - y * DP1) - y * DP2) - y * DP3;
+
+        auto z = x * x;
+        auto polyCos = ((COS_P0 * z + COS_P1) * z + COS_P2) * z * z - z * 0.5f + 1.0f;
+        auto polySin = ((SIN_P0 * z + SIN_P1) * z + SIN_P2) * z * x + x;
+
+        auto swap = (octant & 2) != 0;
+        sine = swap ? polyCos : polySin;
+        cosine = swap ? polySin : polyCos;
+        if (((octant & 4) != 0) != std::signbit(radians))
+        {
+            sine = -sine;
+        }
+        if (((octant - 2) & 4) == 0)
+        {
+            cosine = -cosine;
+        }
+    }
+
+    //
+    // Orientations are in degrees and grow without limit as an entity spins,
+    // taking out whole turns first (exactly, fmod doesn't round) keeps them
+    // in the accurate range
+    inline void sincosDegrees(float degrees, float& sine, float& cosine) { sincos(toRadians(std::fmod(degrees, 360.0f)), sine, cosine); }
+
+    // --------------------------------------------------------------
+    //
+    // A set of vectors stored as separate x and y arrays.
+    //
+    // --------------------------------------------------------------
+    struct Vector2fBlock
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+
+        std::size_t size() const { return x.size(); }
+        void resize(std::size_t count)
+        {
+            x.resize(count);
+            y.resize(count);
+        }
+        void clear()
+        {
+            x.clear();
+            y.clear();
+        }
+        void push_back(Vector2f v)
+        {
+            x.push_back(v.x);
+            y.push_back(v.y);
+        }
+        Vector2f get(std::size_t i) const { return {x[i], y[i]}; }
+        void set(std::size_t i, Vector2f v)
+        {
+            x[i] = v.x;
+            y[i] = v.y;
+        }
+    };
+
+    //
+    // Batched versions, using the best instructions the CPU supports, or the given ones
+    void sincos(const float* radians, float* sines, float* cosines, std::size_t count);
+    void sincos(const float* radians, float* sines, float* cosines, std::size_t count, simd::Isa isa);
+    void distanceSquared(const Vector2fBlock& points, Vector2f to, float* distances);
+    void distanceSquared(const Vector2fBlock& points, Vector2f to, float* distances, simd::Isa isa);
 } // namespace math
@@ -1,25 +1,53 @@
-
 #include "Lifetime.hpp"
 
+#include "misc/GameClock.hpp"
+#include "misc/Profiler.hpp"
+
 namespace systems
 {
     // --------------------------------------------------------------
     //
-    // Update how long the entity has been alive and if it has expired,
-    // notify the game model.
+    // The countdown starts when the entity first joins the system.  An
+    // entity offered again (its components changed) keeps its original
+    // expiration.
     //
     // --------------------------------------------------------------
-    void Lifetime::update(std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+    bool Lifetime::addEntity(std::shared_ptr<entities::Entity> entity)
     {
-        for (auto&& [id, entity] : m_entities)
+        if (System::addEntity(entity))
+        {
+            auto expiresAt = entity->getComponent<components::Lifetime>()->start();
+            m_timers[entity->getId()] = m_expirations.schedule(expiresAt, entity->getId());
+            return true;
+        }
+
+        return false;
+    }
+
+    void Lifetime::removeEntity(entities::Entity::IdType entityId)
+    {
+        System::removeEntity(entityId);
+
+        auto timer = m_timers.find(entityId);
+        if (timer != m_timers.end())
         {
-            auto lifetime = entity->getComponent<components::Lifetime>();
-            lifetime->update(elapsedTime);
-            if (lifetime->get().count() <= 0)
-            {
-                m_notifyRemove(id);
-            }
+            m_expirations.cancel(timer->second);
+            m_timers.erase(timer);
         }
     }
 
+    // --------------------------------------------------------------
+    //
+    // Destroy the entities whose time has come.
+    //
+    // --------------------------------------------------------------
+    void Lifetime::update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now)
+    {
+        PROFILE_SCOPE("Lifetime::update");
+
+        m_expirations.advance(GameClock::instance().now(), [this](entities::Entity::IdType entityId) {
+            m_commands.destroy(entityId);
+        });
+    }
+
 } // namespace systems
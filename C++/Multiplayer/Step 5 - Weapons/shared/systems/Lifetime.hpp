@@ -1,30 +1,39 @@
 #pragma once
 
 #include "components/Lifetime.hpp"
+#include "misc/TimerWheel.hpp"
 #include "systems/System.hpp"
 
 #include <chrono>
-#include <functional>
+#include <memory>
+#include <unordered_map>
 
 namespace systems
 {
     // --------------------------------------------------------------
     //
     // This system is used to manage entities that have a lifetime.
+    // Expired entities are destroyed through the command buffer.
+    //
+    // The expiration of each entity is scheduled on a timer wheel when
+    // the entity is added, so an update only touches the entities that
+    // expire, not every entity with a lifetime.
     //
     // --------------------------------------------------------------
     class Lifetime : public System
     {
       public:
-        Lifetime(std::function<void(entities::Entity::IdType entityId)> notifyRemove) :
-            System({ctti::unnamed_type_id<components::Lifetime>()}),
-            m_notifyRemove(notifyRemove)
+        Lifetime() :
+            System({ctti::unnamed_type_id<components::Lifetime>()})
         {
         }
 
-        void update(std::chrono::microseconds elapsedTime, const std::chrono::system_clock::time_point now) override;
+        virtual bool addEntity(std::shared_ptr<entities::Entity> entity) override;
+        virtual void removeEntity(entities::Entity::IdType entityId) override;
+        void update(std::chrono::microseconds elapsedTime, const std::chrono::steady_clock::time_point now) override;
 
       private:
-        std::function<void(entities::Entity::IdType entityId)> m_notifyRemove;
+        TimerWheel<entities::Entity::IdType> m_expirations;
+        std::unordered_map<entities::Entity::IdType, TimerWheel<entities::Entity::IdType>::Handle> m_timers;
     };
 } // namespace systems
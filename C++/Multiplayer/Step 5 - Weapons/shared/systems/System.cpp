@@ -31,6 +31,33 @@ namespace systems
         m_entities.erase(entityId);
     }
 
+    // --------------------------------------------------------------
+    //
+    // A batch of changes from a command buffer playback.  An entity
+    // whose components changed is removed and offered again, so the
+    // system (and any bookkeeping a derived system keeps) sees it as
+    // it is now.
+    //
+    // --------------------------------------------------------------
+    void System::applyChanges(const entities::EntityVector& added, const entities::EntityVector& changed, const std::vector<entities::Entity::IdType>& removed)
+    {
+        for (auto entityId : removed)
+        {
+            removeEntity(entityId);
+        }
+        for (auto& entity : changed)
+        {
+            removeEntity(entity->getId());
+            addEntity(entity);
+        }
+
+        m_entities.reserve(m_entities.size() + added.size());
+        for (auto& entity : added)
+        {
+            addEntity(entity);
+        }
+    }
+
     // --------------------------------------------------------------
     //
     // All systems are asked if they are interested in an entity.  This
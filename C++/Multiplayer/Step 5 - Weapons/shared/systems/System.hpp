@@ -1,5 +1,6 @@
 #pragma once
 
+#include "entities/CommandBuffer.hpp"
 #include "entities/Entity.hpp"
 
 #include <chrono>
@@ -13,6 +14,7 @@
 #endif
 #include <initializer_list>
 #include <unordered_set>
+#include <vector>
 
 namespace systems
 {
@@ -23,6 +25,10 @@ namespace systems
     // entities, handling things like movement, collision detection,
     // and rendering.
     //
+    // Systems don't add or remove entities or components while they
+    // update, they record those changes in their command buffer.  The
+    // game model plays the buffers back between updates.
+    //
     // --------------------------------------------------------------
     class System
     {
@@ -38,13 +44,18 @@ namespace systems
 
         virtual bool addEntity(std::shared_ptr<entities::Entity> entity);
         virtual void removeEntity(entities::Entity::IdType entityId);
+        void applyChanges(const entities::EntityVector& added, const entities::EntityVector& changed, const std::vector<entities::Entity::IdType>& removed);
 
-        virtual void update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::system_clock::time_point now)
+        virtual void update([[maybe_unused]] std::chrono::microseconds elapsedTime, [[maybe_unused]] const std::chrono::steady_clock::time_point now)
         {
         }
 
+        auto getEntityCount() const { return m_entities.size(); }
+        auto& getCommands() { return m_commands; }
+
       protected:
         entities::EntityMap m_entities;
+        entities::CommandBuffer m_commands;
 
         virtual bool isInterested(entities::Entity* entity);
 